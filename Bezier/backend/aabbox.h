@@ -30,6 +30,10 @@
 
 #include <ostream>
 
+#if __cplusplus >= 201103L
+#include <type_traits>
+#endif
+
 namespace dnr {
 /*****************************************************************************/
 
@@ -41,26 +45,17 @@ struct aabbox {
 	
 	/*************************************************************************/
 	
-	aabbox() : active(false) { }
-	aabbox(T _x, T _y, T _w, T _h) : origin(_x, _y), extent(_w, _h), active(true) { }
-	aabbox(const vector2d<T>& _origin, const vector2d<T>& _extent) : origin(_origin), extent(_extent), active(true) { }
-	aabbox(const aabbox& other) { *this = other; }
-	
-	aabbox<T>& operator=(const aabbox<T>& other) {
-		origin = other.origin;
-		extent = other.extent;
-		active = other.active;
-		
-		return *this;
-	}
+	CONSTEXPR aabbox() NOEXCEPT : active(false) { }
+	CONSTEXPR aabbox(T _x, T _y, T _w, T _h) NOEXCEPT : origin(_x, _y), extent(_w, _h), active(true) { }
+	CONSTEXPR aabbox(const vector2d<T>& _origin, const vector2d<T>& _extent) NOEXCEPT : origin(_origin), extent(_extent), active(true) { }
 	
-	aabbox<T> operator-(const vector2d<T>& amt) const {
+	CONSTEXPR aabbox<T> operator-(const vector2d<T>& amt) const NOEXCEPT {
 		aabbox<T> ret = *this;
 		ret -= amt;
 		return ret;
 	}
 	
-	aabbox<T>& operator-=(const vector2d<T> amt) {
+	CONSTEXPR aabbox<T>& operator-=(const vector2d<T> amt) NOEXCEPT {
 		origin -= amt;
 		extent -= amt;
 		
@@ -79,11 +74,11 @@ struct aabbox {
 	
 	/*************************************************************************/
 	
-	inline void deactivate() {
+	CONSTEXPR void deactivate() NOEXCEPT {
 		active = false;
 	}
 	
-	inline void reset(const vector2d<T>& start_pt) {
+	CONSTEXPR void reset(const vector2d<T>& start_pt) NOEXCEPT {
 		active = true;
 		origin.set(start_pt);
 		extent.set(T(0), T(0));
@@ -97,7 +92,7 @@ struct aabbox {
 	 * @param	x			x-coordinate.
 	 * @param	y			y-coordinate.
 	**/
-	void add_internal_point(T x, T y) {
+	CONSTEXPR void add_internal_point(T x, T y) NOEXCEPT {
 		if (!active) reset(vector2d<T>(x, y));
 		else {
 			add_internal_point_x(x);
@@ -110,7 +105,7 @@ struct aabbox {
 	 * 
 	 * @param	pt	Point to add.
 	**/
-	void add_internal_point(const vector2d<T>& pt) {
+	CONSTEXPR void add_internal_point(const vector2d<T>& pt) NOEXCEPT {
 		if (!active) reset(pt);
 		else {
 			add_internal_point_x(pt.x);
@@ -123,7 +118,7 @@ struct aabbox {
 	 * 
 	 * @param	x	x-coordinate.
 	**/
-	void add_internal_point_x(T x) {
+	CONSTEXPR void add_internal_point_x(T x) NOEXCEPT {
 		active = true;
 		x -= origin.x; // Convert to bbox space.
 		
@@ -139,7 +134,7 @@ struct aabbox {
 	 * 
 	 * @param	x	x-coordinate.
 	**/
-	void add_internal_point_y(T y) {
+	CONSTEXPR void add_internal_point_y(T y) NOEXCEPT {
 		active = true;
 		y -= origin.y; // Convert to bbox space.
 		
@@ -153,7 +148,7 @@ struct aabbox {
 	/**
 	 * Adds a bounding box inside this bounding box.
 	**/
-	void add_internal_box(const aabbox<T>& box) {
+	CONSTEXPR void add_internal_box(const aabbox<T>& box) NOEXCEPT {
 		if (!box.active) return;
 		if (!active) {
 			*this = box;
@@ -163,10 +158,45 @@ struct aabbox {
 		add_internal_point(box.origin);
 		add_internal_point(box.origin + box.extent);
 	}
+	
+	/*************************************************************************/
+	
+	/**
+	 * Test if a point is inside the bounding box, including its edges.
+	**/
+	CONSTEXPR bool contains(const vector2d<T>& pt) const NOEXCEPT {
+		return active && pt >= origin && pt <= origin + extent;
+	}
+	
+	/**
+	 * Test if another bounding box overlaps this one, including touching
+	 * edges.
+	**/
+	CONSTEXPR bool intersects(const aabbox<T>& box) const NOEXCEPT {
+		return active && box.active
+			&& box.origin <= origin + extent
+			&& origin <= box.origin + box.extent;
+	}
+	
+	/**
+	 * Get the square of the distance from a point to the nearest point in the
+	 * bounding box, zero if the point is inside.
+	**/
+	CONSTEXPR T distance_sq(const vector2d<T>& pt) const NOEXCEPT {
+		const vector2d<T> far_corner = origin + extent;
+		const T dx = max_(max_(origin.x - pt.x, pt.x - far_corner.x), T(0));
+		const T dy = max_(max_(origin.y - pt.y, pt.y - far_corner.y), T(0));
+		
+		return dx * dx + dy * dy;
+	}
 };
 
 typedef aabbox<f64> aabboxd;
 
+#if __cplusplus >= 201103L
+static_assert(std::is_trivially_copyable<aabboxd>::value, "aabboxd must be trivially copyable");
+#endif
+
 /*****************************************************************************/
 } // End of namespace dnr.
 
@@ -0,0 +1,193 @@
+/*
+ * arc_length.cpp
+ * Bezier
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+#include "arc_length.h"
+#include <algorithm>
+
+namespace dnr {
+/*****************************************************************************/
+
+const f64 arc_length_table::k_default_tolerance = 1.0e-6;
+
+/// Number of uniform intervals to start subdividing from.
+static const u32 k_initial_intervals = 8;
+
+/// Limit on subdivision depth, a cusp would otherwise subdivide forever.
+static const u32 k_max_depth = 16;
+
+/**
+ * Get the speed |B'(t)| of the curve, given its derivative coefficients.
+**/
+static inline f64 speed_at(const cubic_coefficients& deriv, f64 t) {
+	return ((deriv.b * t + deriv.c) * t + deriv.d).length();
+}
+
+/**
+ * Integrate the speed over [t0, t1] with five-point Gauss-Legendre quadrature.
+**/
+static f64 integrate_speed(const cubic_coefficients& deriv, f64 t0, f64 t1) {
+	static const f64 k_nodes[5] = {
+		-0.9061798459386640, -0.5384693101056831, 0.0, 0.5384693101056831, 0.9061798459386640
+	};
+	static const f64 k_weights[5] = {
+		0.2369268850561891, 0.4786286704993665, 0.5688888888888889, 0.4786286704993665, 0.2369268850561891
+	};
+	
+	const f64 half = 0.5 * (t1 - t0);
+	const f64 mid = 0.5 * (t1 + t0);
+	
+	f64 sum = 0.0;
+	for (u32 i = 0; i < 5; ++i) {
+		sum += k_weights[i] * speed_at(deriv, mid + half * k_nodes[i]);
+	}
+	
+	return sum * half;
+}
+
+/**
+ * Evaluate the cubic Hermite interpolant of s over one interval.
+ * 
+ * @param	u		Normalized position in the interval, [0, 1].
+ * @param	len		Length of the interval.
+ * @param	m0		Slope at the start, scaled by the interval width in t.
+ * @param	m1		Slope at the end, scaled by the interval width in t.
+**/
+static inline f64 hermite(f64 u, f64 len, f64 m0, f64 m1) {
+	const f64 u2 = u * u;
+	const f64 u3 = u2 * u;
+	
+	return (u3 - 2.0 * u2 + u) * m0 + (-2.0 * u3 + 3.0 * u2) * len + (u3 - u2) * m1;
+}
+
+/**
+ * Derivative of hermite() with respect to u.
+**/
+static inline f64 hermite_deriv(f64 u, f64 len, f64 m0, f64 m1) {
+	const f64 u2 = u * u;
+	
+	return (3.0 * u2 - 4.0 * u + 1.0) * m0 + (-6.0 * u2 + 6.0 * u) * len + (3.0 * u2 - 2.0 * u) * m1;
+}
+
+/*****************************************************************************/
+
+void arc_length_table::build(const cubic_bezier& curve, f64 tolerance) {
+	clear();
+	
+	const cubic_coefficients deriv = curve.first_derivative();
+	
+	m_t.push_back(0.0);
+	m_s.push_back(0.0);
+	m_speed.push_back(speed_at(deriv, 0.0));
+	
+	const f64 step = 1.0 / f64(k_initial_intervals);
+	const f64 interval_tolerance = tolerance / f64(k_initial_intervals);
+	
+	for (u32 i = 0; i < k_initial_intervals; ++i) {
+		const f64 t0 = m_t.back();
+		const f64 t1 = (i + 1 == k_initial_intervals) ? 1.0 : f64(i + 1) * step;
+		
+		subdivide(deriv, t0, t1, m_speed.back(), speed_at(deriv, t1), integrate_speed(deriv, t0, t1), interval_tolerance, 0);
+	}
+	
+	m_length = m_s.back();
+}
+
+void arc_length_table::subdivide(const cubic_coefficients& deriv, f64 t0, f64 t1, f64 speed0, f64 speed1, f64 len, f64 tolerance, u32 depth) {
+	const f64 mid = 0.5 * (t0 + t1);
+	const f64 h = t1 - t0;
+	
+	const f64 left = integrate_speed(deriv, t0, mid);
+	const f64 right = integrate_speed(deriv, mid, t1);
+	
+	/* Accept the interval when the quadrature has converged and the Hermite
+	 * interpolant agrees with the integrated length at the midpoint, which is
+	 * where its error is largest.
+	**/
+	const f64 quadrature_err = abs_(left + right - len);
+	const f64 interp_err = abs_(hermite(0.5, left + right, h * speed0, h * speed1) - left);
+	
+	if (depth >= k_max_depth || (quadrature_err <= tolerance && interp_err <= tolerance)) {
+		m_t.push_back(t1);
+		m_s.push_back(m_s.back() + left + right);
+		m_speed.push_back(speed1);
+		return;
+	}
+	
+	const f64 speed_mid = speed_at(deriv, mid);
+	subdivide(deriv, t0, mid, speed0, speed_mid, left, 0.5 * tolerance, depth + 1);
+	subdivide(deriv, mid, t1, speed_mid, speed1, right, 0.5 * tolerance, depth + 1);
+}
+
+void arc_length_table::clear() {
+	m_t.clear();
+	m_s.clear();
+	m_speed.clear();
+	m_length = 0.0;
+}
+
+f64 arc_length_table::length_at_t(f64 t) const {
+	if (m_t.size() < 2) return 0.0;
+	
+	t = clamp(t, 0.0, 1.0);
+	
+	// Find the interval containing t.
+	size_t i = std::upper_bound(m_t.begin(), m_t.end(), t) - m_t.begin();
+	i = clamp<size_t>(i, 1, m_t.size() - 1) - 1;
+	
+	const f64 h = m_t[i + 1] - m_t[i];
+	const f64 u = (t - m_t[i]) / h;
+	
+	return m_s[i] + hermite(u, m_s[i + 1] - m_s[i], h * m_speed[i], h * m_speed[i + 1]);
+}
+
+f64 arc_length_table::t_at_length(f64 s) const {
+	if (m_t.size() < 2 || m_length <= 0.0) return 0.0;
+	
+	s = clamp(s, 0.0, m_length);
+	
+	// Find the interval containing s.
+	size_t i = std::upper_bound(m_s.begin(), m_s.end(), s) - m_s.begin();
+	i = clamp<size_t>(i, 1, m_s.size() - 1) - 1;
+	
+	const f64 h = m_t[i + 1] - m_t[i];
+	const f64 len = m_s[i + 1] - m_s[i];
+	if (iszero(len)) return m_t[i];
+	
+	const f64 m0 = h * m_speed[i];
+	const f64 m1 = h * m_speed[i + 1];
+	const f64 target = s - m_s[i];
+	
+	// Start from linear interpolation, then polish with Newton's method.
+	f64 u = target / len;
+	for (u32 iter = 0; iter < 3; ++iter) {
+		const f64 deriv = hermite_deriv(u, len, m0, m1);
+		if (iszero(deriv)) break;
+		
+		u = clamp(u - (hermite(u, len, m0, m1) - target) / deriv, 0.0, 1.0);
+	}
+	
+	return m_t[i] + u * h;
+}
+
+/*****************************************************************************/
+} // End of namespace dnr.
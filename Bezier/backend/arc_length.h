@@ -0,0 +1,113 @@
+/*
+ * arc_length.h
+ * Bezier
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+#ifndef _ARC_LENGTH_H
+#define _ARC_LENGTH_H
+
+#include <vector>
+#include "cubic_bezier.h"
+
+namespace dnr {
+/*****************************************************************************/
+
+/**
+ * Arc-length parameterization of a cubic bezier curve.
+ * 
+ * The table is built once per curve by adaptively subdividing [0, 1] and
+ * integrating the speed |B'(t)| with Gauss-Legendre quadrature.  Between
+ * breakpoints s(t) is a cubic Hermite interpolant that uses the speed as its
+ * slope, so queries are a binary search followed by a few multiplications.
+ * 
+ * The table does not track the curve; call build() again after moving a
+ * control point.
+**/
+class arc_length_table {
+public:
+	/// Default absolute tolerance for the integrated length, in curve units.
+	static const f64 k_default_tolerance;
+	
+	arc_length_table() : m_length(0.0) { }
+	
+	explicit arc_length_table(const cubic_bezier& curve, f64 tolerance = k_default_tolerance)
+			: m_length(0.0) {
+		build(curve, tolerance);
+	}
+	
+	/**
+	 * Build the table for a curve.
+	 * 
+	 * @param	curve		Curve to parameterize.
+	 * @param	tolerance	Maximum error of length_at_t() and the lengths
+	 * 						used by t_at_length().
+	**/
+	void build(const cubic_bezier& curve, f64 tolerance = k_default_tolerance);
+	
+	/**
+	 * Discard the table, empty() will return true until the next build().
+	**/
+	void clear();
+	
+	/**
+	 * Has the table been built?
+	**/
+	bool empty() const { return m_t.empty(); }
+	
+	/**
+	 * Get the total length of the curve.
+	**/
+	f64 length() const { return m_length; }
+	
+	/**
+	 * Get the distance along the curve from the origin to position t.
+	 * 
+	 * @param	t		Position on curve, clamped to [0.0, 1.0].
+	**/
+	f64 length_at_t(f64 t) const;
+	
+	/**
+	 * Get the position on the curve at a distance s from the origin.
+	 * 
+	 * @param	s		Distance along the curve, clamped to [0.0, length()].
+	**/
+	f64 t_at_length(f64 s) const;
+	
+	/**
+	 * Get the number of breakpoints in the table.
+	**/
+	size_t size() const { return m_t.size(); }
+	
+private:
+	void subdivide(const cubic_coefficients& deriv, f64 t0, f64 t1, f64 speed0, f64 speed1, f64 len, f64 tolerance, u32 depth);
+	
+	// Breakpoints, sorted by both t and s.
+	std::vector<f64> m_t;
+	std::vector<f64> m_s;
+	std::vector<f64> m_speed; // |B'(t)| at each breakpoint.
+	
+	f64 m_length;
+};
+
+/*****************************************************************************/
+} // End of namespace dnr.
+
+#endif // _ARC_LENGTH_H.
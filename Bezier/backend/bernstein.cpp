@@ -0,0 +1,193 @@
+/*
+ * bernstein.cpp
+ * Bezier
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+#include "bernstein.h"
+
+namespace dnr {
+/*****************************************************************************/
+
+/// Subdivision depth limit, far below where intervals reach any tolerance.
+static const u32 k_max_depth = 64;
+
+/// Iteration limit when polishing a bracketed root.
+static const u32 k_max_polish_iterations = 64;
+
+/**
+ * State for the recursive root search.
+**/
+struct root_search {
+	const f64 * coeff;
+	f64 power[k_max_bernstein_degree + 1]; // Power basis of coeff, built on first use.
+	bool has_power;
+	
+	u32 degree;
+	f64 tolerance;
+	
+	f64 * roots;
+	u32 count;
+	
+	void add(f64 root) {
+		// Neighboring intervals share their end points, don't report twice.
+		if (count && root <= roots[count - 1]) return;
+		if (count < degree) roots[count++] = root;
+	}
+};
+
+/*****************************************************************************/
+
+/**
+ * The power basis coefficients are:
+ * 
+ * p_k = C(n, k) sum_{i <= k} (-1)^(k - i) C(k, i) b_i
+**/
+void bernstein_to_power(const f64 * coeff, u32 degree, f64 * power) {
+	// Forward differences of the coefficients give the sums directly.
+	f64 diff[k_max_bernstein_degree + 1];
+	for (u32 i = 0; i <= degree; ++i) diff[i] = coeff[i];
+	
+	f64 binomial = 1.0; // C(n, k).
+	for (u32 k = 0; k <= degree; ++k) {
+		power[k] = binomial * diff[0];
+		binomial = binomial * f64(degree - k) / f64(k + 1);
+		
+		for (u32 i = 0; i + k < degree; ++i) {
+			diff[i] = diff[i + 1] - diff[i];
+		}
+	}
+}
+
+/**
+ * The Bernstein coefficients are:
+ * 
+ * b_i = sum_{k <= i} C(i, k) / C(n, k) p_k
+**/
+void power_to_bernstein(const f64 * power, u32 degree, f64 * coeff) {
+	for (u32 i = 0; i <= degree; ++i) coeff[i] = 0.0;
+	
+	f64 binomial_n = 1.0; // C(n, k).
+	for (u32 k = 0; k <= degree; ++k) {
+		const f64 scaled = power[k] / binomial_n;
+		
+		f64 binomial_i = 1.0; // C(i, k), starting at i = k.
+		for (u32 i = k; i <= degree; ++i) {
+			coeff[i] += binomial_i * scaled;
+			binomial_i = binomial_i * f64(i + 1) / f64(i + 1 - k);
+		}
+		
+		binomial_n = binomial_n * f64(degree - k) / f64(k + 1);
+	}
+}
+
+f64 polish_bracketed_root(const f64 * power, u32 degree, f64 lo, f64 hi, f64 value_lo, f64 value_hi, f64 tolerance) {
+	const bool rising = value_hi > value_lo;
+	
+	// Start at the false position estimate.
+	f64 t = lo + (hi - lo) * value_lo / (value_lo - value_hi);
+	
+	for (u32 i = 0; i < k_max_polish_iterations; ++i) {
+		// Horner's rule for the value and derivative.
+		f64 value = power[degree];
+		f64 deriv = 0.0;
+		for (u32 k = degree; k-- > 0;) {
+			deriv = deriv * t + value;
+			value = value * t + power[k];
+		}
+		
+		if (value == 0.0) return t;
+		
+		// Shrink the bracket to the side that still holds the sign change.
+		if ((value < 0.0) == rising) lo = t;
+		else hi = t;
+		
+		f64 next = (deriv != 0.0) ? t - value / deriv : lo - 1.0;
+		if (!(next > lo && next < hi)) next = 0.5 * (lo + hi); // Bisect instead.
+		
+		const f64 step = abs_(next - t);
+		t = next;
+		
+		if (step <= tolerance || hi - lo <= tolerance) break;
+	}
+	
+	return t;
+}
+
+/*****************************************************************************/
+
+static void isolate_roots(const f64 * coeff, f64 lo, f64 hi, root_search& search, u32 depth) {
+	const u32 degree = search.degree;
+	const u32 changes = bernstein_sign_changes(coeff, degree);
+	if (changes == 0) return;
+	
+	const f64 width = hi - lo;
+	
+	// One sign change between non-zero ends brackets exactly one root.
+	if (changes == 1 && coeff[0] != 0.0 && coeff[degree] != 0.0) {
+		if (!search.has_power) {
+			search.has_power = true;
+			bernstein_to_power(search.coeff, degree, search.power);
+		}
+		
+		search.add(polish_bracketed_root(search.power, degree, lo, hi, coeff[0], coeff[degree], search.tolerance));
+		return;
+	}
+	
+	// A cluster of roots narrower than the tolerance is reported once.
+	if (width <= search.tolerance || depth >= k_max_depth) {
+		search.add(lo + 0.5 * width);
+		return;
+	}
+	
+	f64 left[k_max_bernstein_degree + 1];
+	f64 right[k_max_bernstein_degree + 1];
+	bernstein_split_half(coeff, degree, left, right);
+	
+	const f64 mid = lo + 0.5 * width;
+	isolate_roots(left, lo, mid, search, depth + 1);
+	if (left[degree] == 0.0) search.add(mid);
+	isolate_roots(right, mid, hi, search, depth + 1);
+}
+
+u32 bernstein_roots(const f64 * coeff, u32 degree, f64 * roots, f64 tolerance) {
+	root_search search;
+	search.coeff = coeff;
+	search.has_power = false;
+	search.degree = degree;
+	search.tolerance = tolerance;
+	search.roots = roots;
+	search.count = 0;
+	
+	if (coeff[0] == 0.0) search.add(0.0);
+	isolate_roots(coeff, 0.0, 1.0, search, 0);
+	if (coeff[degree] == 0.0) search.add(1.0);
+	
+	return search.count;
+}
+
+u32 solve_polynomial_unit(const f64 * power, u32 degree, f64 * roots, f64 tolerance) {
+	f64 coeff[k_max_bernstein_degree + 1];
+	power_to_bernstein(power, degree, coeff);
+	return bernstein_roots(coeff, degree, roots, tolerance);
+}
+
+/*****************************************************************************/
+} // End of namespace dnr.
@@ -0,0 +1,165 @@
+/*
+ * bernstein.h
+ * Bezier
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+#ifndef _BERNSTEIN_H
+#define _BERNSTEIN_H
+
+#include "mathutil.h"
+
+namespace dnr {
+/*****************************************************************************/
+
+/// Highest polynomial degree supported by the Bernstein helpers.
+const u32 k_max_bernstein_degree = 7;
+
+/**
+ * Evaluate a polynomial in Bernstein form and its derivative at t, using
+ * de Casteljau's algorithm.
+ * 
+ * @param	coeff	degree + 1 Bernstein coefficients.
+ * @param	degree	Degree of the polynomial, at most k_max_bernstein_degree.
+ * @param	t		Position to evaluate at, usually in [0, 1].
+ * @param	deriv	Receives the derivative at t.
+ * @return	The value at t.
+**/
+inline f64 bernstein_evaluate(const f64 * coeff, u32 degree, f64 t, f64& deriv) {
+	f64 tmp[k_max_bernstein_degree + 1];
+	for (u32 i = 0; i <= degree; ++i) tmp[i] = coeff[i];
+	
+	if (degree == 0) {
+		deriv = 0.0;
+		return tmp[0];
+	}
+	
+	const f64 rev_t = 1.0 - t;
+	for (u32 level = degree; level > 1; --level) {
+		for (u32 i = 0; i < level; ++i) {
+			tmp[i] = rev_t * tmp[i] + t * tmp[i + 1];
+		}
+	}
+	
+	// The last two intermediate values span the tangent of the polynomial.
+	deriv = f64(degree) * (tmp[1] - tmp[0]);
+	return rev_t * tmp[0] + t * tmp[1];
+}
+
+/**
+ * Split a polynomial in Bernstein form at t = 0.5, giving the coefficients
+ * of the two halves reparameterized to [0, 1].
+**/
+inline void bernstein_split_half(const f64 * coeff, u32 degree, f64 * left, f64 * right) {
+	f64 tmp[k_max_bernstein_degree + 1];
+	for (u32 i = 0; i <= degree; ++i) tmp[i] = coeff[i];
+	
+	left[0] = tmp[0];
+	right[degree] = tmp[degree];
+	
+	for (u32 level = 1; level <= degree; ++level) {
+		for (u32 i = 0; i + level <= degree; ++i) {
+			tmp[i] = 0.5 * (tmp[i] + tmp[i + 1]);
+		}
+		
+		left[level] = tmp[0];
+		right[degree - level] = tmp[degree - level];
+	}
+}
+
+/**
+ * Count the sign changes in a list of Bernstein coefficients, ignoring
+ * zeros.  By Descartes' rule of signs this bounds the number of roots in
+ * (0, 1), and a count of zero or one is exact.
+**/
+inline u32 bernstein_sign_changes(const f64 * coeff, u32 degree) {
+	u32 changes = 0;
+	s32 last = 0;
+	
+	for (u32 i = 0; i <= degree; ++i) {
+		const s32 sign = coeff[i] > 0.0 ? 1 : (coeff[i] < 0.0 ? -1 : 0);
+		if (sign == 0) continue;
+		
+		if (last != 0 && sign != last) ++changes;
+		last = sign;
+	}
+	
+	return changes;
+}
+
+/**
+ * Find the roots in [0, 1] of a polynomial given in Bernstein form.
+ * 
+ * Intervals are isolated by halving with de Casteljau subdivision until each
+ * holds at most one sign change, then the single root in each is polished
+ * with Newton's method on the power basis, falling back to bisection
+ * whenever a step leaves the bracket.  Roots are returned in increasing
+ * order.
+ * 
+ * @param	coeff		degree + 1 Bernstein coefficients.
+ * @param	degree		Degree of the polynomial, at most k_max_bernstein_degree.
+ * @param	roots		Receives up to degree roots.
+ * @param	tolerance	Width in t at which root intervals stop shrinking.
+ * @return	Number of roots found.
+**/
+u32 bernstein_roots(const f64 * coeff, u32 degree, f64 * roots, f64 tolerance = ROUNDING_ERROR_64);
+
+/**
+ * Convert Bernstein coefficients to power basis coefficients, lowest degree
+ * first.
+**/
+void bernstein_to_power(const f64 * coeff, u32 degree, f64 * power);
+
+/**
+ * Convert power basis coefficients, lowest degree first, to Bernstein
+ * coefficients over [0, 1].
+**/
+void power_to_bernstein(const f64 * power, u32 degree, f64 * coeff);
+
+/**
+ * Find the roots in [0, 1] of a polynomial given in power basis, such as a
+ * quintic from a distance or intersection problem, see bernstein_roots().
+ * 
+ * @param	power		degree + 1 power basis coefficients, lowest degree first.
+ * @param	degree		Degree of the polynomial, at most k_max_bernstein_degree.
+ * @param	roots		Receives up to degree roots in increasing order.
+ * @param	tolerance	Width in t at which root intervals stop shrinking.
+ * @return	Number of roots found.
+**/
+u32 solve_polynomial_unit(const f64 * power, u32 degree, f64 * roots, f64 tolerance = ROUNDING_ERROR_64);
+
+/**
+ * Polish the single root of a polynomial inside a bracket with Newton's
+ * method, bisecting whenever a step would leave the bracket.
+ * 
+ * @param	power		degree + 1 power basis coefficients, lowest degree first.
+ * @param	degree		Degree of the polynomial.
+ * @param	lo			Start of the bracket.
+ * @param	hi			End of the bracket.
+ * @param	value_lo	Value of the polynomial at lo.
+ * @param	value_hi	Value of the polynomial at hi, opposite in sign to value_lo.
+ * @param	tolerance	Stop once steps or the bracket are smaller than this.
+**/
+f64 polish_bracketed_root(const f64 * power, u32 degree, f64 lo, f64 hi, f64 value_lo, f64 value_hi, f64 tolerance);
+
+/*****************************************************************************/
+} // End of namespace dnr.
+
+#endif // _BERNSTEIN_H.
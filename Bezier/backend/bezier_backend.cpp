@@ -26,7 +26,15 @@
 /*****************************************************************************/
 
 static const f64 k_anchor_radius = 4.0;
-static const f64 k_anchor_radius_sq = k_anchor_radius * k_anchor_radius;
+
+/// Length of the tangent and normal vectors drawn at t.
+static const f64 k_vector_length = 50.0;
+
+/**
+ * Padding around the drawn points for the damaged region, the widest stroke
+ * around an anchor plus a pixel for antialiasing.
+**/
+static const f64 k_damage_padding = k_anchor_radius + 1.5 + 1.0;
 
 /*****************************************************************************/
 
@@ -35,8 +43,29 @@ static void draw_circle(cairo_t * context, const vector2dd& pos, f64 radius) {
 	cairo_arc(context, pos.x, pos.y, radius, 0.0, 2.0 * PI64);
 }
 
+/**
+ * Fill the outline built by stroke(), which cairo can rasterize directly
+ * instead of flattening and offsetting the curve itself.
+**/
+static void fill_outline(cairo_t * context, const std::vector<cubic_spline>& contours) {
+	for (size_t i = 0; i < contours.size(); ++i) {
+		const cubic_spline& contour = contours[i];
+		const vector2dd * p = contour.points();
+		
+		cairo_move_to(context, p[0].x, p[0].y);
+		for (size_t j = 0; j < contour.size(); ++j, p += 3) {
+			cairo_curve_to(context, p[1].x, p[1].y, p[2].x, p[2].y, p[3].x, p[3].y);
+		}
+		
+		cairo_close_path(context);
+	}
+	
+	cairo_set_fill_rule(context, CAIRO_FILL_RULE_WINDING);
+	cairo_fill(context);
+}
+
 void bezier_backend::render(cairo_t * context, const vector2dd& size) {
-	m_needs_redraw = false;
+	clear_damage();
 	
 	// Draw black background.
 	cairo_set_source_rgb(context, 0.0, 0.0, 0.0);
@@ -48,7 +77,7 @@ void bezier_backend::render(cairo_t * context, const vector2dd& size) {
 	cairo_set_line_width(context, 0.5);
 	cairo_set_antialias(context, CAIRO_ANTIALIAS_NONE);
 	
-	aabboxd bounds = m_curve.bounds();
+	const aabboxd& bounds = m_cache.bounds();
 	cairo_rectangle(context, bounds.origin.x, bounds.origin.y, bounds.extent.x, bounds.extent.y);
 	cairo_fill_preserve(context);
 	
@@ -71,14 +100,8 @@ void bezier_backend::render(cairo_t * context, const vector2dd& size) {
 	
 	// Draw bezier curve.
 	cairo_set_source_rgb(context, 1.0, 1.0, 1.0);
-	cairo_set_line_width(context, 3.0);
-	cairo_move_to(context, m_curve.origin.x, m_curve.origin.y);
-	cairo_curve_to(context,
-		m_curve.control_1.x, m_curve.control_1.y,
-		m_curve.control_2.x, m_curve.control_2.y,
-		m_curve.endpoint.x, m_curve.endpoint.y
-	);
-	cairo_stroke(context);
+	
+	fill_outline(context, outline());
 	
 	
 	// Draw circles at each control point.
@@ -100,11 +123,11 @@ void bezier_backend::render(cairo_t * context, const vector2dd& size) {
 	
 	
 	// Draw tangent vector.
-	vector2dd point = m_curve.get_point(m_t);
+	vector2dd point = m_cache.get_point(m_t);
 	
-	vector2dd tangent = m_curve.get_tangent(m_t);
+	vector2dd tangent = m_cache.get_tangent(m_t);
 	tangent.normalize();
-	tangent *= 50.0f; // Scale the vector for easy viewing.
+	tangent *= k_vector_length; // Scale the vector for easy viewing.
 	
 	cairo_set_source_rgb(context, 1.0, 0.0, 0.0);
 	cairo_move_to(context, point.x, point.y);
@@ -112,9 +135,9 @@ void bezier_backend::render(cairo_t * context, const vector2dd& size) {
 	cairo_stroke(context);
 	
 	// Draw normal vector.
-	vector2dd normal = m_curve.get_normal(m_t);
+	vector2dd normal = m_cache.get_normal(m_t);
 	normal.normalize();
-	normal *= 50.0f; // Scale the vector for easy viewing.
+	normal *= k_vector_length; // Scale the vector for easy viewing.
 	
 	cairo_set_source_rgb(context, 0.0, 1.0, 0.0);
 	cairo_move_to(context, point.x, point.y);
@@ -126,22 +149,21 @@ void bezier_backend::render(cairo_t * context, const vector2dd& size) {
  * Called when the mouse is pressed.
 **/
 void bezier_backend::click(const vector2dd& pos, bool inside) {
-	for (size_t i = 0; i < 4; ++i) {
-		if (pos.distance_sq(m_curve[i]) <= k_anchor_radius_sq) {
-			m_needs_redraw = true;
-			m_anchor = &m_curve[i];
-			break;
-		}
-	}
+	m_anchor = m_anchor_index.nearest(pos, k_anchor_radius);
+	if (m_anchor != bvh::k_invalid) m_needs_redraw = true;
 }
 
 /**
  * Called when the mouse is moved when being held.
 **/
 void bezier_backend::drag(const vector2dd& pos, bool inside) {
-	if (inside && m_anchor) {
-		m_anchor->set(pos);
-		m_needs_redraw = true;
+	if (inside && m_anchor != bvh::k_invalid) {
+		damage_drawn();
+		
+		m_curve.set(m_anchor, pos);
+		m_anchor_index.refit(m_anchor, aabboxd(pos, vector2dd()));
+		
+		damage_drawn();
 	}
 }
 
@@ -153,7 +175,59 @@ void bezier_backend::release(const vector2dd& pos, bool inside) {
 	drag(pos, inside);
 	
 	// Unset the anchor.
-	m_anchor = 0;
+	m_anchor = bvh::k_invalid;
+}
+
+/**
+ * Rebuild m_anchor_index from the control points.
+**/
+void bezier_backend::build_anchor_index() {
+	aabboxd boxes[4];
+	for (size_t i = 0; i < 4; ++i) {
+		boxes[i].reset(m_curve[i]);
+	}
+	
+	m_anchor_index.build(boxes, 4);
+}
+
+/**
+ * Get a box containing everything render() draws.
+**/
+aabboxd bezier_backend::drawn_bounds() const {
+	// The control points contain the curve and its bounds, add the ends of
+	// the tangent and normal vectors.
+	aabboxd box;
+	box.reset(m_curve.origin);
+	box.add_internal_point(m_curve.control_1);
+	box.add_internal_point(m_curve.control_2);
+	box.add_internal_point(m_curve.endpoint);
+	
+	const vector2dd point = m_cache.get_point(m_t);
+	
+	vector2dd tangent = m_cache.get_tangent(m_t);
+	tangent.normalize();
+	box.add_internal_point(point + k_vector_length * tangent);
+	
+	vector2dd normal = m_cache.get_normal(m_t);
+	normal.normalize();
+	box.add_internal_point(point + k_vector_length * normal);
+	
+	box.origin -= vector2dd(k_damage_padding, k_damage_padding);
+	box.extent += vector2dd(2.0 * k_damage_padding, 2.0 * k_damage_padding);
+	return box;
+}
+
+/**
+ * Get the stroke outline of the curve, rebuilding it if necessary.
+**/
+const std::vector<cubic_spline>& bezier_backend::outline() {
+	if (m_outline_version != m_curve.version()) {
+		m_outline.clear();
+		stroke(m_curve, stroke_style(3.0, stroke_style::k_join_round, stroke_style::k_cap_butt), m_outline);
+		m_outline_version = m_curve.version();
+	}
+	
+	return m_outline;
 }
 
 /*****************************************************************************/
@@ -27,6 +27,9 @@
 #include <cairo/cairo.h>
 #include "vector2d.h"
 #include "cubic_bezier.h"
+#include "curve_cache.h"
+#include "bvh.h"
+#include "stroke.h"
 using namespace dnr;
 
 /*****************************************************************************/
@@ -34,16 +37,52 @@ using namespace dnr;
 class bezier_backend {
 private:
 	bool m_needs_redraw;
-	vector2dd * m_anchor;
+	u32 m_anchor; // Index of the control point being dragged, or bvh::k_invalid.
 	
 	cubic_bezier m_curve;
+	curve_cache m_cache; // Derived data of m_curve, rebuilt when an anchor moves.
 	f64 m_t;
 	
+	std::vector<cubic_spline> m_outline; // Stroke outline of m_curve, see outline().
+	u64 m_outline_version; // Version of m_curve that m_outline was built from.
+	
+	/**
+	 * Get the stroke outline of the curve, rebuilding it if necessary.
+	**/
+	const std::vector<cubic_spline>& outline();
+	
+	bvh m_anchor_index; // Control points of m_curve, for hit-testing.
+	
+	/**
+	 * Rebuild m_anchor_index from the control points.
+	**/
+	void build_anchor_index();
+	
+	aabboxd m_damage; // Region changed since the last render(), in view coordinates.
+	
+	/**
+	 * Get a box containing everything render() draws.
+	**/
+	aabboxd drawn_bounds() const;
+	
+	/**
+	 * Add what is currently drawn to the damaged region.  Call before and
+	 * after a change so that both the old and new drawing are repainted.
+	**/
+	void damage_drawn() {
+		m_damage.add_internal_box(drawn_bounds());
+		m_needs_redraw = true;
+	}
+	
 public:
 	bezier_backend()
 			: m_needs_redraw(true)
+			, m_anchor(bvh::k_invalid)
+			, m_cache(m_curve)
 			, m_t(0.0)
-			, m_anchor(0) { }
+			, m_outline_version(0) {
+		build_anchor_index();
+	}
 	
 	/**
 	 * Called to render to the view.
@@ -76,12 +115,51 @@ public:
 	/**
 	 * Set the position on the spline.
 	**/
-	void t(f64 _t) { m_t = _t; }
+	void t(f64 _t) {
+		damage_drawn();
+		m_t = _t;
+		damage_drawn();
+	}
+	
+	/**
+	 * Get the length of the spline.
+	**/
+	f64 length() { return m_cache.arc_length().length(); }
+	
+	/**
+	 * Get the current position on the spline as a distance from the origin.
+	**/
+	f64 distance() { return m_cache.arc_length().length_at_t(m_t); }
+	
+	/**
+	 * Set the position on the spline by distance from the origin, which
+	 * moves along the spline at constant speed as the distance changes.
+	**/
+	void distance(f64 s) { t(m_cache.arc_length().t_at_length(s)); }
 	
 	/**
 	 * Does the view need to be redrawn?
 	**/
 	bool needs_redraw() const { return m_needs_redraw; }
+	
+	/**
+	 * Get the region that has changed since the last render(), in view
+	 * coordinates.  Inactive if nothing visible has changed.
+	**/
+	const aabboxd& damage() const { return m_damage; }
+	
+	/**
+	 * Mark the view as up to date without rendering.
+	**/
+	void clear_damage() {
+		m_damage.deactivate();
+		m_needs_redraw = false;
+	}
+	
+private:
+	// Not copyable, m_cache refers to m_curve.
+	bezier_backend(const bezier_backend&);
+	bezier_backend& operator=(const bezier_backend&);
 };
 
 /*****************************************************************************/
@@ -0,0 +1,306 @@
+/*
+ * bvh.cpp
+ * Bezier
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+#include "bvh.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace dnr {
+/*****************************************************************************/
+
+/// Deepest traversal supported, median splits keep the tree far shallower.
+static const u32 k_max_stack = 64;
+
+/**
+ * Orders items by the center of their bounding box along one axis.
+**/
+struct center_less {
+	const std::vector<vector2dd>& centers;
+	bool x_axis;
+	
+	center_less(const std::vector<vector2dd>& _centers, bool _x_axis)
+		: centers(_centers), x_axis(_x_axis) { }
+	
+	bool operator()(u32 lhs, u32 rhs) const {
+		return x_axis ? centers[lhs].x < centers[rhs].x : centers[lhs].y < centers[rhs].y;
+	}
+};
+
+/*****************************************************************************/
+
+void bvh::build(const aabboxd * boxes, size_t count) {
+	clear();
+	if (count == 0) return;
+	
+	m_boxes.assign(boxes, boxes + count);
+	m_items.resize(count);
+	m_leaf_of.resize(count);
+	m_centers.resize(count);
+	
+	for (size_t i = 0; i < count; ++i) {
+		m_items[i] = u32(i);
+		m_centers[i] = boxes[i].origin + 0.5 * boxes[i].extent;
+	}
+	
+	/* A tree with n leaves has 2n - 1 nodes.  Median splits only split runs
+	 * longer than k_leaf_size, so every leaf holds at least two items.
+	**/
+	m_nodes.reserve(count);
+	m_nodes.push_back(node());
+	build_recursive(0, 0, u32(count));
+	
+	m_centers.clear();
+}
+
+void bvh::build_recursive(u32 idx, u32 first, u32 count) {
+	// Bound the items and their centers.
+	aabboxd center_box;
+	aabboxd box;
+	
+	for (u32 i = first; i < first + count; ++i) {
+		box.add_internal_box(m_boxes[m_items[i]]);
+		center_box.add_internal_point(m_centers[m_items[i]]);
+	}
+	
+	m_nodes[idx].box = box;
+	
+	if (count <= k_leaf_size) {
+		m_nodes[idx].first = first;
+		m_nodes[idx].count = count;
+		
+		for (u32 i = first; i < first + count; ++i) {
+			m_leaf_of[m_items[i]] = idx;
+		}
+		
+		return;
+	}
+	
+	// Split at the median along the axis where the centers are most spread.
+	const u32 half = count / 2;
+	std::nth_element(m_items.begin() + first, m_items.begin() + first + half, m_items.begin() + first + count,
+		center_less(m_centers, center_box.extent.x >= center_box.extent.y));
+	
+	// Children are allocated together so that the right child is first + 1.
+	const u32 child = u32(m_nodes.size());
+	m_nodes.push_back(node());
+	m_nodes.push_back(node());
+	
+	m_nodes[idx].first = child;
+	m_nodes[idx].count = 0;
+	
+	m_nodes[child].parent = idx;
+	m_nodes[child + 1].parent = idx;
+	
+	build_recursive(child, first, half);
+	build_recursive(child + 1, first + half, count - half);
+}
+
+void bvh::assign(const node * nodes, size_t node_count, const u32 * items, const aabboxd * boxes, size_t count) {
+	clear();
+	if (count == 0 && node_count == 0) return;
+	
+	m_nodes.assign(nodes, nodes + node_count);
+	m_items.assign(items, items + count);
+	m_boxes.assign(boxes, boxes + count);
+	
+	if (!link_leaves()) {
+		clear();
+		throw std::out_of_range("invalid bvh");
+	}
+}
+
+bool bvh::link_leaves() {
+	const size_t count = m_items.size();
+	const size_t node_count = m_nodes.size();
+	if (count == 0 || node_count == 0 || node_count >= 2 * count) return false;
+	
+	m_leaf_of.assign(count, u32(k_invalid));
+	
+	/* Children always follow their parent, as build() allocates them, which
+	 * rules out cycles.  Links are checked both ways, so every node is
+	 * reachable from the root and no leaf's items are missed by a traversal.
+	 * The depth is checked against the traversal stack.
+	**/
+	std::vector<u32> depth(node_count, 0);
+	
+	for (u32 idx = 0; idx < node_count; ++idx) {
+		const node& n = m_nodes[idx];
+		if ((idx == 0) != (n.parent == k_invalid)) return false;
+		
+		if (idx != 0) {
+			if (n.parent >= idx) return false;
+			
+			const node& parent = m_nodes[n.parent];
+			if (parent.is_leaf() || (parent.first != idx && parent.first + 1 != idx)) return false;
+			
+			depth[idx] = depth[n.parent] + 1;
+			if (depth[idx] + 1 >= k_max_stack) return false;
+		}
+		
+		if (n.is_leaf()) {
+			if (n.first > count || n.count > count - n.first) return false;
+			
+			for (u32 i = n.first; i < n.first + n.count; ++i) {
+				const u32 item = m_items[i];
+				if (item >= count || m_leaf_of[item] != k_invalid) return false;
+				m_leaf_of[item] = idx;
+			}
+		} else if (n.first <= idx || n.first >= node_count - 1
+				|| m_nodes[n.first].parent != idx || m_nodes[n.first + 1].parent != idx) {
+			return false;
+		}
+	}
+	
+	// Every item must be in exactly one leaf.
+	for (size_t i = 0; i < count; ++i) {
+		if (m_leaf_of[i] == k_invalid) return false;
+	}
+	
+	return true;
+}
+
+void bvh::clear() {
+	m_nodes.clear();
+	m_items.clear();
+	m_boxes.clear();
+	m_leaf_of.clear();
+	m_centers.clear();
+}
+
+aabboxd bvh::leaf_box(const node& leaf) const {
+	aabboxd box;
+	
+	for (u32 i = leaf.first; i < leaf.first + leaf.count; ++i) {
+		box.add_internal_box(m_boxes[m_items[i]]);
+	}
+	
+	return box;
+}
+
+void bvh::refit(u32 item, const aabboxd& box) {
+	m_boxes[item] = box;
+	
+	u32 idx = m_leaf_of[item];
+	m_nodes[idx].box = leaf_box(m_nodes[idx]);
+	
+	// Walk up to the root, rebuilding each box from its two children.
+	for (idx = m_nodes[idx].parent; idx != k_invalid; idx = m_nodes[idx].parent) {
+		node& parent = m_nodes[idx];
+		
+		parent.box = m_nodes[parent.first].box;
+		parent.box.add_internal_box(m_nodes[parent.first + 1].box);
+	}
+}
+
+void bvh::query_point(const vector2dd& pt, f64 radius, std::vector<u32>& out) const {
+	if (m_nodes.empty()) return;
+	
+	const f64 radius_sq = radius * radius;
+	u32 stack[k_max_stack];
+	u32 top = 0;
+	stack[top++] = 0;
+	
+	while (top) {
+		const node& n = m_nodes[stack[--top]];
+		if (!n.box.active || n.box.distance_sq(pt) > radius_sq) continue;
+		
+		if (n.is_leaf()) {
+			for (u32 i = n.first; i < n.first + n.count; ++i) {
+				const aabboxd& box = m_boxes[m_items[i]];
+				if (box.active && box.distance_sq(pt) <= radius_sq) out.push_back(m_items[i]);
+			}
+		} else {
+			stack[top++] = n.first;
+			stack[top++] = n.first + 1;
+		}
+	}
+}
+
+void bvh::query_rect(const aabboxd& rect, std::vector<u32>& out) const {
+	if (m_nodes.empty()) return;
+	
+	u32 stack[k_max_stack];
+	u32 top = 0;
+	stack[top++] = 0;
+	
+	while (top) {
+		const node& n = m_nodes[stack[--top]];
+		if (!n.box.intersects(rect)) continue;
+		
+		if (n.is_leaf()) {
+			for (u32 i = n.first; i < n.first + n.count; ++i) {
+				if (m_boxes[m_items[i]].intersects(rect)) out.push_back(m_items[i]);
+			}
+		} else {
+			stack[top++] = n.first;
+			stack[top++] = n.first + 1;
+		}
+	}
+}
+
+u32 bvh::nearest(const vector2dd& pt, f64 max_distance) const {
+	if (m_nodes.empty()) return k_invalid;
+	
+	u32 best = k_invalid;
+	f64 best_sq = max_distance * max_distance;
+	
+	u32 stack[k_max_stack];
+	u32 top = 0;
+	stack[top++] = 0;
+	
+	while (top) {
+		const node& n = m_nodes[stack[--top]];
+		if (!n.box.active || n.box.distance_sq(pt) > best_sq) continue;
+		
+		if (n.is_leaf()) {
+			for (u32 i = n.first; i < n.first + n.count; ++i) {
+				const aabboxd& box = m_boxes[m_items[i]];
+				if (!box.active) continue;
+				
+				const f64 dist_sq = box.distance_sq(pt);
+				if (dist_sq <= best_sq) {
+					best = m_items[i];
+					best_sq = dist_sq;
+				}
+			}
+		} else {
+			// Push the nearer child last so that it is visited first, which
+			// shrinks best_sq sooner.
+			const f64 left_sq = m_nodes[n.first].box.distance_sq(pt);
+			const f64 right_sq = m_nodes[n.first + 1].box.distance_sq(pt);
+			
+			if (left_sq < right_sq) {
+				stack[top++] = n.first + 1;
+				stack[top++] = n.first;
+			} else {
+				stack[top++] = n.first;
+				stack[top++] = n.first + 1;
+			}
+		}
+	}
+	
+	return best;
+}
+
+/*****************************************************************************/
+} // End of namespace dnr.
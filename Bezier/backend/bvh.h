@@ -0,0 +1,161 @@
+/*
+ * bvh.h
+ * Bezier
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+#ifndef _BVH_H
+#define _BVH_H
+
+#include <vector>
+#include "aabbox.h"
+
+namespace dnr {
+/*****************************************************************************/
+
+/**
+ * Bounding volume hierarchy over a set of items, each represented by an
+ * aabboxd.
+ * 
+ * Items are identified by their index in the array passed to build().  The
+ * tree is stored as a flat node array: the children of an internal node are
+ * always adjacent, and a leaf refers to a run of up to k_leaf_size items.
+ * Moving an item only requires refit(), which walks from its leaf to the
+ * root.
+**/
+class bvh {
+public:
+	/// Maximum number of items in a leaf.
+	static const u32 k_leaf_size = 4;
+	
+	/// Marks the root node's parent, and a missing result.
+	static const u32 k_invalid = 0xFFFFFFFF;
+	
+	struct node {
+		aabboxd box;
+		u32 first;	/// Index of the left child, or of the first item for a leaf.
+		u32 count;	/// Number of items in a leaf, 0 for an internal node.
+		u32 parent;	/// Index of the parent, k_invalid for the root.
+		
+		node() : first(0), count(0), parent(k_invalid) { }
+		
+		bool is_leaf() const { return count != 0; }
+	};
+	
+	bvh() { }
+	
+	/**
+	 * Build the tree from scratch.
+	 * 
+	 * @param	boxes	Bounding box of each item.
+	 * @param	count	Number of items.
+	**/
+	void build(const aabboxd * boxes, size_t count);
+	
+	/**
+	 * Load a tree built earlier, such as one stored in a scene_file, instead
+	 * of building it again.  The arrays are copied as they are and checked
+	 * for consistency, only the leaf of each item is recomputed.
+	 * 
+	 * @param	nodes		Flat node array, see nodes().
+	 * @param	node_count	Number of nodes.
+	 * @param	items		Item indices in leaf order, see items().
+	 * @param	boxes		Bounding box of each item.
+	 * @param	count		Number of items.
+	**/
+	void assign(const node * nodes, size_t node_count, const u32 * items, const aabboxd * boxes, size_t count);
+	
+	/**
+	 * Remove all items.
+	**/
+	void clear();
+	
+	/**
+	 * Get the number of items.
+	**/
+	size_t size() const { return m_boxes.size(); }
+	
+	/**
+	 * Get the bounding box of an item.
+	**/
+	const aabboxd& item_box(u32 item) const { return m_boxes[item]; }
+	
+	/**
+	 * Update the bounding box of one item and refit its ancestors, in
+	 * O(log n).  The tree is not rebalanced, rebuild it after large edits.
+	**/
+	void refit(u32 item, const aabboxd& box);
+	
+	/**
+	 * Find all items whose bounding box is within a distance of a point.
+	 * 
+	 * @param	pt		Point to test.
+	 * @param	radius	Maximum distance from the box, 0 for boxes containing pt.
+	 * @param	out		Receives the matching item indices.
+	**/
+	void query_point(const vector2dd& pt, f64 radius, std::vector<u32>& out) const;
+	
+	/**
+	 * Find all items whose bounding box overlaps a rectangle.
+	**/
+	void query_rect(const aabboxd& rect, std::vector<u32>& out) const;
+	
+	/**
+	 * Find the item whose bounding box is nearest to a point.  For items
+	 * that are single points, such as anchors, this is the nearest item.
+	 * 
+	 * @param	pt		Point to test.
+	 * @param	max_distance	Ignore items further away than this.
+	 * @return	Item index, or k_invalid if no item is in range.
+	**/
+	u32 nearest(const vector2dd& pt, f64 max_distance) const;
+	
+	/**
+	 * Direct access to the flat node array, the root is node 0.
+	**/
+	const std::vector<node>& nodes() const { return m_nodes; }
+	
+	/**
+	 * Item indices in leaf order, leaves refer to runs of this array.
+	**/
+	const std::vector<u32>& items() const { return m_items; }
+	
+private:
+	void build_recursive(u32 idx, u32 first, u32 count);
+	
+	/**
+	 * Check the tree loaded by assign() and fill in m_leaf_of.
+	 * 
+	 * @return	false if the arrays do not form a valid tree.
+	**/
+	bool link_leaves();
+	aabboxd leaf_box(const node& leaf) const;
+	
+	std::vector<node> m_nodes;
+	std::vector<u32> m_items;
+	std::vector<aabboxd> m_boxes;	// Indexed by item.
+	std::vector<u32> m_leaf_of;		// Leaf node containing each item.
+	std::vector<vector2dd> m_centers; // Scratch space for build().
+};
+
+/*****************************************************************************/
+} // End of namespace dnr.
+
+#endif // _BVH_H.
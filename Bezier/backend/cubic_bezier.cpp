@@ -23,10 +23,347 @@
 
 #include "cubic_bezier.h"
 
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
+
 namespace dnr {
 /*****************************************************************************/
 
+u64 cubic_bezier::s_version_counter = 0;
+
+u64 cubic_bezier::next_version() {
+#if defined(_MSC_VER)
+	return u64(InterlockedIncrement64(reinterpret_cast<volatile LONG64 *>(&s_version_counter)));
+#else
+	return __sync_add_and_fetch(&s_version_counter, 1);
+#endif
+}
+
+/*****************************************************************************/
+
+/* The curve, tangent and normal are all polynomials of this form, so the
+ * batch functions only differ in the coefficients they pass in.
+**/
+void evaluate_horner(const cubic_coefficients& k, const f64 * t, size_t count, f64 * out_x, f64 * out_y) {
+	size_t i = 0;
+	
+#if defined(__AVX__)
+	const __m256d ax = _mm256_set1_pd(k.a.x), ay = _mm256_set1_pd(k.a.y);
+	const __m256d bx = _mm256_set1_pd(k.b.x), by = _mm256_set1_pd(k.b.y);
+	const __m256d cx = _mm256_set1_pd(k.c.x), cy = _mm256_set1_pd(k.c.y);
+	const __m256d dx = _mm256_set1_pd(k.d.x), dy = _mm256_set1_pd(k.d.y);
+	
+	for (; i + 4 <= count; i += 4) {
+		const __m256d tt = _mm256_loadu_pd(t + i);
+		
+		__m256d x = _mm256_add_pd(_mm256_mul_pd(ax, tt), bx);
+		__m256d y = _mm256_add_pd(_mm256_mul_pd(ay, tt), by);
+		x = _mm256_add_pd(_mm256_mul_pd(x, tt), cx);
+		y = _mm256_add_pd(_mm256_mul_pd(y, tt), cy);
+		x = _mm256_add_pd(_mm256_mul_pd(x, tt), dx);
+		y = _mm256_add_pd(_mm256_mul_pd(y, tt), dy);
+		
+		_mm256_storeu_pd(out_x + i, x);
+		_mm256_storeu_pd(out_y + i, y);
+	}
+#elif defined(__SSE2__)
+	const __m128d ax = _mm_set1_pd(k.a.x), ay = _mm_set1_pd(k.a.y);
+	const __m128d bx = _mm_set1_pd(k.b.x), by = _mm_set1_pd(k.b.y);
+	const __m128d cx = _mm_set1_pd(k.c.x), cy = _mm_set1_pd(k.c.y);
+	const __m128d dx = _mm_set1_pd(k.d.x), dy = _mm_set1_pd(k.d.y);
+	
+	for (; i + 2 <= count; i += 2) {
+		const __m128d tt = _mm_loadu_pd(t + i);
+		
+		__m128d x = _mm_add_pd(_mm_mul_pd(ax, tt), bx);
+		__m128d y = _mm_add_pd(_mm_mul_pd(ay, tt), by);
+		x = _mm_add_pd(_mm_mul_pd(x, tt), cx);
+		y = _mm_add_pd(_mm_mul_pd(y, tt), cy);
+		x = _mm_add_pd(_mm_mul_pd(x, tt), dx);
+		y = _mm_add_pd(_mm_mul_pd(y, tt), dy);
+		
+		_mm_storeu_pd(out_x + i, x);
+		_mm_storeu_pd(out_y + i, y);
+	}
+#endif
+	
+	// Scalar path, also handles the leftover positions.
+	for (; i < count; ++i) {
+		const f64 tt = t[i];
+		out_x[i] = ((k.a.x * tt + k.b.x) * tt + k.c.x) * tt + k.d.x;
+		out_y[i] = ((k.a.y * tt + k.b.y) * tt + k.c.y) * tt + k.d.y;
+	}
+}
+
+void cubic_bezier::get_points(const f64 * t, size_t count, f64 * out_x, f64 * out_y) const {
+	evaluate_horner(power_basis(), t, count, out_x, out_y);
+}
+
+void cubic_bezier::get_tangents(const f64 * t, size_t count, f64 * out_x, f64 * out_y) const {
+	evaluate_horner(first_derivative(), t, count, out_x, out_y);
+}
+
+void cubic_bezier::get_normals(const f64 * t, size_t count, f64 * out_x, f64 * out_y) const {
+	evaluate_horner(second_derivative(), t, count, out_x, out_y);
+}
+
+/**
+ * Evaluate the second level of de Casteljau's algorithm, given the first.
+**/
+static inline void casteljau_level(const vector2dd * p, f64 t, vector2dd * out) {
+	const f64 rev_t = 1.0 - t;
+	out[0] = rev_t * p[0] + t * p[1];
+	out[1] = rev_t * p[1] + t * p[2];
+}
+
+cubic_bezier cubic_bezier::subsegment(f64 t0, f64 t1) const {
+	/* The control points of the piece over [t0, t1] are the blossom values
+	 * B(t0, t0, t0), B(t0, t0, t1), B(t0, t1, t1) and B(t1, t1, t1), which is
+	 * de Casteljau's algorithm with a different t at each level.  The first
+	 * two levels are shared between the four points.
+	**/
+	const vector2dd p[4] = { origin, control_1, control_2, endpoint };
+	const f64 rev_t0 = 1.0 - t0;
+	const f64 rev_t1 = 1.0 - t1;
+	
+	vector2dd a0[3], a1[3];
+	for (u32 i = 0; i < 3; ++i) {
+		a0[i] = rev_t0 * p[i] + t0 * p[i + 1];
+		a1[i] = rev_t1 * p[i] + t1 * p[i + 1];
+	}
+	
+	vector2dd b00[2], b01[2], b11[2];
+	casteljau_level(a0, t0, b00);
+	casteljau_level(a0, t1, b01);
+	casteljau_level(a1, t1, b11);
+	
+	return cubic_bezier(
+		rev_t0 * b00[0] + t0 * b00[1],
+		rev_t1 * b00[0] + t1 * b00[1],
+		rev_t1 * b01[0] + t1 * b01[1],
+		rev_t1 * b11[0] + t1 * b11[1]
+	);
+}
+
+size_t cubic_bezier::split_many(const f64 * t, size_t count, vector2dd * out) const {
+	// Control points of the part of the curve not yet written, from start
+	// to 1.0.
+	vector2dd rest[4] = { origin, control_1, control_2, endpoint };
+	f64 start = 0.0;
+	
+	out[0] = origin;
+	
+	for (size_t i = 0; i < count; ++i, out += 3) {
+		const f64 cut = clamp(t[i], start, 1.0);
+		
+		// Position of the cut within what remains.
+		const f64 remaining = 1.0 - start;
+		const f64 u = remaining > 0.0 ? (cut - start) / remaining : 0.0;
+		const f64 rev_u = 1.0 - u;
+		
+		const vector2dd p01 = rev_u * rest[0] + u * rest[1];
+		const vector2dd p12 = rev_u * rest[1] + u * rest[2];
+		const vector2dd p23 = rev_u * rest[2] + u * rest[3];
+		const vector2dd p012 = rev_u * p01 + u * p12;
+		const vector2dd p123 = rev_u * p12 + u * p23;
+		const vector2dd mid = rev_u * p012 + u * p123;
+		
+		out[1] = p01;
+		out[2] = p012;
+		out[3] = mid;
+		
+		rest[0] = mid;
+		rest[1] = p123;
+		rest[2] = p23;
+		start = cut;
+	}
+	
+	out[1] = rest[1];
+	out[2] = rest[2];
+	out[3] = rest[3];
+	return count + 1;
+}
+
+void cubic_bezier::get_points_uniform(size_t steps, f64 * out_x, f64 * out_y) const {
+	const cubic_coefficients k = power_basis();
+	const f64 h = 1.0 / f64(steps);
+	const f64 h2 = h * h;
+	const f64 h3 = h2 * h;
+	
+	/* Forward differences of the power basis with step h:
+	 * 
+	 * d1 = a h^3 + b h^2 + c h
+	 * d2 = 6a h^3 + 2b h^2
+	 * d3 = 6a h^3
+	 * 
+	 * Each new point then costs three additions per coordinate.
+	**/
+	vector2dd point = k.d;
+	vector2dd d1 = k.a * h3 + k.b * h2 + k.c * h;
+	vector2dd d2 = 6.0 * h3 * k.a + 2.0 * h2 * k.b;
+	const vector2dd d3 = 6.0 * h3 * k.a;
+	
+#if defined(__SSE2__)
+	__m128d p = _mm_loadu_pd(&point.x);
+	__m128d v1 = _mm_loadu_pd(&d1.x);
+	__m128d v2 = _mm_loadu_pd(&d2.x);
+	const __m128d v3 = _mm_loadu_pd(&d3.x);
+	
+	for (size_t i = 0; i < steps; ++i) {
+		_mm_storel_pd(out_x + i, p);
+		_mm_storeh_pd(out_y + i, p);
+		
+		p = _mm_add_pd(p, v1);
+		v1 = _mm_add_pd(v1, v2);
+		v2 = _mm_add_pd(v2, v3);
+	}
+#else
+	for (size_t i = 0; i < steps; ++i) {
+		out_x[i] = point.x;
+		out_y[i] = point.y;
+		
+		point += d1;
+		d1 += d2;
+		d2 += d3;
+	}
+#endif
+	
+	// Avoid accumulated error at the end of the curve.
+	out_x[steps] = endpoint.x;
+	out_y[steps] = endpoint.y;
+}
+
+/*****************************************************************************/
+
+/**
+ * Bound a single curve.  See bounds_batch() and cubic_bezier::bounds().
+ * 
+ * The derivative roots are found with the form of the quadratic formula
+ * that avoids cancellation:
+ * 
+ * q = -(b + sign(b) sqrt(b^2 - 4ac)) / 2,  t_1 = q / a,  t_2 = c / q
+ * 
+ * When a is zero t_2 is the root of the linear equation bt + c = 0, and t_1
+ * is infinite or NaN, which the clamp to [0, 1] turns into an endpoint.
+**/
+static inline void bounds_kernel(const vector2dd& p0, const vector2dd& p1, const vector2dd& p2, const vector2dd& p3, aabboxd& box) {
+#if defined(__SSE2__)
+	const __m128d v0 = _mm_loadu_pd(&p0.x);
+	const __m128d v1 = _mm_loadu_pd(&p1.x);
+	const __m128d v2 = _mm_loadu_pd(&p2.x);
+	const __m128d v3 = _mm_loadu_pd(&p3.x);
+	
+	const __m128d zero = _mm_setzero_pd();
+	const __m128d one = _mm_set1_pd(1.0);
+	const __m128d three = _mm_set1_pd(3.0);
+	const __m128d sign_mask = _mm_set1_pd(-0.0);
+	
+	// Power basis: B(t) = ((pa t + pb) t + pc) t + p0.
+	const __m128d p1_p2 = _mm_sub_pd(v1, v2);
+	const __m128d pa = _mm_add_pd(_mm_sub_pd(v3, v0), _mm_mul_pd(three, p1_p2));
+	const __m128d pb = _mm_mul_pd(three, _mm_sub_pd(_mm_add_pd(v0, v2), _mm_add_pd(v1, v1)));
+	const __m128d pc = _mm_mul_pd(three, _mm_sub_pd(v1, v0));
+	
+	// Derivative: a t^2 + b t + c = 3 pa t^2 + 2 pb t + pc.
+	const __m128d a = _mm_mul_pd(three, pa);
+	const __m128d b = _mm_add_pd(pb, pb);
+	const __m128d c = pc;
+	
+	const __m128d disc = _mm_sub_pd(_mm_mul_pd(b, b), _mm_mul_pd(_mm_set1_pd(4.0), _mm_mul_pd(a, c)));
+	const __m128d has_roots = _mm_cmpge_pd(disc, zero);
+	const __m128d root = _mm_sqrt_pd(_mm_max_pd(disc, zero));
+	
+	// q = -0.5 (b + sign(b) sqrt(disc)).
+	const __m128d signed_root = _mm_or_pd(root, _mm_and_pd(b, sign_mask));
+	const __m128d q = _mm_mul_pd(_mm_set1_pd(-0.5), _mm_add_pd(b, signed_root));
+	
+	/* Complex roots are masked to zero.  maxpd returns its second operand
+	 * when either is NaN, so the clamp also maps NaN roots to zero.
+	**/
+	__m128d t1 = _mm_and_pd(has_roots, _mm_div_pd(q, a));
+	__m128d t2 = _mm_and_pd(has_roots, _mm_div_pd(c, q));
+	t1 = _mm_min_pd(_mm_max_pd(t1, zero), one);
+	t2 = _mm_min_pd(_mm_max_pd(t2, zero), one);
+	
+	// Each lane only needs its own coordinate at its own roots.
+	__m128d e1 = _mm_add_pd(_mm_mul_pd(pa, t1), pb);
+	__m128d e2 = _mm_add_pd(_mm_mul_pd(pa, t2), pb);
+	e1 = _mm_add_pd(_mm_mul_pd(e1, t1), pc);
+	e2 = _mm_add_pd(_mm_mul_pd(e2, t2), pc);
+	e1 = _mm_add_pd(_mm_mul_pd(e1, t1), v0);
+	e2 = _mm_add_pd(_mm_mul_pd(e2, t2), v0);
+	
+	const __m128d lo = _mm_min_pd(_mm_min_pd(v0, v3), _mm_min_pd(e1, e2));
+	const __m128d hi = _mm_max_pd(_mm_max_pd(v0, v3), _mm_max_pd(e1, e2));
+	
+	_mm_storeu_pd(&box.origin.x, lo);
+	_mm_storeu_pd(&box.extent.x, _mm_sub_pd(hi, lo));
+	box.active = true;
+#else
+	const vector2dd pa = p3 - p0 + 3.0 * (p1 - p2);
+	const vector2dd pb = 3.0 * (p0 + p2 - 2.0 * p1);
+	const vector2dd pc = 3.0 * (p1 - p0);
+	
+	const f64 k_pa[2] = { pa.x, pa.y };
+	const f64 k_pb[2] = { pb.x, pb.y };
+	const f64 k_pc[2] = { pc.x, pc.y };
+	const f64 k_p0[2] = { p0.x, p0.y };
+	const f64 k_p3[2] = { p3.x, p3.y };
+	f64 lo[2], hi[2];
+	
+	for (u32 i = 0; i < 2; ++i) {
+		const f64 a = 3.0 * k_pa[i];
+		const f64 b = 2.0 * k_pb[i];
+		const f64 c = k_pc[i];
+		const f64 disc = b * b - 4.0 * a * c;
+		
+		f64 t[2] = { 0.0, 0.0 };
+		if (disc >= 0.0) {
+			const f64 q = -0.5 * (b + (b < 0.0 ? -sqrt(disc) : sqrt(disc)));
+			t[0] = q / a;
+			t[1] = c / q;
+		}
+		
+		lo[i] = min_(k_p0[i], k_p3[i]);
+		hi[i] = max_(k_p0[i], k_p3[i]);
+		
+		for (u32 j = 0; j < 2; ++j) {
+			// Written so that NaN fails the first test and maps to zero.
+			const f64 tt = !(t[j] > 0.0) ? 0.0 : min_(t[j], 1.0);
+			const f64 e = ((k_pa[i] * tt + k_pb[i]) * tt + k_pc[i]) * tt + k_p0[i];
+			
+			lo[i] = min_(lo[i], e);
+			hi[i] = max_(hi[i], e);
+		}
+	}
+	
+	box.origin.set(lo[0], lo[1]);
+	box.extent.set(hi[0] - lo[0], hi[1] - lo[1]);
+	box.active = true;
+#endif
+}
+
+void bounds_batch(const cubic_bezier * curves, size_t count, aabboxd * out) {
+	for (size_t i = 0; i < count; ++i) {
+		const cubic_bezier& curve = curves[i];
+		bounds_kernel(curve.origin, curve.control_1, curve.control_2, curve.endpoint, out[i]);
+	}
+}
 
+void bounds_batch(const vector2dd * points, size_t stride, size_t count, aabboxd * out) {
+	for (size_t i = 0; i < count; ++i, points += stride) {
+		bounds_kernel(points[0], points[1], points[2], points[3], out[i]);
+	}
+}
 
 /*****************************************************************************/
 } // End of namespace dnr.
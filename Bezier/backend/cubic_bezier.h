@@ -24,6 +24,7 @@
 #ifndef _CUBIC_BEZIER_H
 #define _CUBIC_BEZIER_H
 
+#include <cstddef>
 #include <stdexcept>
 #include "vector2d.h"
 #include "aabbox.h"
@@ -32,6 +33,54 @@ using namespace dnr;
 namespace dnr {
 /*****************************************************************************/
 
+/**
+ * Power-basis form of a cubic bezier curve, evaluated with Horner's rule:
+ * 
+ * B(t) = ((a t + b) t + c) t + d
+**/
+struct cubic_coefficients {
+	vector2dd a;
+	vector2dd b;
+	vector2dd c;
+	vector2dd d;
+	
+	/**
+	 * Evaluate the polynomial at position t.
+	**/
+	vector2dd evaluate(f64 t) const {
+		return ((a * t + b) * t + c) * t + d;
+	}
+};
+
+/**
+ * Evaluate ((a t + b) t + c) t + d for every t, writing x and y separately.
+ * 
+ * @param	k		Coefficients to evaluate.
+ * @param	t		Positions to evaluate at.
+ * @param	count	Number of positions in t.
+ * @param	out_x	Receives the x-coordinates.
+ * @param	out_y	Receives the y-coordinates.
+**/
+void evaluate_horner(const cubic_coefficients& k, const f64 * t, size_t count, f64 * out_x, f64 * out_y);
+
+/**
+ * Split the control points of a cubic at t with de Casteljau's algorithm.
+ * left and right may not alias p.
+**/
+inline void split_points(const vector2dd * p, f64 t, vector2dd * left, vector2dd * right) {
+	const f64 rev_t = 1.0 - t;
+	
+	const vector2dd p01 = rev_t * p[0] + t * p[1];
+	const vector2dd p12 = rev_t * p[1] + t * p[2];
+	const vector2dd p23 = rev_t * p[2] + t * p[3];
+	const vector2dd p012 = rev_t * p01 + t * p12;
+	const vector2dd p123 = rev_t * p12 + t * p23;
+	const vector2dd mid = rev_t * p012 + t * p123;
+	
+	left[0] = p[0];		left[1] = p01;		left[2] = p012;		left[3] = mid;
+	right[0] = mid;		right[1] = p123;	right[2] = p23;		right[3] = p[3];
+}
+
 struct cubic_bezier {
 public:
 	vector2dd origin;
@@ -45,13 +94,57 @@ public:
 			: origin(-140.0, -140.0),
 			  control_1(-100.0, 150.0),
 			  control_2(0.0, -140.0),
-			  endpoint(150.0, 50.0) {
+			  endpoint(150.0, 50.0),
+			  m_version(next_version()) {
+	}
+	
+	cubic_bezier(const vector2dd& _origin, const vector2dd& _control_1, const vector2dd& _control_2, const vector2dd& _endpoint)
+			: origin(_origin),
+			  control_1(_control_1),
+			  control_2(_control_2),
+			  endpoint(_endpoint),
+			  m_version(next_version()) {
+	}
+	
+	/*************************************************************************/
+	// Versioning.
+	
+	/* Derived data such as curve_cache is keyed on a version stamp, which
+	 * changes when an anchor is moved through set() or touch().  Stamps are
+	 * drawn from a process-wide 64-bit counter rather than per curve, so
+	 * assigning one curve to another also invalidates anything cached for
+	 * the old geometry.  The counter is bumped atomically, curves may be
+	 * built on several threads.
+	**/
+	
+	/**
+	 * Get the version stamp of the control points.
+	**/
+	u64 version() const { return m_version; }
+	
+	/**
+	 * Mark the control points as changed.  set() does this automatically,
+	 * call it after assigning to origin, control_1, control_2 or endpoint
+	 * directly.
+	**/
+	void touch() { m_version = next_version(); }
+	
+	/**
+	 * Move the control point at idx, 0 is the origin and 3 the endpoint.
+	**/
+	void set(size_t idx, const vector2dd& pos) {
+		const_cast<vector2dd&>((*this)[idx]) = pos;
+		touch();
 	}
 	
 	/*************************************************************************/
 	// Helper operators.
 	
-	vector2dd& operator[](size_t idx) {
+	/**
+	 * Get the control point at idx.  There is no writable form, which would
+	 * leave version() stale, move points with set() instead.
+	**/
+	const vector2dd& operator[](size_t idx) const {
 		switch (idx) {
 			case 0:		return origin;
 			case 1:		return control_1;
@@ -88,47 +181,13 @@ public:
 		vector2dd b_coeff = 6.0 * ( origin + control_2 - 2.0 * control_1);
 		vector2dd c_coeff = 3.0 * (-origin + control_1);
 		
-		// Add the x extrema.
-		if (iszero(a_coeff.x)) {
-			if (!iszero(b_coeff.x)) {
-				f64 t = -c_coeff.x / b_coeff.x;
-				if (t >= 0.0 && t <= 1.0) box.add_internal_point(get_point(t));
-			}
-		} else {
-			// Solve using the quadratic formula.
-			quadratic_solution<f64> res = solve_quadratic(a_coeff.x, b_coeff.x, c_coeff.x);
-			
-			if (res.has_solution) {
-				if (res.solution[0] >= 0.0 && res.solution[0] <= 1.0) {
-					box.add_internal_point(get_point(res.solution[0]));
-				}
-				
-				if (res.solution[1] >= 0.0 && res.solution[1] <= 1.0) {
-					box.add_internal_point(get_point(res.solution[1]));
-				}
-			}
-		}
+		// Add the x and y extrema, the solver handles a degenerate a itself.
+		f64 roots[2];
+		u32 count = solve_quadratic_unit(a_coeff.x, b_coeff.x, c_coeff.x, roots);
+		for (u32 i = 0; i < count; ++i) box.add_internal_point(get_point(roots[i]));
 		
-		// Add the y extrema.
-		if (iszero(a_coeff.y)) {
-			if (!iszero(b_coeff.y)) {
-				f64 t = -c_coeff.y / b_coeff.y;
-				if (t >= 0.0 && t <= 1.0) box.add_internal_point(get_point(t));
-			}
-		} else {
-			// Solve using the quadratic formula.
-			quadratic_solution<f64> res = solve_quadratic(a_coeff.y, b_coeff.y, c_coeff.y);
-			
-			if (res.has_solution) {
-				if (res.solution[0] >= 0.0 && res.solution[0] <= 1.0) {
-					box.add_internal_point(get_point(res.solution[0]));
-				}
-				
-				if (res.solution[1] >= 0.0 && res.solution[1] <= 1.0) {
-					box.add_internal_point(get_point(res.solution[1]));
-				}
-			}
-		}
+		count = solve_quadratic_unit(a_coeff.y, b_coeff.y, c_coeff.y, roots);
+		for (u32 i = 0; i < count; ++i) box.add_internal_point(get_point(roots[i]));
 		
 		return box;
 	}
@@ -197,8 +256,175 @@ public:
 		
 		return 6.0 * (rev_t * p_2_1_0 + t * p_3_2_1);
 	}
+	
+	/**
+	 * Get the power-basis coefficients of the curve.
+	 * 
+	 * Expanding the Bernstein polynomial gives:
+	 * (-P_0 + 3 P_1 - 3 P_2 + P_3) t^3 + (3 P_0 - 6 P_1 + 3 P_2) t^2
+	 *     + 3(P_1 - P_0) t + P_0
+	**/
+	cubic_coefficients power_basis() const {
+		cubic_coefficients coeff;
+		coeff.a = -origin + 3.0 * control_1 - 3.0 * control_2 + endpoint;
+		coeff.b = 3.0 * origin - 6.0 * control_1 + 3.0 * control_2;
+		coeff.c = 3.0 * (control_1 - origin);
+		coeff.d = origin;
+		return coeff;
+	}
+	
+	/**
+	 * Get the coefficients of the first derivative, B'(t) = 3a t^2 + 2b t + c
+	 * in terms of power_basis(), with a leading zero.
+	**/
+	cubic_coefficients first_derivative() const {
+		const cubic_coefficients basis = power_basis();
+		
+		cubic_coefficients deriv;
+		deriv.a.set(0.0, 0.0);
+		deriv.b = 3.0 * basis.a;
+		deriv.c = 2.0 * basis.b;
+		deriv.d = basis.c;
+		return deriv;
+	}
+	
+	/**
+	 * Get the coefficients of the second derivative, B''(t) = 6a t + 2b in
+	 * terms of power_basis(), with two leading zeros.
+	**/
+	cubic_coefficients second_derivative() const {
+		const cubic_coefficients basis = power_basis();
+		
+		cubic_coefficients deriv;
+		deriv.a.set(0.0, 0.0);
+		deriv.b.set(0.0, 0.0);
+		deriv.c = 6.0 * basis.a;
+		deriv.d = 2.0 * basis.b;
+		return deriv;
+	}
+	
+	/*************************************************************************/
+	// Splitting.
+	
+	/**
+	 * Split the curve at position t into the parts before and after it.
+	 * 
+	 * @param	t		Position on curve, between 0.0 and 1.0.
+	 * @param	left	Receives the part from 0.0 to t.
+	 * @param	right	Receives the part from t to 1.0.
+	**/
+	void split(f64 t, cubic_bezier& left, cubic_bezier& right) const {
+		const vector2dd p[4] = { origin, control_1, control_2, endpoint };
+		vector2dd l[4], r[4];
+		split_points(p, t, l, r);
+		
+		left = cubic_bezier(l[0], l[1], l[2], l[3]);
+		right = cubic_bezier(r[0], r[1], r[2], r[3]);
+	}
+	
+	/**
+	 * Get the part of the curve between two positions.  The control points
+	 * are evaluated directly rather than by splitting twice, so a short
+	 * piece keeps full precision and t0 = 0.0 or t1 = 1.0 reproduce the
+	 * ends exactly.  If t0 > t1 the piece runs backwards.
+	 * 
+	 * @param	t0		Position of the start of the piece.
+	 * @param	t1		Position of the end of the piece.
+	**/
+	cubic_bezier subsegment(f64 t0, f64 t1) const;
+	
+	/**
+	 * Split the curve at many positions in one pass.  Each cut splits what
+	 * remains of the curve, so the de Casteljau points of one cut become the
+	 * control points of the next piece instead of being recomputed.
+	 * 
+	 * The pieces are written as a path with shared anchors, the same layout
+	 * as cubic_spline: piece i uses out[3i] through out[3i + 3].  Nothing is
+	 * allocated, so out can be a buffer reused between calls.
+	 * 
+	 * @param	t		Positions to cut at, sorted ascending.  Values are
+	 * 					clamped to [0, 1] and to the previous cut.
+	 * @param	count	Number of positions in t.
+	 * @param	out		Receives 3 * count + 4 control points.
+	 * @return	Number of pieces written, count + 1.
+	**/
+	size_t split_many(const f64 * t, size_t count, vector2dd * out) const;
+	
+	/*************************************************************************/
+	// Batch evaluation.
+	
+	/* These evaluate many positions at once and write the results into
+	 * separate x and y arrays, which lets the evaluation run several t values
+	 * per SSE2/AVX register.  Output arrays must hold count values each.
+	**/
+	
+	/**
+	 * Get the points at each position in t.
+	 * 
+	 * @param	t		Positions on curve, between 0.0 and 1.0.
+	 * @param	count	Number of positions in t.
+	 * @param	out_x	Receives the x-coordinates.
+	 * @param	out_y	Receives the y-coordinates.
+	**/
+	void get_points(const f64 * t, size_t count, f64 * out_x, f64 * out_y) const;
+	
+	/**
+	 * Get the tangent vectors at each position in t, see get_tangent().
+	**/
+	void get_tangents(const f64 * t, size_t count, f64 * out_x, f64 * out_y) const;
+	
+	/**
+	 * Get the normal vectors at each position in t, see get_normal().
+	**/
+	void get_normals(const f64 * t, size_t count, f64 * out_x, f64 * out_y) const;
+	
+	/**
+	 * Get steps + 1 points spaced uniformly in t from 0.0 to 1.0, using
+	 * forward differencing.  The last point is exactly the endpoint.
+	 * 
+	 * @param	steps	Number of intervals, must be at least 1.
+	 * @param	out_x	Receives steps + 1 x-coordinates.
+	 * @param	out_y	Receives steps + 1 y-coordinates.
+	**/
+	void get_points_uniform(size_t steps, f64 * out_x, f64 * out_y) const;
+	
+private:
+	u64 m_version;
+	
+	/// Source of version stamps, see version().
+	static u64 s_version_counter;
+	
+	/**
+	 * Draw a new version stamp.
+	**/
+	static u64 next_version();
 };
 
+/*****************************************************************************/
+// Batch bounds.
+
+/**
+ * Calculate the bounding boxes of many curves, giving the same result as
+ * calling cubic_bezier::bounds() on each.
+ * 
+ * The x and y extrema are solved together in one SSE2 register without
+ * branching: roots outside [0, 1], complex roots and the degenerate cases
+ * where the derivative is linear or constant all clamp to t = 0 or t = 1,
+ * which only re-adds an endpoint.
+ * 
+ * @param	curves	Curves to bound.
+ * @param	count	Number of curves.
+ * @param	out		Receives count bounding boxes.
+**/
+void bounds_batch(const cubic_bezier * curves, size_t count, aabboxd * out);
+
+/**
+ * Calculate the bounding boxes of curves stored as a strided point array,
+ * where curve i uses points[i * stride] through points[i * stride + 3].  A
+ * stride of 3 bounds the segments of a path with shared anchors.
+**/
+void bounds_batch(const vector2dd * points, size_t stride, size_t count, aabboxd * out);
+
 /*****************************************************************************/
 } // End of namespace dnr.
 
@@ -0,0 +1,115 @@
+/*
+ * cubic_spline.cpp
+ * Bezier
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+#include "cubic_spline.h"
+#include <algorithm>
+
+namespace dnr {
+/*****************************************************************************/
+
+void cubic_spline::append(const vector2dd& control_1, const vector2dd& control_2, const vector2dd& endpoint) {
+	if (m_points.empty()) throw std::logic_error("path has no start point");
+	
+	m_points.push_back(control_1);
+	m_points.push_back(control_2);
+	m_points.push_back(endpoint);
+}
+
+void cubic_spline::append(const cubic_bezier& curve) {
+	if (m_points.empty()) m_points.push_back(curve.origin);
+	append(curve.control_1, curve.control_2, curve.endpoint);
+}
+
+void cubic_spline::append_split(const cubic_bezier& curve, const f64 * t, size_t count) {
+	// split_many() writes the origin too, which replaces the current end of
+	// the path until it is restored.
+	const bool joined = !m_points.empty();
+	const vector2dd end = joined ? m_points.back() : curve.origin;
+	const size_t start_idx = joined ? m_points.size() - 1 : 0;
+	
+	m_points.resize(start_idx + 3 * (count + 1) + 1);
+	curve.split_many(t, count, &m_points[start_idx]);
+	m_points[start_idx] = end;
+}
+
+void cubic_spline::splice(size_t first, size_t count, const cubic_spline& other) {
+	if (first > size() || count > size() - first) throw std::out_of_range("invalid segment range");
+	
+	if (m_points.empty()) {
+		if (!other.empty()) m_points = other.m_points;
+		return;
+	}
+	
+	// Points strictly after the anchor at the start of the range, up to and
+	// including the anchor at the end of it.
+	std::vector<vector2dd>::iterator begin = m_points.begin() + 3 * first + 1;
+	std::vector<vector2dd>::iterator end = m_points.begin() + 3 * (first + count) + 1;
+	
+	if (other.empty()) {
+		m_points.erase(begin, end);
+		return;
+	}
+	
+	// Overwrite the shared anchor at the start, then swap in the rest.
+	const size_t start_idx = 3 * first;
+	m_points[start_idx] = other.m_points.front();
+	
+	const size_t removed = 3 * count;
+	const size_t inserted = other.m_points.size() - 1;
+	
+	if (inserted > removed) {
+		m_points.insert(end, inserted - removed, vector2dd());
+	} else if (inserted < removed) {
+		m_points.erase(begin + inserted, end);
+	}
+	
+	std::copy(other.m_points.begin() + 1, other.m_points.end(), m_points.begin() + start_idx + 1);
+}
+
+aabboxd cubic_spline::bounds() const {
+	aabboxd box;
+	
+	const size_t segments = size();
+	const vector2dd * p = points();
+	
+	for (size_t i = 0; i < segments; ++i, p += 3) {
+		aabboxd segment_box;
+		bounds_batch(p, 3, 1, &segment_box);
+		box.add_internal_box(segment_box);
+	}
+	
+	return box;
+}
+
+void cubic_spline::get_points_uniform(size_t steps, f64 * out_x, f64 * out_y) const {
+	const size_t segments = size();
+	
+	// Each segment overwrites the previous one's last point with its own
+	// origin, which is the same anchor.
+	for (size_t i = 0; i < segments; ++i) {
+		segment(i).get_points_uniform(steps, out_x + i * steps, out_y + i * steps);
+	}
+}
+
+/*****************************************************************************/
+} // End of namespace dnr.
@@ -0,0 +1,210 @@
+/*
+ * cubic_spline.h
+ * Bezier
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+#ifndef _CUBIC_SPLINE_H
+#define _CUBIC_SPLINE_H
+
+#include <vector>
+#include "cubic_bezier.h"
+
+namespace dnr {
+/*****************************************************************************/
+
+/**
+ * A path of joined cubic bezier segments.
+ * 
+ * All control points live in one contiguous array, and neighboring segments
+ * share their joining anchor.  Segment i uses points 3i through 3i + 3, so a
+ * path of n segments stores 3n + 1 points:
+ * 
+ * [origin_0, control_1_0, control_2_0, endpoint_0 = origin_1, control_1_1, ...]
+**/
+class cubic_spline {
+public:
+	cubic_spline() { }
+	
+	/**
+	 * Construct a path with no segments, starting at a point.
+	**/
+	explicit cubic_spline(const vector2dd& start) {
+		m_points.push_back(start);
+	}
+	
+	/*************************************************************************/
+	// Structure.
+	
+	/**
+	 * Get the number of segments.
+	**/
+	size_t size() const { return m_points.size() < 4 ? 0 : (m_points.size() - 1) / 3; }
+	
+	/**
+	 * Does the path have any segments?
+	**/
+	bool empty() const { return size() == 0; }
+	
+	/**
+	 * Get the number of control points, 3 * size() + 1 for a non-empty path.
+	**/
+	size_t point_count() const { return m_points.size(); }
+	
+	/**
+	 * Direct access to the contiguous control point array.
+	**/
+	const vector2dd * points() const { return m_points.empty() ? 0 : &m_points[0]; }
+	vector2dd * points() { return m_points.empty() ? 0 : &m_points[0]; }
+	
+	/**
+	 * Get a control point.  Moving an anchor shared by two segments moves
+	 * the end of one and the start of the other.
+	**/
+	const vector2dd& point(size_t idx) const { return m_points.at(idx); }
+	vector2dd& point(size_t idx) { return m_points.at(idx); }
+	
+	/**
+	 * Reserve space for a number of segments.
+	**/
+	void reserve(size_t segments) { m_points.reserve(3 * segments + 1); }
+	
+	/**
+	 * Remove all points and segments.
+	**/
+	void clear() { m_points.clear(); }
+	
+	/*************************************************************************/
+	// Segments.
+	
+	/**
+	 * Get a copy of a segment.
+	**/
+	cubic_bezier segment(size_t idx) const {
+		if (idx >= size()) throw std::out_of_range("invalid segment");
+		
+		const vector2dd * p = &m_points[3 * idx];
+		return cubic_bezier(p[0], p[1], p[2], p[3]);
+	}
+	
+	/**
+	 * Overwrite a segment.  Its origin and endpoint are shared with the
+	 * neighboring segments, which move along with it.
+	**/
+	void set_segment(size_t idx, const cubic_bezier& curve) {
+		if (idx >= size()) throw std::out_of_range("invalid segment");
+		
+		vector2dd * p = &m_points[3 * idx];
+		p[0] = curve.origin;
+		p[1] = curve.control_1;
+		p[2] = curve.control_2;
+		p[3] = curve.endpoint;
+	}
+	
+	/*************************************************************************/
+	// Editing.
+	
+	/**
+	 * Start the path over at a new point, removing all segments.
+	**/
+	void move_to(const vector2dd& start) {
+		m_points.clear();
+		m_points.push_back(start);
+	}
+	
+	/**
+	 * Append a segment starting at the current end of the path.
+	**/
+	void append(const vector2dd& control_1, const vector2dd& control_2, const vector2dd& endpoint);
+	
+	/**
+	 * Append a segment.  If the path is empty the segment's origin starts the
+	 * path, otherwise it is joined to the current end of the path.
+	**/
+	void append(const cubic_bezier& curve);
+	
+	/**
+	 * Append a segment cut into pieces at many positions, see
+	 * cubic_bezier::split_many().  The segment is joined like append(), and
+	 * no memory is allocated once the path has the capacity for it.
+	 * 
+	 * @param	curve	Segment to cut.
+	 * @param	t		Positions to cut at, sorted ascending.
+	 * @param	count	Number of positions in t.
+	**/
+	void append_split(const cubic_bezier& curve, const f64 * t, size_t count);
+	
+	/**
+	 * Replace segments [first, first + count) with the segments of another
+	 * path.  The anchors at either end of the replaced range are overwritten
+	 * by the start and end of other, so the result stays connected.  If
+	 * other has no segments the range is removed and its neighbors are
+	 * joined at the origin of segment first.
+	 * 
+	 * @param	first	First segment to replace.
+	 * @param	count	Number of segments to replace.
+	 * @param	other	Segments to insert.
+	**/
+	void splice(size_t first, size_t count, const cubic_spline& other);
+	
+	/*************************************************************************/
+	// Info querying.
+	
+	/**
+	 * Calculate the bounding box of the whole path.
+	**/
+	aabboxd bounds() const;
+	
+	/**
+	 * Calculate the bounding box of every segment.
+	 * 
+	 * @param	out		Receives size() bounding boxes.
+	**/
+	void segment_bounds(aabboxd * out) const {
+		bounds_batch(points(), 3, size(), out);
+	}
+	
+	/**
+	 * Get the points at each position in t on one segment, see
+	 * cubic_bezier::get_points().
+	**/
+	void get_points(size_t segment_idx, const f64 * t, size_t count, f64 * out_x, f64 * out_y) const {
+		segment(segment_idx).get_points(t, count, out_x, out_y);
+	}
+	
+	/**
+	 * Sample every segment at steps + 1 uniformly spaced positions.  Shared
+	 * anchors are only written once, so the output holds
+	 * size() * steps + 1 points.
+	 * 
+	 * @param	steps	Number of intervals per segment, must be at least 1.
+	 * @param	out_x	Receives the x-coordinates.
+	 * @param	out_y	Receives the y-coordinates.
+	**/
+	void get_points_uniform(size_t steps, f64 * out_x, f64 * out_y) const;
+	
+private:
+	std::vector<vector2dd> m_points;
+};
+
+/*****************************************************************************/
+} // End of namespace dnr.
+
+#endif // _CUBIC_SPLINE_H.
@@ -0,0 +1,63 @@
+/*
+ * curve_cache.cpp
+ * Bezier
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+
+#include "curve_cache.h"
+
+namespace dnr {
+/*****************************************************************************/
+
+void curve_cache::build_coefficients() const {
+	m_power_basis = m_curve->power_basis();
+	m_first_derivative = m_curve->first_derivative();
+	m_second_derivative = m_curve->second_derivative();
+	
+	m_valid |= k_coefficients;
+}
+
+/**
+ * Get the bounding box, see cubic_bezier::bounds().
+**/
+const aabboxd& curve_cache::bounds() const {
+	if (!is_valid(k_bounds)) {
+		m_bounds = m_curve->bounds();
+		m_valid |= k_bounds;
+	}
+	
+	return m_bounds;
+}
+
+/**
+ * Get the arc-length table, which is only built if requested.
+**/
+const arc_length_table& curve_cache::arc_length() const {
+	if (!is_valid(k_arc_length)) {
+		m_arc_length.build(*m_curve);
+		m_valid |= k_arc_length;
+	}
+	
+	return m_arc_length;
+}
+
+/*****************************************************************************/
+} // End of namespace dnr.
@@ -0,0 +1,170 @@
+/*
+ * curve_cache.h
+ * Bezier
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+
+#ifndef _CURVE_CACHE_H
+#define _CURVE_CACHE_H
+
+#include "cubic_bezier.h"
+#include "arc_length.h"
+
+namespace dnr {
+/*****************************************************************************/
+
+/**
+ * Derived data of a cubic bezier curve, computed on first use and kept until
+ * the curve changes.
+ * 
+ * The cache refers to a curve it does not own and compares the curve's
+ * version() on every query, so moving an anchor through set() or touch()
+ * invalidates everything at once.  Queries on an unchanged curve only read
+ * the stored results.  Queries are const and fill in the cached data
+ * lazily, so a cache must not be shared between threads.
+**/
+class curve_cache {
+public:
+	explicit curve_cache(const cubic_bezier& curve)
+			: m_curve(&curve)
+			, m_version(curve.version())
+			, m_valid(0) {
+	}
+	
+	/**
+	 * Get the curve being cached.
+	**/
+	const cubic_bezier& curve() const { return *m_curve; }
+	
+	/**
+	 * Discard everything cached, even if the curve has not changed.
+	**/
+	void invalidate() { m_valid = 0; }
+	
+	/*************************************************************************/
+	// Cached data.
+	
+	/**
+	 * Get the power-basis coefficients, see cubic_bezier::power_basis().
+	**/
+	const cubic_coefficients& power_basis() const {
+		update_coefficients();
+		return m_power_basis;
+	}
+	
+	/**
+	 * Get the first derivative, see cubic_bezier::first_derivative().
+	**/
+	const cubic_coefficients& first_derivative() const {
+		update_coefficients();
+		return m_first_derivative;
+	}
+	
+	/**
+	 * Get the second derivative, see cubic_bezier::second_derivative().
+	**/
+	const cubic_coefficients& second_derivative() const {
+		update_coefficients();
+		return m_second_derivative;
+	}
+	
+	/**
+	 * Get the bounding box, see cubic_bezier::bounds().
+	**/
+	const aabboxd& bounds() const;
+	
+	/**
+	 * Get the arc-length table, which is only built if requested.
+	**/
+	const arc_length_table& arc_length() const;
+	
+	/*************************************************************************/
+	// Evaluation.
+	
+	/* These match the cubic_bezier functions of the same name, but evaluate
+	 * the cached coefficients with Horner's rule instead of rebuilding them.
+	**/
+	
+	vector2dd get_point(f64 t) const { return power_basis().evaluate(t); }
+	vector2dd get_tangent(f64 t) const { return first_derivative().evaluate(t); }
+	vector2dd get_normal(f64 t) const { return second_derivative().evaluate(t); }
+	
+	void get_points(const f64 * t, size_t count, f64 * out_x, f64 * out_y) const {
+		evaluate_horner(power_basis(), t, count, out_x, out_y);
+	}
+	
+	void get_tangents(const f64 * t, size_t count, f64 * out_x, f64 * out_y) const {
+		evaluate_horner(first_derivative(), t, count, out_x, out_y);
+	}
+	
+	void get_normals(const f64 * t, size_t count, f64 * out_x, f64 * out_y) const {
+		evaluate_horner(second_derivative(), t, count, out_x, out_y);
+	}
+	
+private:
+	/// Flags for m_valid.
+	enum {
+		k_coefficients	= 1 << 0,	///< m_power_basis and both derivatives.
+		k_bounds		= 1 << 1,	///< m_bounds.
+		k_arc_length	= 1 << 2	///< m_arc_length.
+	};
+	
+	const cubic_bezier * m_curve;
+	mutable u64 m_version; // Version of m_curve the cached data belongs to.
+	mutable u32 m_valid; // Which of the cached data is up to date.
+	
+	mutable cubic_coefficients m_power_basis;
+	mutable cubic_coefficients m_first_derivative;
+	mutable cubic_coefficients m_second_derivative;
+	mutable aabboxd m_bounds;
+	mutable arc_length_table m_arc_length;
+	
+	/**
+	 * Discard the cached data if the curve has changed since it was built,
+	 * and check whether the data for flag is still valid.
+	**/
+	bool is_valid(u32 flag) const {
+		if (m_version != m_curve->version()) {
+			m_version = m_curve->version();
+			m_valid = 0;
+		}
+		
+		return (m_valid & flag) != 0;
+	}
+	
+	/**
+	 * Rebuild the coefficients if necessary.
+	**/
+	void update_coefficients() const {
+		if (!is_valid(k_coefficients)) build_coefficients();
+	}
+	
+	void build_coefficients() const;
+	
+	// Not copyable, the copy would still refer to the original curve.
+	curve_cache(const curve_cache&);
+	curve_cache& operator=(const curve_cache&);
+};
+
+/*****************************************************************************/
+} // End of namespace dnr.
+
+#endif // _CURVE_CACHE_H.
@@ -0,0 +1,424 @@
+/*
+ * curve_projection.cpp
+ * Bezier
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+#include "curve_projection.h"
+#include "bernstein.h"
+#include <limits>
+
+namespace dnr {
+/*****************************************************************************/
+
+/**
+ * Width in t to find the stationary points of the distance to.  The
+ * distance is flat there, so its error is roughly the square of this.
+**/
+static const f64 k_root_tolerance = 1.0e-9;
+
+/// Subdivision depth limit, far below where intervals reach the tolerance.
+static const u32 k_max_depth = 48;
+
+/// The batch projection splits the curve into 2^k_table_depth intervals.
+static const u32 k_table_depth = 4;
+static const u32 k_table_size = 1 << k_table_depth;
+
+/// Newton steps the batch projection takes from the nearest sample.
+static const u32 k_newton_steps = 5;
+
+/**
+ * Largest last Newton step for a point to count as converged.  Convergence
+ * is quadratic, so the point is then far closer than k_root_tolerance.
+**/
+static const f64 k_newton_tolerance = 1.0e-7;
+
+/// Points the batch projection works on at once.
+static const size_t k_batch_lanes = 8;
+
+/**
+ * Weights for the product of a cubic and a quadratic in Bernstein form:
+ * C(3, i) C(2, j) / C(5, i + j).
+**/
+static const f64 k_product_weights[4][3] = {
+	{ 1.0, 0.4, 0.1 },
+	{ 0.6, 0.6, 0.3 },
+	{ 0.3, 0.6, 0.6 },
+	{ 0.1, 0.4, 1.0 }
+};
+
+/**
+ * Find the parts of the Bernstein coefficients of f(t) that only depend on
+ * the curve, so that coefficient k is offset[k] - P . weight[k].
+ * 
+ * @param	p	Control points of the curve.
+**/
+static void distance_coefficients(const vector2dd * p, f64 * offset, vector2dd * weight) {
+	// Control points of the derivative, a quadratic.
+	const vector2dd d[3] = { 3.0 * (p[1] - p[0]), 3.0 * (p[2] - p[1]), 3.0 * (p[3] - p[2]) };
+	
+	for (u32 k = 0; k < 6; ++k) {
+		offset[k] = 0.0;
+		weight[k].set(0.0, 0.0);
+	}
+	
+	// (p_i - P) . d_j = p_i . d_j - P . d_j, summed into coefficient i + j.
+	for (u32 i = 0; i < 4; ++i) {
+		for (u32 j = 0; j < 3; ++j) {
+			const f64 w = k_product_weights[i][j];
+			offset[i + j] += w * p[i].dot_product(d[j]);
+			weight[i + j] += w * d[j];
+		}
+	}
+}
+
+curve_projector::curve_projector(const cubic_bezier& curve)
+		: m_basis(curve.power_basis()) {
+	m_points[0] = curve.origin;
+	m_points[1] = curve.control_1;
+	m_points[2] = curve.control_2;
+	m_points[3] = curve.endpoint;
+	
+	distance_coefficients(m_points, m_offset, m_weight);
+}
+
+/**
+ * State for the recursive search for the nearest point.
+**/
+struct projection_search {
+	const cubic_coefficients * basis;
+	vector2dd pt;
+	
+	const f64 * coeff;	// Bernstein coefficients of f(t) over [0, 1].
+	f64 power[6];		// Power basis of f(t), built on first use.
+	bool has_power;
+	
+	f64 best_t;
+	f64 best_sq;
+	
+	/**
+	 * Try a position on the curve as the nearest point.
+	**/
+	void test(f64 t) {
+		const cubic_coefficients& k = *basis;
+		const f64 distance_sq = (((k.a * t + k.b) * t + k.c) * t + k.d).distance_sq(pt);
+		
+		if (distance_sq < best_sq) {
+			best_t = t;
+			best_sq = distance_sq;
+		}
+	}
+};
+
+/**
+ * Get the square distance from the origin to the bounding box of four
+ * points, a lower bound on the distance to the curve they control.
+**/
+static inline f64 hull_distance_sq(const vector2dd * q) {
+	const f64 min_x = min_(min_(q[0].x, q[1].x), min_(q[2].x, q[3].x));
+	const f64 max_x = max_(max_(q[0].x, q[1].x), max_(q[2].x, q[3].x));
+	const f64 min_y = min_(min_(q[0].y, q[1].y), min_(q[2].y, q[3].y));
+	const f64 max_y = max_(max_(q[0].y, q[1].y), max_(q[2].y, q[3].y));
+	
+	const f64 dx = max_(max_(min_x, -max_x), 0.0);
+	const f64 dy = max_(max_(min_y, -max_y), 0.0);
+	return dx * dx + dy * dy;
+}
+
+/**
+ * Split the control points of a cubic at t = 0.5.
+**/
+static inline void split_half(const vector2dd * q, vector2dd * left, vector2dd * right) {
+	const vector2dd q01 = 0.5 * (q[0] + q[1]);
+	const vector2dd q12 = 0.5 * (q[1] + q[2]);
+	const vector2dd q23 = 0.5 * (q[2] + q[3]);
+	const vector2dd q012 = 0.5 * (q01 + q12);
+	const vector2dd q123 = 0.5 * (q12 + q23);
+	const vector2dd mid = 0.5 * (q012 + q123);
+	
+	left[0] = q[0];		left[1] = q01;		left[2] = q012;		left[3] = mid;
+	right[0] = mid;		right[1] = q123;	right[2] = q23;		right[3] = q[3];
+}
+
+/**
+ * Search [lo, hi] for a point nearer than the best so far.
+ * 
+ * @param	f		Bernstein coefficients of f(t) over the interval.
+ * @param	q		Control points of the curve over the interval, relative to
+ * 					the query point.
+**/
+static void search_interval(const f64 * f, const vector2dd * q, f64 lo, f64 hi, projection_search& search, u32 depth) {
+	// Nothing in this part of the curve can beat the best so far.
+	if (hull_distance_sq(q) >= search.best_sq) return;
+	
+	const u32 changes = bernstein_sign_changes(f, 5);
+	if (changes == 0) return;
+	
+	// A single root.  The distance is at a minimum only where f(t), half its
+	// derivative, crosses zero from below.
+	if (changes == 1 && f[0] != 0.0 && f[5] != 0.0) {
+		if (f[0] > 0.0) return;
+		
+		if (!search.has_power) {
+			search.has_power = true;
+			bernstein_to_power(search.coeff, 5, search.power);
+		}
+		
+		search.test(polish_bracketed_root(search.power, 5, lo, hi, f[0], f[5], k_root_tolerance));
+		return;
+	}
+	
+	const f64 mid = 0.5 * (lo + hi);
+	
+	if (hi - lo <= k_root_tolerance || depth >= k_max_depth) {
+		search.test(mid);
+		return;
+	}
+	
+	f64 f_left[6], f_right[6];
+	bernstein_split_half(f, 5, f_left, f_right);
+	
+	vector2dd q_left[4], q_right[4];
+	split_half(q, q_left, q_right);
+	
+	if (f_left[5] == 0.0) search.test(mid);
+	
+	// Visit the nearer half first so that the other is more likely pruned.
+	if (hull_distance_sq(q_left) <= hull_distance_sq(q_right)) {
+		search_interval(f_left, q_left, lo, mid, search, depth + 1);
+		search_interval(f_right, q_right, mid, hi, search, depth + 1);
+	} else {
+		search_interval(f_right, q_right, mid, hi, search, depth + 1);
+		search_interval(f_left, q_left, lo, mid, search, depth + 1);
+	}
+}
+
+curve_projection curve_projector::project(const vector2dd& pt) const {
+	f64 coeff[6];
+	for (u32 k = 0; k < 6; ++k) {
+		coeff[k] = m_offset[k] - pt.dot_product(m_weight[k]);
+	}
+	
+	projection_search search;
+	search.basis = &m_basis;
+	search.pt = pt;
+	search.coeff = coeff;
+	search.has_power = false;
+	
+	// The ends of the curve are always candidates.
+	search.best_t = 0.0;
+	search.best_sq = m_points[0].distance_sq(pt);
+	search.test(1.0);
+	
+	const vector2dd q[4] = { m_points[0] - pt, m_points[1] - pt, m_points[2] - pt, m_points[3] - pt };
+	search_interval(coeff, q, 0.0, 1.0, search, 0);
+	
+	curve_projection res;
+	res.t = search.best_t;
+	res.point = ((m_basis.a * res.t + m_basis.b) * res.t + m_basis.c) * res.t + m_basis.d;
+	res.distance_sq = search.best_sq;
+	return res;
+}
+
+/**
+ * The curve cut into k_table_size equal intervals in t, for the batch
+ * projection.  Sample i is the curve at t = i / k_table_size, and interval i
+ * runs from sample i to sample i + 1.
+**/
+struct projection_table {
+	vector2dd samples[k_table_size + 1];
+	
+	// Bounding box of the control points of each interval.
+	vector2dd box_min[k_table_size];
+	vector2dd box_max[k_table_size];
+	
+	// Bernstein coefficients of f(t) over each interval, as in
+	// curve_projector.
+	f64 offset[k_table_size][6];
+	vector2dd weight[k_table_size][6];
+	
+	explicit projection_table(const vector2dd * p) {
+		vector2dd pieces[2][4 * k_table_size];
+		for (u32 i = 0; i < 4; ++i) pieces[0][i] = p[i];
+		
+		for (u32 level = 0; level < k_table_depth; ++level) {
+			const vector2dd * from = pieces[level & 1];
+			vector2dd * to = pieces[(level + 1) & 1];
+			
+			for (u32 i = 0; i < (1u << level); ++i) {
+				split_half(&from[4 * i], &to[8 * i], &to[8 * i + 4]);
+			}
+		}
+		
+		const vector2dd * piece = pieces[k_table_depth & 1];
+		for (u32 i = 0; i < k_table_size; ++i, piece += 4) {
+			samples[i] = piece[0];
+			
+			box_min[i].set(min_(min_(piece[0].x, piece[1].x), min_(piece[2].x, piece[3].x)),
+						   min_(min_(piece[0].y, piece[1].y), min_(piece[2].y, piece[3].y)));
+			box_max[i].set(max_(max_(piece[0].x, piece[1].x), max_(piece[2].x, piece[3].x)),
+						   max_(max_(piece[0].y, piece[1].y), max_(piece[2].y, piece[3].y)));
+			
+			distance_coefficients(piece, offset[i], weight[i]);
+		}
+		
+		samples[k_table_size] = p[3];
+	}
+	
+	/**
+	 * Check that nothing on the curve is nearer a point than a candidate.
+	 * 
+	 * Every sample is at least as far as the candidate.  An interval can
+	 * only hold a nearer point if its box is no further than the candidate
+	 * and f(t) changes sign across it, since otherwise the distance only
+	 * grows or only shrinks across it and its nearest point is a sample.  The
+	 * interval holding the candidate may have one sign change, when the
+	 * candidate is the root.
+	 * 
+	 * @param	distance_sq	Square distance to the candidate.
+	 * @param	t			Position of the candidate.
+	 * @param	stationary	Is the candidate a converged root of f(t) rather
+	 * 						than a sample?
+	**/
+	bool nearest(const vector2dd& pt, f64 distance_sq, f64 t, bool stationary) const {
+		for (u32 i = 0; i < k_table_size; ++i) {
+			const f64 dx = max_(max_(box_min[i].x - pt.x, pt.x - box_max[i].x), 0.0);
+			const f64 dy = max_(max_(box_min[i].y - pt.y, pt.y - box_max[i].y), 0.0);
+			if (dx * dx + dy * dy > distance_sq) continue;
+			
+			f64 coeff[6];
+			for (u32 k = 0; k < 6; ++k) {
+				coeff[k] = offset[i][k] - pt.dot_product(weight[i][k]);
+			}
+			
+			// Count zeros as sign changes too, which can only send more points
+			// to the full search.
+			u32 changes = 0;
+			for (u32 k = 1; k < 6; ++k) changes += u32(coeff[k - 1] * coeff[k] <= 0.0);
+			if (changes == 0) continue;
+			
+			const f64 lo = f64(i) / k_table_size;
+			const f64 hi = f64(i + 1) / k_table_size;
+			if (changes == 1 && coeff[0] != 0.0 && coeff[5] != 0.0 && stationary && t >= lo && t <= hi) continue;
+			
+			return false;
+		}
+		
+		return true;
+	}
+};
+
+void curve_projector::project(const vector2dd * pts, size_t count, f64 * out_t, f64 * out_distance_sq) const {
+	/* Points are projected k_batch_lanes at a time, one step for all of them
+	 * before the next so that each loop runs without branches: find the
+	 * nearest sample, take a fixed number of Newton steps on f(t) from it,
+	 * then keep whichever is nearer.  Points the table cannot vouch for, see
+	 * projection_table::nearest(), get the full search instead.
+	**/
+	const projection_table table(m_points);
+	const cubic_coefficients& k = m_basis;
+	
+	for (size_t first = 0; first < count; first += k_batch_lanes) {
+		const size_t lanes = min_(count - first, k_batch_lanes);
+		
+		f64 px[k_batch_lanes], py[k_batch_lanes];
+		f64 sample_sq[k_batch_lanes], t[k_batch_lanes], last_step[k_batch_lanes];
+		u32 sample[k_batch_lanes];
+		
+		// Fill unused lanes with the first point.
+		for (size_t l = 0; l < k_batch_lanes; ++l) {
+			const vector2dd& pt = pts[first + (l < lanes ? l : 0)];
+			px[l] = pt.x;
+			py[l] = pt.y;
+			sample_sq[l] = table.samples[0].distance_sq(pt);
+			sample[l] = 0;
+		}
+		
+		// The nearest sample is tracked by index, which compilers select
+		// without a branch where they would branch on a floating point t.
+		for (u32 i = 1; i <= k_table_size; ++i) {
+			const f64 sx = table.samples[i].x, sy = table.samples[i].y;
+			
+			for (size_t l = 0; l < k_batch_lanes; ++l) {
+				const f64 dx = sx - px[l], dy = sy - py[l];
+				const f64 distance_sq = dx * dx + dy * dy;
+				const u32 nearer = u32(distance_sq < sample_sq[l]);
+				
+				sample[l] += nearer * (i - sample[l]);
+				sample_sq[l] = min_(distance_sq, sample_sq[l]);
+			}
+		}
+		
+		for (size_t l = 0; l < k_batch_lanes; ++l) t[l] = f64(sample[l]) / k_table_size;
+		
+		// Newton's method on f(t) = (B(t) - P) . B'(t), with
+		// f'(t) = B'(t) . B'(t) + (B(t) - P) . B''(t).  Near a maximum of the
+		// distance f'(t) falls to zero or below, so it is kept to at least a
+		// quarter of B'(t) . B'(t) and the step only gets shorter.
+		for (u32 step = 0; step < k_newton_steps; ++step) {
+			for (size_t l = 0; l < k_batch_lanes; ++l) {
+				const f64 u = t[l];
+				const f64 bx = ((k.a.x * u + k.b.x) * u + k.c.x) * u + k.d.x - px[l];
+				const f64 by = ((k.a.y * u + k.b.y) * u + k.c.y) * u + k.d.y - py[l];
+				const f64 dx = (3.0 * k.a.x * u + 2.0 * k.b.x) * u + k.c.x;
+				const f64 dy = (3.0 * k.a.y * u + 2.0 * k.b.y) * u + k.c.y;
+				const f64 ddx = 6.0 * k.a.x * u + 2.0 * k.b.x;
+				const f64 ddy = 6.0 * k.a.y * u + 2.0 * k.b.y;
+				
+				const f64 f = bx * dx + by * dy;
+				const f64 speed_sq = dx * dx + dy * dy;
+				const f64 slope = max_(speed_sq + bx * ddx + by * ddy, 0.25 * speed_sq + std::numeric_limits<f64>::min());
+				const f64 delta = f / slope;
+				
+				last_step[l] = abs_(delta);
+				t[l] = clamp(u - delta, 0.0, 1.0);
+			}
+		}
+		
+		for (size_t l = 0; l < lanes; ++l) {
+			const vector2dd pt(px[l], py[l]);
+			const f64 u = t[l];
+			
+			// Keep the nearer of the Newton point and the sample.
+			f64 best_t = u;
+			f64 best_sq = k.evaluate(u).distance_sq(pt);
+			bool stationary = last_step[l] < k_newton_tolerance;
+			
+			if (sample_sq[l] < best_sq) {
+				best_t = f64(sample[l]) / k_table_size;
+				best_sq = sample_sq[l];
+				stationary = false;
+			}
+			
+			if (table.nearest(pt, best_sq, best_t, stationary)) {
+				out_t[first + l] = best_t;
+				if (out_distance_sq) out_distance_sq[first + l] = best_sq;
+			} else {
+				const curve_projection res = project(pt);
+				
+				out_t[first + l] = res.t;
+				if (out_distance_sq) out_distance_sq[first + l] = res.distance_sq;
+			}
+		}
+	}
+}
+
+/*****************************************************************************/
+} // End of namespace dnr.
@@ -0,0 +1,104 @@
+/*
+ * curve_projection.h
+ * Bezier
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+#ifndef _CURVE_PROJECTION_H
+#define _CURVE_PROJECTION_H
+
+#include "cubic_bezier.h"
+
+namespace dnr {
+/*****************************************************************************/
+
+/**
+ * Result of projecting a point onto a curve.
+**/
+struct curve_projection {
+	f64 t;				/// Position of the nearest point on the curve.
+	vector2dd point;	/// The nearest point on the curve.
+	f64 distance_sq;	/// Square of the distance to the nearest point.
+};
+
+/**
+ * Finds the nearest point on a cubic bezier curve to query points.
+ * 
+ * The nearest point is either an end of the curve or a root of
+ * 
+ * f(t) = (B(t) - P) . B'(t),
+ * 
+ * a quintic.  Its Bernstein coefficients are linear in P, so the parts that
+ * only depend on the curve are computed once in the constructor, leaving
+ * six dot products per query.
+ * 
+ * The roots are isolated by subdividing f(t) and the curve together.  An
+ * interval is dropped when the bounding box of its control points is
+ * further away than the best point so far.  A single root where f(t) falls
+ * is a local maximum of the distance and is skipped, the rest are polished
+ * with Newton's method.
+**/
+class curve_projector {
+public:
+	explicit curve_projector(const cubic_bezier& curve);
+	
+	/**
+	 * Project one point onto the curve.
+	**/
+	curve_projection project(const vector2dd& pt) const;
+	
+	/**
+	 * Project many points onto the curve, finding the same nearest points as
+	 * project(pt).
+	 * 
+	 * The curve is cut into a table of short intervals once per call.  Each
+	 * point takes a fixed number of Newton steps from its nearest sample,
+	 * and the table then checks that no other interval can hold a nearer
+	 * point.  The few points it cannot vouch for, mostly those nearly as far
+	 * from two parts of the curve, get the full search.
+	 * 
+	 * @param	pts				Points to project.
+	 * @param	count			Number of points.
+	 * @param	out_t			Receives the position of each nearest point.
+	 * @param	out_distance_sq	Receives the square distance to each nearest
+	 * 							point, may be null.
+	**/
+	void project(const vector2dd * pts, size_t count, f64 * out_t, f64 * out_distance_sq) const;
+	
+private:
+	vector2dd m_points[4];
+	cubic_coefficients m_basis;
+	
+	// Bernstein coefficient k of f(t) is m_offset[k] - P . m_weight[k].
+	f64 m_offset[6];
+	vector2dd m_weight[6];
+};
+
+/**
+ * Project a point onto a curve, see curve_projector.
+**/
+inline curve_projection project(const cubic_bezier& curve, const vector2dd& pt) {
+	return curve_projector(curve).project(pt);
+}
+
+/*****************************************************************************/
+} // End of namespace dnr.
+
+#endif // _CURVE_PROJECTION_H.
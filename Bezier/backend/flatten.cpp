@@ -0,0 +1,109 @@
+/*
+ * flatten.cpp
+ * Bezier
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+
+#include "flatten.h"
+#include <cfloat>
+
+namespace dnr {
+/*****************************************************************************/
+
+u32 flatten_segment_count(const cubic_bezier& curve, f64 tolerance) {
+	const vector2dd dd_1 = curve.origin - 2.0 * curve.control_1 + curve.control_2;
+	const vector2dd dd_2 = curve.control_1 - 2.0 * curve.control_2 + curve.endpoint;
+	
+	const f64 m_sq = max_(dd_1.length_sq(), dd_2.length_sq());
+	
+	// Written so that a NaN fails the tests, and is not cast to u32 below.
+	if (iszero(m_sq) || !(m_sq <= DBL_MAX) || !(tolerance > 0.0)) return 1;
+	
+	const f64 n = ceil(sqrt(0.75 * sqrt(m_sq) / tolerance));
+	if (n < 1.0) return 1;
+	return n < f64(k_max_segments) ? u32(n) : k_max_segments;
+}
+
+void flatten(const cubic_bezier& curve, u32 segments, vector2dd * out) {
+	const cubic_coefficients coeff = curve.power_basis();
+	
+	/* Forward differences of a t^3 + b t^2 + c t + d with a step of h.  The
+	 * third difference is constant, so each point costs three additions.
+	**/
+	const f64 h = 1.0 / segments;
+	const f64 h_2 = h * h;
+	const f64 h_3 = h_2 * h;
+	
+	const vector2dd d_3 = 6.0 * h_3 * coeff.a;
+	vector2dd d_2 = d_3 + 2.0 * h_2 * coeff.b;
+	vector2dd d_1 = h_3 * coeff.a + h_2 * coeff.b + h * coeff.c;
+	vector2dd pt = coeff.d;
+	
+	out[0] = curve.origin;
+	for (u32 i = 1; i < segments; ++i) {
+		pt += d_1;
+		d_1 += d_2;
+		d_2 += d_3;
+		
+		out[i] = pt;
+	}
+	
+	out[segments] = curve.endpoint;
+}
+
+size_t flatten(const cubic_bezier& curve, f64 tolerance, std::vector<vector2dd>& out) {
+	const u32 segments = flatten_segment_count(curve, tolerance);
+	const size_t first = out.size();
+	
+	out.resize(first + segments + 1);
+	flatten(curve, segments, &out[first]);
+	
+	return segments + 1;
+}
+
+size_t flatten(const cubic_spline& spline, f64 tolerance, std::vector<vector2dd>& out) {
+	const size_t count = spline.size();
+	if (count == 0) return 0;
+	
+	// Size the output for the whole path first.
+	std::vector<u32> segments(count);
+	size_t total = 1;
+	
+	for (size_t i = 0; i < count; ++i) {
+		segments[i] = flatten_segment_count(spline.segment(i), tolerance);
+		total += segments[i];
+	}
+	
+	const size_t first = out.size();
+	out.resize(first + total);
+	
+	// Each segment starts on the last point of the one before.
+	vector2dd * dest = &out[first];
+	for (size_t i = 0; i < count; ++i) {
+		flatten(spline.segment(i), segments[i], dest);
+		dest += segments[i];
+	}
+	
+	return total;
+}
+
+/*****************************************************************************/
+} // End of namespace dnr.
@@ -0,0 +1,87 @@
+/*
+ * flatten.h
+ * Bezier
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+
+#ifndef _FLATTEN_H
+#define _FLATTEN_H
+
+#include <vector>
+#include "cubic_spline.h"
+
+namespace dnr {
+/*****************************************************************************/
+
+/// Most segments flatten_segment_count() asks for, so that a tiny tolerance
+/// or a huge curve cannot ask for an unbounded buffer.
+CONSTEXPR_VAR u32 k_max_segments = 1 << 16;
+
+/**
+ * Get the number of line segments needed to flatten a curve so that the
+ * polyline through evenly spaced points is within tolerance of the curve.
+ * 
+ * From Wang's formula, n = ceil(sqrt(3 * 2 / 8 * M / tolerance)), where M is
+ * the larger of the second differences |P_0 - 2 P_1 + P_2| and
+ * |P_1 - 2 P_2 + P_3|.  The bound only depends on the control points, so
+ * the count is known before any point is evaluated.
+ * 
+ * @param	curve		Curve to flatten.
+ * @param	tolerance	Maximum distance between the curve and the polyline,
+ * 						greater than zero.
+ * @return	Number of segments, from 1 to k_max_segments.  A tolerance that
+ * 			is not a positive number, or a curve with points that are not
+ * 			finite, gives 1.
+**/
+u32 flatten_segment_count(const cubic_bezier& curve, f64 tolerance);
+
+/**
+ * Write the points of a polyline approximating a curve, evenly spaced in t.
+ * The first and last points are the ends of the curve exactly.
+ * 
+ * @param	curve		Curve to flatten.
+ * @param	segments	Number of line segments, at least 1.
+ * @param	out			Receives segments + 1 points.
+**/
+void flatten(const cubic_bezier& curve, u32 segments, vector2dd * out);
+
+/**
+ * Flatten a curve to within tolerance, see flatten_segment_count().
+ * 
+ * @param	out		The points are appended to this, which is grown once.
+ * @return	Number of points appended.
+**/
+size_t flatten(const cubic_bezier& curve, f64 tolerance, std::vector<vector2dd>& out);
+
+/**
+ * Flatten every segment of a path to within tolerance.  Joins between
+ * segments are written once, so the polyline for a path of n segments
+ * flattened into m_i pieces each holds sum(m_i) + 1 points.
+ * 
+ * @param	out		The points are appended to this, which is grown once.
+ * @return	Number of points appended.
+**/
+size_t flatten(const cubic_spline& spline, f64 tolerance, std::vector<vector2dd>& out);
+
+/*****************************************************************************/
+} // End of namespace dnr.
+
+#endif // _FLATTEN_H.
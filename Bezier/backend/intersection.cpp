@@ -0,0 +1,446 @@
+/*
+ * intersection.cpp
+ * Bezier
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+
+#include <algorithm>
+#include <limits>
+#include "intersection.h"
+#include "bernstein.h"
+
+namespace dnr {
+/*****************************************************************************/
+
+/// Give up on a pair of curves after this many clipping steps.
+static const u32 k_max_clip_steps = 4096;
+
+/// Split the longer curve when a clip keeps more than this much of a curve.
+static const f64 k_min_clip_progress = 0.8;
+
+/**
+ * Intersections closer than this many tolerances in both t are merged, which
+ * catches the clusters that tangent intersections produce.
+**/
+static const f64 k_merge_distance = 1000.0;
+
+/**
+ * State for finding the intersections between one pair of curves.
+**/
+struct clip_search {
+	const cubic_bezier * curve_a;
+	f64 tolerance;
+	u32 steps;
+	
+	std::vector<curve_intersection> * out;
+	size_t first; // Index of the first result for this pair in out.
+	
+	/**
+	 * Add an intersection, unless one was already found at the same place.
+	**/
+	void add(f64 t_a, f64 t_b) {
+		const f64 merge = k_merge_distance * tolerance;
+		
+		for (size_t i = first; i < out->size(); ++i) {
+			const curve_intersection& other = (*out)[i];
+			if (abs_(other.t_a - t_a) <= merge && abs_(other.t_b - t_b) <= merge) return;
+		}
+		
+		curve_intersection res;
+		res.t_a = t_a;
+		res.t_b = t_b;
+		res.point = curve_a->get_point(t_a);
+		out->push_back(res);
+	}
+};
+
+/**
+ * Get the bounding box of four control points, which contains the curve.
+**/
+static inline aabboxd hull_bounds(const vector2dd * p) {
+	aabboxd box;
+	box.reset(p[0]);
+	box.add_internal_point(p[1]);
+	box.add_internal_point(p[2]);
+	box.add_internal_point(p[3]);
+	return box;
+}
+
+/**
+ * Get the control points of the part of a cubic between lo and hi.
+**/
+static inline void extract_points(const vector2dd * p, f64 lo, f64 hi, vector2dd * out) {
+	vector2dd left[4], right[4];
+	split_points(p, hi, left, right);
+	
+	if (hi > 0.0) split_points(left, lo / hi, right, out);
+	else for (u32 i = 0; i < 4; ++i) out[i] = left[0];
+}
+
+/**
+ * Clip curve a to the part that may lie within the fat line of curve b, the
+ * band between two lines parallel to b's chord that contains b.
+ * 
+ * @param	lo, hi	Receive the range of t in a to keep.
+ * @return	false if none of a is within the fat line.
+**/
+static bool fat_line_clip(const vector2dd * a, const vector2dd * b, f64& lo, f64& hi) {
+	// Pick the line through the ends of b, or through its first control point
+	// if the ends meet.
+	vector2dd dir = b[3] - b[0];
+	bool through_ends = true;
+	
+	if (iszero(dir.length_sq())) {
+		through_ends = false;
+		dir = (b[1] - b[0]).length_sq() > (b[2] - b[0]).length_sq() ? b[1] - b[0] : b[2] - b[0];
+		
+		if (iszero(dir.length_sq())) {
+			// b is a point, no line to clip against.
+			lo = 0.0;
+			hi = 1.0;
+			return true;
+		}
+	}
+	
+	vector2dd normal(-dir.y, dir.x);
+	normal /= normal.length();
+	
+	const f64 d1 = normal.dot_product(b[1] - b[0]);
+	const f64 d2 = normal.dot_product(b[2] - b[0]);
+	const f64 d3 = normal.dot_product(b[3] - b[0]);
+	
+	f64 d_min = min_(min_(0.0, d3), min_(d1, d2));
+	f64 d_max = max_(max_(0.0, d3), max_(d1, d2));
+	
+	/* When the line passes through both ends, the curve stays within 3/4 of
+	 * the control point distances if they are on the same side, or 4/9 if
+	 * they are on opposite sides.
+	 * 
+	 * Reference: T. W. Sederberg and T. Nishita, "Curve intersection using
+	 * Bezier clipping", Computer-Aided Design 22(9), 1990.
+	**/
+	if (through_ends) {
+		const f64 factor = (d1 * d2 > 0.0) ? 0.75 : 4.0 / 9.0;
+		d_min *= factor;
+		d_max *= factor;
+	}
+	
+	// Allow for rounding in the distances.
+	const f64 slack = ROUNDING_ERROR_64 * (1.0 + max_(abs_(d_min), abs_(d_max)));
+	d_min -= slack;
+	d_max += slack;
+	
+	// Distances from the line of a's control points, at t = 0, 1/3, 2/3, 1.
+	f64 e[4];
+	for (u32 i = 0; i < 4; ++i) e[i] = normal.dot_product(a[i] - b[0]);
+	
+	/* The distance of a from the line is a cubic whose Bernstein coefficients
+	 * are e, so it lies inside the convex hull of the points (i / 3, e_i).
+	 * Intersect that hull with the band [d_min, d_max].  The extremes in t
+	 * are hull points inside the band or crossings of the band edges, and
+	 * every hull edge is one of the lines between two of the points.
+	**/
+	lo = 1.0;
+	hi = 0.0;
+	
+	for (u32 i = 0; i < 4; ++i) {
+		if (e[i] >= d_min && e[i] <= d_max) {
+			const f64 t = i / 3.0;
+			lo = min_(lo, t);
+			hi = max_(hi, t);
+		}
+	}
+	
+	for (u32 i = 0; i < 4; ++i) {
+		for (u32 j = i + 1; j < 4; ++j) {
+			const f64 edge[2] = { d_min, d_max };
+			
+			for (u32 k = 0; k < 2; ++k) {
+				if ((e[i] - edge[k]) * (e[j] - edge[k]) >= 0.0) continue;
+				
+				const f64 t = (i + (j - i) * (edge[k] - e[i]) / (e[j] - e[i])) / 3.0;
+				lo = min_(lo, t);
+				hi = max_(hi, t);
+			}
+		}
+	}
+	
+	return lo <= hi;
+}
+
+/**
+ * Find the intersections between the parts [a_lo, a_hi] of the first curve
+ * and [b_lo, b_hi] of the second.
+ * 
+ * @param	a, b		Control points of the two parts.
+ * @param	swapped		True if a is part of the second curve.
+**/
+static void clip_recursive(const vector2dd * a_in, f64 a_lo, f64 a_hi, const vector2dd * b_in, f64 b_lo, f64 b_hi, bool swapped, clip_search& search) {
+	vector2dd a[4], b[4];
+	for (u32 i = 0; i < 4; ++i) {
+		a[i] = a_in[i];
+		b[i] = b_in[i];
+	}
+	
+	for (;;) {
+		if (++search.steps > k_max_clip_steps) return;
+		if (!hull_bounds(a).intersects(hull_bounds(b))) return;
+		
+		if (a_hi - a_lo <= search.tolerance && b_hi - b_lo <= search.tolerance) {
+			const f64 t_a = 0.5 * (a_lo + a_hi);
+			const f64 t_b = 0.5 * (b_lo + b_hi);
+			
+			if (swapped) search.add(t_b, t_a);
+			else search.add(t_a, t_b);
+			return;
+		}
+		
+		f64 lo, hi;
+		if (!fat_line_clip(a, b, lo, hi)) return;
+		
+		vector2dd clipped[4];
+		extract_points(a, lo, hi, clipped);
+		
+		const f64 width = a_hi - a_lo;
+		a_hi = a_lo + hi * width;
+		a_lo = a_lo + lo * width;
+		for (u32 i = 0; i < 4; ++i) a[i] = clipped[i];
+		
+		if (hi - lo > k_min_clip_progress) {
+			// Little progress, there are likely several intersections.  Split
+			// the longer part and search each half.
+			vector2dd left[4], right[4];
+			
+			if (a_hi - a_lo >= b_hi - b_lo) {
+				const f64 a_mid = 0.5 * (a_lo + a_hi);
+				split_points(a, 0.5, left, right);
+				
+				clip_recursive(b, b_lo, b_hi, left, a_lo, a_mid, !swapped, search);
+				clip_recursive(b, b_lo, b_hi, right, a_mid, a_hi, !swapped, search);
+			} else {
+				const f64 b_mid = 0.5 * (b_lo + b_hi);
+				split_points(b, 0.5, left, right);
+				
+				clip_recursive(left, b_lo, b_mid, a, a_lo, a_hi, !swapped, search);
+				clip_recursive(right, b_mid, b_hi, a, a_lo, a_hi, !swapped, search);
+			}
+			
+			return;
+		}
+		
+		// Clip the other curve next.
+		for (u32 i = 0; i < 4; ++i) std::swap(a[i], b[i]);
+		std::swap(a_lo, b_lo);
+		std::swap(a_hi, b_hi);
+		swapped = !swapped;
+	}
+}
+
+size_t intersect(const cubic_bezier& a, const cubic_bezier& b, std::vector<curve_intersection>& out, f64 tolerance) {
+	const vector2dd a_points[4] = { a.origin, a.control_1, a.control_2, a.endpoint };
+	const vector2dd b_points[4] = { b.origin, b.control_1, b.control_2, b.endpoint };
+	
+	clip_search search;
+	search.curve_a = &a;
+	search.tolerance = tolerance;
+	search.steps = 0;
+	search.out = &out;
+	search.first = out.size();
+	
+	clip_recursive(a_points, 0.0, 1.0, b_points, 0.0, 1.0, false, search);
+	return out.size() - search.first;
+}
+
+/*****************************************************************************/
+
+/**
+ * Find the intersections between a curve and the part of a line with
+ * s >= s_min.
+**/
+static size_t intersect_line_from(const cubic_bezier& curve, const vector2dd& origin, const vector2dd& direction, f64 s_min, std::vector<line_intersection>& out) {
+	const f64 length_sq = direction.length_sq();
+	if (iszero(length_sq)) return 0;
+	
+	// Signed distances, scaled by the length of direction.
+	const vector2dd normal(-direction.y, direction.x);
+	const f64 coeff[4] = {
+		normal.dot_product(curve.origin - origin),
+		normal.dot_product(curve.control_1 - origin),
+		normal.dot_product(curve.control_2 - origin),
+		normal.dot_product(curve.endpoint - origin)
+	};
+	
+	f64 roots[3];
+	const u32 count = bernstein_roots(coeff, 3, roots);
+	
+	const size_t first = out.size();
+	for (u32 i = 0; i < count; ++i) {
+		line_intersection res;
+		res.t = roots[i];
+		res.point = curve.get_point(res.t);
+		res.s = direction.dot_product(res.point - origin) / length_sq;
+		
+		if (res.s >= s_min) out.push_back(res);
+	}
+	
+	return out.size() - first;
+}
+
+size_t intersect_line(const cubic_bezier& curve, const vector2dd& origin, const vector2dd& direction, std::vector<line_intersection>& out) {
+	return intersect_line_from(curve, origin, direction, -std::numeric_limits<f64>::infinity(), out);
+}
+
+size_t intersect_ray(const cubic_bezier& curve, const vector2dd& origin, const vector2dd& direction, std::vector<line_intersection>& out) {
+	return intersect_line_from(curve, origin, direction, 0.0, out);
+}
+
+/*****************************************************************************/
+
+/**
+ * Orders box indices by the left edge of the box.
+**/
+struct box_left_less {
+	const aabboxd * boxes;
+	
+	explicit box_left_less(const aabboxd * _boxes) : boxes(_boxes) { }
+	
+	bool operator()(u32 lhs, u32 rhs) const {
+		return boxes[lhs].origin.x < boxes[rhs].origin.x;
+	}
+};
+
+/**
+ * Find every pair of overlapping boxes by sorting along x and sweeping.
+ * Pairs are written with the lower index first.
+**/
+static void overlapping_pairs(const std::vector<aabboxd>& boxes, std::vector<std::pair<u32, u32> >& pairs) {
+	const u32 count = u32(boxes.size());
+	
+	std::vector<u32> order(count);
+	for (u32 i = 0; i < count; ++i) order[i] = i;
+	std::sort(order.begin(), order.end(), box_left_less(&boxes[0]));
+	
+	for (u32 i = 0; i < count; ++i) {
+		const aabboxd& box = boxes[order[i]];
+		const f64 right = box.origin.x + box.extent.x;
+		
+		// Boxes further along start to the right of this one, stop at the
+		// first that starts past its right edge.
+		for (u32 j = i + 1; j < count && boxes[order[j]].origin.x <= right; ++j) {
+			if (!box.intersects(boxes[order[j]])) continue;
+			
+			pairs.push_back(std::make_pair(min_(order[i], order[j]), max_(order[i], order[j])));
+		}
+	}
+}
+
+/**
+ * Intersect the pairs of segments from overlapping_pairs().
+ * 
+ * @param	closed	Skip the join between the last segment and the first.
+ * @param	joined	Skip the joins between neighboring segments.
+**/
+template<typename Segments>
+static size_t intersect_pairs(const Segments& segments, const std::vector<std::pair<u32, u32> >& pairs, bool joined, bool closed, std::vector<segment_intersection>& out, f64 tolerance) {
+	const size_t first = out.size();
+	const u32 last = u32(segments.size()) - 1;
+	const f64 join_tolerance = k_merge_distance * tolerance;
+	
+	std::vector<curve_intersection> found;
+	for (size_t i = 0; i < pairs.size(); ++i) {
+		const u32 a = pairs[i].first;
+		const u32 b = pairs[i].second;
+		
+		found.clear();
+		intersect(segments[a], segments[b], found, tolerance);
+		
+		for (size_t j = 0; j < found.size(); ++j) {
+			const curve_intersection& hit = found[j];
+			
+			if (joined && b == a + 1 && hit.t_a >= 1.0 - join_tolerance && hit.t_b <= join_tolerance) continue;
+			if (closed && a == 0 && b == last && hit.t_a <= join_tolerance && hit.t_b >= 1.0 - join_tolerance) continue;
+			
+			segment_intersection res;
+			res.a = a;
+			res.b = b;
+			res.t_a = hit.t_a;
+			res.t_b = hit.t_b;
+			res.point = hit.point;
+			out.push_back(res);
+		}
+	}
+	
+	return out.size() - first;
+}
+
+/**
+ * Random access to the segments of a cubic_spline, for intersect_pairs().
+**/
+struct spline_segments {
+	const cubic_spline& spline;
+	
+	explicit spline_segments(const cubic_spline& _spline) : spline(_spline) { }
+	
+	size_t size() const { return spline.size(); }
+	cubic_bezier operator[](size_t idx) const { return spline.segment(idx); }
+};
+
+/**
+ * Random access to an array of curves, for intersect_pairs().
+**/
+struct curve_array {
+	const cubic_bezier * curves;
+	size_t count;
+	
+	curve_array(const cubic_bezier * _curves, size_t _count) : curves(_curves), count(_count) { }
+	
+	size_t size() const { return count; }
+	const cubic_bezier& operator[](size_t idx) const { return curves[idx]; }
+};
+
+size_t intersect_all(const cubic_bezier * curves, size_t count, std::vector<segment_intersection>& out, f64 tolerance) {
+	if (count < 2) return 0;
+	
+	std::vector<aabboxd> boxes(count);
+	bounds_batch(curves, count, &boxes[0]);
+	
+	std::vector<std::pair<u32, u32> > pairs;
+	overlapping_pairs(boxes, pairs);
+	
+	return intersect_pairs(curve_array(curves, count), pairs, false, false, out, tolerance);
+}
+
+size_t intersect_all(const cubic_spline& spline, std::vector<segment_intersection>& out, f64 tolerance) {
+	const size_t count = spline.size();
+	if (count < 2) return 0;
+	
+	std::vector<aabboxd> boxes(count);
+	spline.segment_bounds(&boxes[0]);
+	
+	std::vector<std::pair<u32, u32> > pairs;
+	overlapping_pairs(boxes, pairs);
+	
+	const bool closed = (spline.point(0) == spline.point(spline.point_count() - 1));
+	return intersect_pairs(spline_segments(spline), pairs, true, closed, out, tolerance);
+}
+
+/*****************************************************************************/
+} // End of namespace dnr.
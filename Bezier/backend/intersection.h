@@ -0,0 +1,138 @@
+/*
+ * intersection.h
+ * Bezier
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+
+#ifndef _INTERSECTION_H
+#define _INTERSECTION_H
+
+#include <vector>
+#include "cubic_spline.h"
+
+namespace dnr {
+/*****************************************************************************/
+
+/// Default width in t to narrow curve-curve intersections down to.
+const f64 k_intersection_tolerance = 1.0e-9;
+
+/**
+ * An intersection between two curves.
+**/
+struct curve_intersection {
+	f64 t_a;			/// Position on the first curve.
+	f64 t_b;			/// Position on the second curve.
+	vector2dd point;	/// Point of intersection, on the first curve.
+};
+
+/**
+ * An intersection between a curve and a line.
+**/
+struct line_intersection {
+	f64 t;				/// Position on the curve.
+	f64 s;				/// Position on the line, origin + s * direction.
+	vector2dd point;	/// Point of intersection, on the curve.
+};
+
+/**
+ * An intersection between two segments of a collection, see intersect_all().
+**/
+struct segment_intersection {
+	u32 a;				/// Index of the first segment, always less than b.
+	u32 b;				/// Index of the second segment.
+	f64 t_a;			/// Position on the first segment.
+	f64 t_b;			/// Position on the second segment.
+	vector2dd point;	/// Point of intersection, on the first segment.
+};
+
+/*****************************************************************************/
+
+/**
+ * Find the intersections between two curves.
+ * 
+ * Uses fat line clipping: each curve is clipped to the part of it that can
+ * lie between two lines bounding the other, alternating between the curves.
+ * When a clip fails to remove at least a fifth of a curve, which happens
+ * with several intersections or tangent curves, the longer of the two is
+ * split in half and both halves are searched.  Pairs whose control point
+ * boxes do not overlap are rejected before clipping.
+ * 
+ * Curves that overlap along a stretch have infinitely many intersections.
+ * The search gives up after a fixed amount of work, and reports whatever
+ * points it has narrowed down by then.
+ * 
+ * @param	a			The first curve.
+ * @param	b			The second curve.
+ * @param	out			Intersections are appended to this, in no particular
+ * 						order.
+ * @param	tolerance	Width in t to narrow each intersection down to.
+ * @return	Number of intersections appended.
+**/
+size_t intersect(const cubic_bezier& a, const cubic_bezier& b, std::vector<curve_intersection>& out, f64 tolerance = k_intersection_tolerance);
+
+/**
+ * Find the intersections between a curve and an infinite line.
+ * 
+ * The signed distances of the control points from the line are the
+ * Bernstein coefficients of the distance of the curve from the line, so
+ * the intersections are the roots of that cubic.
+ * 
+ * @param	curve		The curve.
+ * @param	origin		A point on the line.
+ * @param	direction	Direction of the line, need not be normalized.
+ * @param	out			Intersections are appended to this, in order of t.
+ * @return	Number of intersections appended.
+**/
+size_t intersect_line(const cubic_bezier& curve, const vector2dd& origin, const vector2dd& direction, std::vector<line_intersection>& out);
+
+/**
+ * Find the intersections between a curve and a ray, the part of a line
+ * with s >= 0.  See intersect_line().
+**/
+size_t intersect_ray(const cubic_bezier& curve, const vector2dd& origin, const vector2dd& direction, std::vector<line_intersection>& out);
+
+/**
+ * Find the intersections between every pair of curves in a collection.
+ * 
+ * Curve bounds are sorted along x and swept, so only pairs whose bounds
+ * overlap are tested.  For sparse scenes this is close to O(n log n) rather
+ * than testing all O(n^2) pairs.
+ * 
+ * @param	curves		The curves.
+ * @param	count		Number of curves.
+ * @param	out			Intersections are appended to this, in no particular
+ * 						order.
+ * @param	tolerance	Width in t to narrow each intersection down to.
+ * @return	Number of intersections appended.
+**/
+size_t intersect_all(const cubic_bezier * curves, size_t count, std::vector<segment_intersection>& out, f64 tolerance = k_intersection_tolerance);
+
+/**
+ * Find the intersections between every pair of segments in a path.  The
+ * joins between neighboring segments are not reported, including the join
+ * closing the path if it ends where it starts.
+**/
+size_t intersect_all(const cubic_spline& spline, std::vector<segment_intersection>& out, f64 tolerance = k_intersection_tolerance);
+
+/*****************************************************************************/
+} // End of namespace dnr.
+
+#endif // _INTERSECTION_H.
@@ -31,69 +31,69 @@ namespace dnr {
 /*****************************************************************************/
 
 //! Rounding error constant often used when comparing f32 values.
-const f32 ROUNDING_ERROR_32 = 0.000001f;
-const f64 ROUNDING_ERROR_64 = 0.00000001f;
+CONSTEXPR_VAR f32 ROUNDING_ERROR_32 = 0.000001f;
+CONSTEXPR_VAR f64 ROUNDING_ERROR_64 = 0.00000001f;
 
 #ifdef PI // Make sure we don't collide with a define.
 #undef PI
 #endif
 /// Constant for PI.
-const f32 PI = 3.14159265359f;
+CONSTEXPR_VAR f32 PI = 3.14159265359f;
 
 /// Constant for reciprocal of PI.
-const f32 RECIPROCAL_PI = 1.0f / PI;
+CONSTEXPR_VAR f32 RECIPROCAL_PI = 1.0f / PI;
 
 /// Constant for half of PI.
-const f32 HALF_PI = PI / 2.0f;
+CONSTEXPR_VAR f32 HALF_PI = PI / 2.0f;
 
 #ifdef PI64 // Make sure we don't collide with a define.
 #undef PI64
 #endif
 /// Constant for 64-bit PI.
-const f64 PI64 = 3.1415926535897932384626433832795028841971693993751;
+CONSTEXPR_VAR f64 PI64 = 3.1415926535897932384626433832795028841971693993751;
 
 /// Constant for 64-bit reciprocal of PI.
-const f64 RECIPROCAL_PI64 = 1.0 / PI64;
+CONSTEXPR_VAR f64 RECIPROCAL_PI64 = 1.0 / PI64;
 
 /// 32-bit Constant for converting from degrees to radians.
-const f32 DEGTORAD = PI / 180.0f;
+CONSTEXPR_VAR f32 DEGTORAD = PI / 180.0f;
 
 /// 32-bit constant for converting from radians to degrees (formally known as GRAD_PI).
-const f32 RADTODEG = 180.0f / PI;
+CONSTEXPR_VAR f32 RADTODEG = 180.0f / PI;
 
 /// 64-bit constant for converting from degrees to radians (formally known as GRAD_PI2).
-const f64 DEGTORAD64 = PI64 / 180.0;
+CONSTEXPR_VAR f64 DEGTORAD64 = PI64 / 180.0;
 
 /// 64-bit constant for converting from radians to degrees.
-const f64 RADTODEG64 = 180.0 / PI64;
+CONSTEXPR_VAR f64 RADTODEG64 = 180.0 / PI64;
 
 /// Returns minimum of two values.
 template<typename T>
-inline const T& min_(const T& a, const T& b) {
+CONSTEXPR const T& min_(const T& a, const T& b) NOEXCEPT {
 	return a < b ? a : b;
 }
 
 /// Returns minimum of three values.
 template<typename T>
-inline const T& min_(const T& a, const T& b, const T& c) {
+CONSTEXPR const T& min_(const T& a, const T& b, const T& c) NOEXCEPT {
 	return a < b ? min_(a, c) : min_(b, c);
 }
 
 /// Returns maximum of two values.
 template<typename T>
-inline const T& max_(const T& a, const T& b) {
+CONSTEXPR const T& max_(const T& a, const T& b) NOEXCEPT {
 	return a < b ? b : a;
 }
 
 /// Returns maximum of three values.
 template<typename T>
-inline const T& max_(const T& a, const T& b, const T& c) {
+CONSTEXPR const T& max_(const T& a, const T& b, const T& c) NOEXCEPT {
 	return a < b ? max_(b, c) : max_(a, c);
 }
 
 /// Returns abs of two values.
 template<typename T>
-inline T abs_(const T& a) {
+CONSTEXPR T abs_(const T& a) NOEXCEPT {
 	return a < (T) 0 ? -a : a;
 }
 
@@ -109,53 +109,53 @@ inline T round_(T orig) {
  * @return a if t == 0, b if t == 1, and the linear interpolation else.
 **/
 template<typename T>
-inline T lerp(const T& a, const T& b, const f32 t) {
+CONSTEXPR T lerp(const T& a, const T& b, const f32 t) NOEXCEPT {
 	return T(a * (1.0f - t)) + (b * t);
 }
 
 /// Clamps a value between low and high.
 template <typename T>
-inline const T clamp(const T& value, const T& low, const T& high) {
+CONSTEXPR const T clamp(const T& value, const T& low, const T& high) NOEXCEPT {
 	return min_(max_(value, low), high);
 }
 
 /// Returns if a equals b, taking possible rounding errors into account.
-inline bool equals(const f32 a, const f32 b, const f32 tolerance = ROUNDING_ERROR_32) {
+CONSTEXPR bool equals(const f32 a, const f32 b, const f32 tolerance = ROUNDING_ERROR_32) NOEXCEPT {
 	return (a + tolerance >= b) && (a - tolerance <= b);
 }
 
 /// Returns if a equals b, taking possible rounding errors into account.
-inline bool equals(const f64 a, const f64 b, const f64 tolerance = ROUNDING_ERROR_64) {
+CONSTEXPR bool equals(const f64 a, const f64 b, const f64 tolerance = ROUNDING_ERROR_64) NOEXCEPT {
 	return (a + tolerance >= b) && (a - tolerance <= b);
 }
 
 /// Returns if a equals b, taking possible rounding errors into account/
-inline bool equals(const s32 a, const s32 b, const s32 tolerance = 0) {
+CONSTEXPR bool equals(const s32 a, const s32 b, const s32 tolerance = 0) NOEXCEPT {
 	return (a + tolerance >= b) && (a - tolerance <= b);
 }
 
 /// Returns if a equals b, taking possible rounding errors into account/
-inline bool equals(const u32 a, const u32 b, const u32 tolerance = 0) {
+CONSTEXPR bool equals(const u32 a, const u32 b, const u32 tolerance = 0) NOEXCEPT {
 	return (a + tolerance >= b) && (a - tolerance <= b);
 }
 
 /// Returns if a equals zero, taking rounding errors into account.
-inline bool iszero(const f32 a, const f32 tolerance = ROUNDING_ERROR_32) {
-	return fabsf(a) <= tolerance;
+CONSTEXPR bool iszero(const f32 a, const f32 tolerance = ROUNDING_ERROR_32) NOEXCEPT {
+	return -tolerance <= a && a <= tolerance;
 }
 
 /// Returns if a equals zero, taking rounding errors into account.
-inline bool iszero(const f64 a, const f64 tolerance = ROUNDING_ERROR_64) {
-	return fabs(a) <= tolerance;
+CONSTEXPR bool iszero(const f64 a, const f64 tolerance = ROUNDING_ERROR_64) NOEXCEPT {
+	return -tolerance <= a && a <= tolerance;
 }
 
 /// Returns if a equals zero, taking rounding errors into account.
-inline bool iszero(const s32 a, const s32 tolerance = 0) {
+CONSTEXPR bool iszero(const s32 a, const s32 tolerance = 0) NOEXCEPT {
 	return (a & 0x7FFFFFF) <= tolerance;
 }
 
 /// Returns if a equals zero, taking rounding errors into account.
-inline bool iszero(const u32 a, const u32 tolerance = 0) {
+CONSTEXPR bool iszero(const u32 a, const u32 tolerance = 0) NOEXCEPT {
 	return a <= tolerance;
 }
 
@@ -163,39 +163,194 @@ template <typename T>
 struct quadratic_solution {
 	T solution[2];
 	bool has_solution;
+	u32 count; ///< Number of real roots, a double root is reported twice.
 };
 
 /**
- * Solve a quadratic equation.
+ * Solve a quadratic equation, a t^2 + b t + c = 0.
+ * 
+ * Uses the Citardauq form, q = -(b + sign(b) sqrt(b^2 - 4ac)) / 2 with
+ * roots q / a and c / q, which never subtracts two values of the same sign
+ * and so keeps full precision when b^2 >> 4ac.  When a is zero the equation
+ * is solved as linear.
  * 
  * @param a	First coefficient.
  * @param b	Second coefficient.
  * @param c	Third coefficient.
- * @return quadratic_solution, containing 0-2 solutions.
+ * @return quadratic_solution, containing 0-2 solutions in increasing order.
 **/
 template <typename T>
-quadratic_solution<T> solve_quadratic(T a, T b, T c) {
+quadratic_solution<T> solve_quadratic(T a, T b, T c) NOEXCEPT {
 	quadratic_solution<T> res;
+	res.has_solution = false;
+	res.count = 0;
+	
+	if (a == T(0.0)) {
+		// Linear, b t + c = 0.
+		if (b != T(0.0)) {
+			res.solution[0] = res.solution[1] = -c / b;
+			res.has_solution = true;
+			res.count = 1;
+		}
+		
+		return res;
+	}
 	
 	// b^2 - 4ac.
-	T sqrt_content = b * b - 4.0 * a * c;
+	const T disc = b * b - T(4.0) * a * c;
 	
 	// Check to see if any solutions exist.
-	if (sqrt_content < T(0.0)) {
-		res.has_solution = false;
+	if (disc < T(0.0)) return res;
+	
+	const T root = sqrt(disc);
+	const T q = T(-0.5) * (b + (b < T(0.0) ? -root : root));
+	
+	if (q == T(0.0)) {
+		// Only possible when b = c = 0, a double root at zero.
+		res.solution[0] = res.solution[1] = T(0.0);
+	} else {
+		const T t1 = q / a;
+		const T t2 = c / q;
+		res.solution[0] = min_(t1, t2);
+		res.solution[1] = max_(t1, t2);
+	}
+	
+	res.has_solution = true;
+	res.count = 2;
+	return res;
+}
+
+template <typename T>
+struct cubic_solution {
+	T solution[3];
+	u32 count; ///< Number of real roots.
+};
+
+/**
+ * Solve a cubic equation, a t^3 + b t^2 + c t + d = 0.
+ * 
+ * Three real roots are found with the trigonometric method and a single
+ * real root with Cardano's formula, then each is polished with Newton's
+ * method on the original coefficients.  When a is zero, or so small that
+ * normalizing by it overflows, the equation is solved as a quadratic.
+ * 
+ * @return cubic_solution, containing 1-3 solutions in increasing order, or
+ *         0-2 for the quadratic fallback.
+**/
+template <typename T>
+cubic_solution<T> solve_cubic(T a, T b, T c, T d) NOEXCEPT {
+	cubic_solution<T> res;
+	res.count = 0;
+	
+	// Normalize to t^3 + nb t^2 + nc t + nd.
+	const T nb = b / a;
+	const T nc = c / a;
+	const T nd = d / a;
+	
+	// Also false for NaN, which catches a == 0.
+	const T k_max = T(1e100);
+	if (!(abs_(nb) < k_max && abs_(nc) < k_max && abs_(nd) < k_max)) {
+		const quadratic_solution<T> quad = solve_quadratic(b, c, d);
+		for (u32 i = 0; i < quad.count; ++i) res.solution[i] = quad.solution[i];
+		res.count = quad.count;
 		return res;
 	}
 	
-	// Build up the equation.
-	sqrt_content = sqrt(sqrt_content);
+	const T q = (nb * nb - T(3.0) * nc) / T(9.0);
+	const T r = (T(2.0) * nb * nb * nb - T(9.0) * nb * nc + T(27.0) * nd) / T(54.0);
+	const T q3 = q * q * q;
+	const T offset = nb / T(3.0);
+	
+	if (r * r < q3) {
+		// Three real roots, q > 0 here.
+		const T theta = T(acos(clamp(T(r / sqrt(q3)), T(-1.0), T(1.0))));
+		const T scale = T(-2.0) * sqrt(q);
+		res.solution[0] = scale * cos(theta / T(3.0)) - offset;
+		res.solution[1] = scale * cos((theta + T(2.0 * PI64)) / T(3.0)) - offset;
+		res.solution[2] = scale * cos((theta - T(2.0 * PI64)) / T(3.0)) - offset;
+		res.count = 3;
+	} else {
+		const T s = T(cbrt(f64(abs_(r) + sqrt(r * r - q3))));
+		const T u = (r > T(0.0)) ? -s : s;
+		const T v = (u == T(0.0)) ? T(0.0) : q / u;
+		res.solution[0] = (u + v) - offset;
+		res.count = 1;
+		
+		// A double root where the discriminant is exactly zero.
+		if (r * r == q3 && u != T(0.0)) {
+			res.solution[1] = T(-0.5) * (u + v) - offset;
+			res.count = 2;
+		}
+	}
+	
+	// Polish, keeping each Newton step only while it improves the residual.
+	for (u32 i = 0; i < res.count; ++i) {
+		T t = res.solution[i];
+		T value = ((a * t + b) * t + c) * t + d;
+		
+		for (u32 iter = 0; iter < 4 && value != T(0.0); ++iter) {
+			const T deriv = (T(3.0) * a * t + T(2.0) * b) * t + c;
+			if (deriv == T(0.0)) break;
+			
+			const T next = t - value / deriv;
+			const T next_value = ((a * next + b) * next + c) * next + d;
+			if (!(abs_(next_value) < abs_(value))) break;
+			
+			t = next;
+			value = next_value;
+		}
+		
+		res.solution[i] = t;
+	}
+	
+	// Sort the (at most three) roots.
+	for (u32 i = 1; i < res.count; ++i) {
+		for (u32 j = i; j > 0 && res.solution[j] < res.solution[j - 1]; --j) {
+			const T tmp = res.solution[j];
+			res.solution[j] = res.solution[j - 1];
+			res.solution[j - 1] = tmp;
+		}
+	}
 	
-	// Solve the two conditions.
-	res.solution[0] = (-b + sqrt_content) / (2.0 * a);
-	res.solution[1] = (-b - sqrt_content) / (2.0 * a);
-	res.has_solution = true;
 	return res;
 }
 
+/**
+ * Solve a quadratic equation, keeping only the roots in [0, 1].
+ * 
+ * @param roots	Receives up to two roots in increasing order.
+ * @return Number of roots written.
+**/
+template <typename T>
+u32 solve_quadratic_unit(T a, T b, T c, T * roots) NOEXCEPT {
+	const quadratic_solution<T> res = solve_quadratic(a, b, c);
+	
+	u32 count = 0;
+	for (u32 i = 0; i < res.count; ++i) {
+		if (res.solution[i] >= T(0.0) && res.solution[i] <= T(1.0)) roots[count++] = res.solution[i];
+	}
+	
+	return count;
+}
+
+/**
+ * Solve a cubic equation, keeping only the roots in [0, 1].
+ * 
+ * @param roots	Receives up to three roots in increasing order.
+ * @return Number of roots written.
+**/
+template <typename T>
+u32 solve_cubic_unit(T a, T b, T c, T d, T * roots) NOEXCEPT {
+	const cubic_solution<T> res = solve_cubic(a, b, c, d);
+	
+	u32 count = 0;
+	for (u32 i = 0; i < res.count; ++i) {
+		if (res.solution[i] >= T(0.0) && res.solution[i] <= T(1.0)) roots[count++] = res.solution[i];
+	}
+	
+	return count;
+}
+
 /**
  * Test if a variable is in a specific range, using an optimized technique
  * that requires only one branch.  Some compilers do this automatically.
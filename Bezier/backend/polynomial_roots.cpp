@@ -0,0 +1,366 @@
+/*
+ * polynomial_roots.cpp
+ * Bezier
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+#include <limits>
+#include "polynomial_roots.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace dnr {
+/*****************************************************************************/
+
+/// Newton steps smaller than this end the polish, roots are all in [0, 1].
+static const f64 k_root_tolerance = 1e-15;
+
+/// Iteration limit when polishing, enough to bisect down to k_root_tolerance.
+static const u32 k_max_polish_iterations = 64;
+
+/*****************************************************************************/
+// Scalar kernels, also used for the tail of each batch.
+
+/**
+ * Solve one quadratic, matching the SSE2 path of solve_quadratic_batch().
+**/
+static inline void quadratic_roots(f64 a, f64 b, f64 c, bool unit_interval, f64& root_0, f64& root_1) {
+	const f64 nan = std::numeric_limits<f64>::quiet_NaN();
+	root_0 = root_1 = nan;
+	
+	const f64 disc = b * b - 4.0 * a * c;
+	if (!(disc >= 0.0)) return;
+	
+	const f64 root = sqrt(disc);
+	const f64 q = -0.5 * (b + (b < 0.0 ? -root : root));
+	const f64 t1 = q / a;
+	const f64 t2 = (q == 0.0) ? t1 : c / q;
+	
+	const f64 lo = unit_interval ? 0.0 : -std::numeric_limits<f64>::max();
+	const f64 hi = unit_interval ? 1.0 : std::numeric_limits<f64>::max();
+	const bool valid_1 = (t1 >= lo && t1 <= hi);
+	const bool valid_2 = (t2 >= lo && t2 <= hi);
+	
+	if (valid_1 && valid_2) {
+		root_0 = min_(t1, t2);
+		root_1 = max_(t1, t2);
+	} else if (valid_1) {
+		root_0 = t1;
+	} else if (valid_2) {
+		root_0 = t2;
+	}
+}
+
+/// Horner's rule, in the same order as polish_bracketed_root().
+static inline f64 evaluate_power(const f64 * power, u32 degree, f64 t) {
+	f64 value = power[degree];
+	for (u32 k = degree; k-- > 0;) value = value * t + power[k];
+	return value;
+}
+
+/**
+ * Find the roots in [0, 1] of one polynomial, see
+ * solve_polynomial_unit_batch().
+ * 
+ * @param	roots	Receives degree values, packed with NaN padding.
+**/
+static void unit_roots(const f64 * power, u32 degree, f64 * roots) {
+	// chain[level] is the (degree - level)th derivative, of degree level.
+	f64 chain[k_max_bernstein_degree + 1][k_max_bernstein_degree + 1];
+	for (u32 k = 0; k <= degree; ++k) chain[degree][k] = power[k];
+	
+	for (u32 level = degree; level > 1; --level) {
+		for (u32 k = 0; k < level; ++k) chain[level - 1][k] = f64(k + 1) * chain[level][k + 1];
+	}
+	
+	f64 ends[k_max_bernstein_degree + 1];
+	f64 values[k_max_bernstein_degree + 1];
+	f64 found[k_max_bernstein_degree];
+	bool valid[k_max_bernstein_degree];
+	
+	// The linear or quadratic level is solved directly.
+	const u32 low = min_(degree, 2u);
+	f64 quad[2];
+	quadratic_roots(low == 2 ? chain[2][2] : 0.0, chain[low][1], chain[low][0], true, quad[0], quad[1]);
+	
+	valid[0] = (quad[0] == quad[0]);
+	valid[1] = (quad[1] == quad[1]);
+	found[0] = valid[0] ? quad[0] : 0.0;
+	found[1] = valid[1] ? quad[1] : found[0];
+	
+	for (u32 level = 3; level <= degree; ++level) {
+		// Brackets run between the roots of the previous level.
+		ends[0] = 0.0;
+		for (u32 j = 1; j < level; ++j) ends[j] = found[j - 1];
+		ends[level] = 1.0;
+		
+		for (u32 j = 0; j <= level; ++j) values[j] = evaluate_power(chain[level], level, ends[j]);
+		
+		for (u32 j = 0; j < level; ++j) {
+			const f64 lo = ends[j];
+			const f64 hi = ends[j + 1];
+			const f64 value_lo = values[j];
+			const f64 value_hi = values[j + 1];
+			
+			valid[j] = hi > lo && ((value_lo <= 0.0 && value_hi >= 0.0) || (value_lo >= 0.0 && value_hi <= 0.0));
+			
+			// Missing roots collapse onto the start of their bracket, keeping the order.
+			if (!valid[j]) found[j] = lo;
+			else if (value_lo == 0.0) found[j] = lo;
+			else if (value_hi == 0.0) found[j] = hi;
+			else found[j] = polish_bracketed_root(chain[level], level, lo, hi, value_lo, value_hi, k_root_tolerance);
+		}
+	}
+	
+	u32 count = 0;
+	for (u32 j = 0; j < degree; ++j) {
+		if (valid[j]) roots[count++] = found[j];
+	}
+	
+	while (count < degree) roots[count++] = std::numeric_limits<f64>::quiet_NaN();
+}
+
+/*****************************************************************************/
+// SSE2 kernels, solving two polynomials per register.
+
+#if defined(__SSE2__)
+/// Per-lane mask ? a : b.
+static inline __m128d select(__m128d mask, __m128d a, __m128d b) {
+	return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+}
+
+/**
+ * Two-lane version of quadratic_roots(), keeping roots in [lo, hi].
+**/
+static inline void quadratic_roots(__m128d a, __m128d b, __m128d c, __m128d lo, __m128d hi, __m128d& root_0, __m128d& root_1) {
+	const __m128d zero = _mm_setzero_pd();
+	const __m128d sign_mask = _mm_set1_pd(-0.0);
+	const __m128d nan = _mm_set1_pd(std::numeric_limits<f64>::quiet_NaN());
+	
+	const __m128d disc = _mm_sub_pd(_mm_mul_pd(b, b), _mm_mul_pd(_mm_set1_pd(4.0), _mm_mul_pd(a, c)));
+	const __m128d has_roots = _mm_cmpge_pd(disc, zero);
+	const __m128d root = _mm_sqrt_pd(_mm_max_pd(disc, zero));
+	
+	// q = -0.5 (b + sign(b) sqrt(disc)).
+	const __m128d signed_root = _mm_or_pd(root, _mm_and_pd(b, sign_mask));
+	const __m128d q = _mm_mul_pd(_mm_set1_pd(-0.5), _mm_add_pd(b, signed_root));
+	
+	const __m128d t1 = _mm_div_pd(q, a);
+	const __m128d t2 = select(_mm_cmpeq_pd(q, zero), t1, _mm_div_pd(c, q));
+	
+	// Range checks are false for NaN, and the default range excludes infinity.
+	const __m128d valid_1 = _mm_and_pd(has_roots, _mm_and_pd(_mm_cmpge_pd(t1, lo), _mm_cmple_pd(t1, hi)));
+	const __m128d valid_2 = _mm_and_pd(has_roots, _mm_and_pd(_mm_cmpge_pd(t2, lo), _mm_cmple_pd(t2, hi)));
+	const __m128d both = _mm_and_pd(valid_1, valid_2);
+	
+	const __m128d single = select(valid_1, t1, select(valid_2, t2, nan));
+	root_0 = select(both, _mm_min_pd(t1, t2), single);
+	root_1 = select(both, _mm_max_pd(t1, t2), nan);
+}
+
+static inline __m128d evaluate_power(const __m128d * power, u32 degree, __m128d t) {
+	__m128d value = power[degree];
+	for (u32 k = degree; k-- > 0;) value = _mm_add_pd(_mm_mul_pd(value, t), power[k]);
+	return value;
+}
+
+/**
+ * Polish the root inside each lane's bracket, a branch-free version of
+ * polish_bracketed_root().  Lanes stop updating once converged, and the
+ * loop ends when every lane has.
+ * 
+ * @param	active	Lanes to polish, the result is undefined for the rest.
+**/
+static inline __m128d polish_bracketed_root(const __m128d * power, u32 degree, __m128d lo, __m128d hi, __m128d value_lo, __m128d value_hi, __m128d active) {
+	if (!_mm_movemask_pd(active)) return lo;
+	
+	const __m128d zero = _mm_setzero_pd();
+	const __m128d half = _mm_set1_pd(0.5);
+	const __m128d sign_mask = _mm_set1_pd(-0.0);
+	const __m128d tolerance = _mm_set1_pd(k_root_tolerance);
+	const __m128d rising = _mm_cmpgt_pd(value_hi, value_lo);
+	
+	// Start at the false position estimate.
+	__m128d t = _mm_add_pd(lo, _mm_div_pd(_mm_mul_pd(_mm_sub_pd(hi, lo), value_lo), _mm_sub_pd(value_lo, value_hi)));
+	
+	for (u32 i = 0; i < k_max_polish_iterations && _mm_movemask_pd(active); ++i) {
+		__m128d value = power[degree];
+		__m128d deriv = zero;
+		for (u32 k = degree; k-- > 0;) {
+			deriv = _mm_add_pd(_mm_mul_pd(deriv, t), value);
+			value = _mm_add_pd(_mm_mul_pd(value, t), power[k]);
+		}
+		
+		// An exact zero ends the lane where it is.
+		active = _mm_andnot_pd(_mm_cmpeq_pd(value, zero), active);
+		
+		// Shrink the bracket to the side that still holds the sign change.
+		const __m128d below = _mm_cmplt_pd(value, zero);
+		const __m128d to_hi = _mm_and_pd(active, _mm_xor_pd(below, rising));
+		const __m128d to_lo = _mm_andnot_pd(to_hi, active);
+		lo = select(to_lo, t, lo);
+		hi = select(to_hi, t, hi);
+		
+		// Bisect wherever the Newton step leaves the bracket, including deriv == 0.
+		__m128d next = _mm_sub_pd(t, _mm_div_pd(value, deriv));
+		const __m128d inside = _mm_and_pd(_mm_cmpgt_pd(next, lo), _mm_cmplt_pd(next, hi));
+		next = select(inside, next, _mm_mul_pd(half, _mm_add_pd(lo, hi)));
+		
+		const __m128d step = _mm_andnot_pd(sign_mask, _mm_sub_pd(next, t));
+		t = select(active, next, t);
+		
+		const __m128d done = _mm_or_pd(_mm_cmple_pd(step, tolerance), _mm_cmple_pd(_mm_sub_pd(hi, lo), tolerance));
+		active = _mm_andnot_pd(done, active);
+	}
+	
+	return t;
+}
+
+/**
+ * Two-lane version of unit_roots(), leaving the roots unpacked.
+ * 
+ * @param	found	Receives the root in each bracket of the last level.
+ * @param	valid	Receives which brackets held a root.
+**/
+static void unit_roots(const __m128d * power, u32 degree, __m128d * found, __m128d * valid) {
+	const __m128d zero = _mm_setzero_pd();
+	
+	__m128d chain[k_max_bernstein_degree + 1][k_max_bernstein_degree + 1];
+	for (u32 k = 0; k <= degree; ++k) chain[degree][k] = power[k];
+	
+	for (u32 level = degree; level > 1; --level) {
+		for (u32 k = 0; k < level; ++k) chain[level - 1][k] = _mm_mul_pd(_mm_set1_pd(f64(k + 1)), chain[level][k + 1]);
+	}
+	
+	__m128d ends[k_max_bernstein_degree + 1];
+	__m128d values[k_max_bernstein_degree + 1];
+	
+	// The linear or quadratic level is solved directly.
+	const u32 low = min_(degree, 2u);
+	__m128d quad[2];
+	quadratic_roots(low == 2 ? chain[2][2] : zero, chain[low][1], chain[low][0], zero, _mm_set1_pd(1.0), quad[0], quad[1]);
+	
+	valid[0] = _mm_cmpeq_pd(quad[0], quad[0]);
+	valid[1] = _mm_cmpeq_pd(quad[1], quad[1]);
+	found[0] = select(valid[0], quad[0], zero);
+	found[1] = select(valid[1], quad[1], found[0]);
+	
+	for (u32 level = 3; level <= degree; ++level) {
+		ends[0] = zero;
+		for (u32 j = 1; j < level; ++j) ends[j] = found[j - 1];
+		ends[level] = _mm_set1_pd(1.0);
+		
+		for (u32 j = 0; j <= level; ++j) values[j] = evaluate_power(chain[level], level, ends[j]);
+		
+		for (u32 j = 0; j < level; ++j) {
+			const __m128d lo = ends[j];
+			const __m128d hi = ends[j + 1];
+			const __m128d value_lo = values[j];
+			const __m128d value_hi = values[j + 1];
+			
+			const __m128d rises = _mm_and_pd(_mm_cmple_pd(value_lo, zero), _mm_cmpge_pd(value_hi, zero));
+			const __m128d falls = _mm_and_pd(_mm_cmpge_pd(value_lo, zero), _mm_cmple_pd(value_hi, zero));
+			const __m128d bracket = _mm_and_pd(_mm_cmpgt_pd(hi, lo), _mm_or_pd(rises, falls));
+			const __m128d lo_zero = _mm_cmpeq_pd(value_lo, zero);
+			const __m128d hi_zero = _mm_cmpeq_pd(value_hi, zero);
+			
+			const __m128d polish = _mm_andnot_pd(_mm_or_pd(lo_zero, hi_zero), bracket);
+			__m128d root = polish_bracketed_root(chain[level], level, lo, hi, value_lo, value_hi, polish);
+			root = select(hi_zero, hi, root);
+			root = select(lo_zero, lo, root);
+			
+			// Missing roots collapse onto the start of their bracket, keeping the order.
+			found[j] = select(bracket, root, lo);
+			valid[j] = bracket;
+		}
+	}
+}
+#endif
+
+/*****************************************************************************/
+
+void solve_quadratic_batch(const f64 * a, const f64 * b, const f64 * c, size_t count, f64 * root_0, f64 * root_1, bool unit_interval) {
+	size_t i = 0;
+	
+#if defined(__SSE2__)
+	const __m128d lo = _mm_set1_pd(unit_interval ? 0.0 : -std::numeric_limits<f64>::max());
+	const __m128d hi = _mm_set1_pd(unit_interval ? 1.0 : std::numeric_limits<f64>::max());
+	
+	for (; i + 2 <= count; i += 2) {
+		__m128d lane_root_0, lane_root_1;
+		quadratic_roots(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i), _mm_loadu_pd(c + i), lo, hi, lane_root_0, lane_root_1);
+		_mm_storeu_pd(root_0 + i, lane_root_0);
+		_mm_storeu_pd(root_1 + i, lane_root_1);
+	}
+#endif
+	
+	for (; i < count; ++i) {
+		quadratic_roots(a[i], b[i], c[i], unit_interval, root_0[i], root_1[i]);
+	}
+}
+
+void solve_cubic_unit_batch(const f64 * a, const f64 * b, const f64 * c, const f64 * d, size_t count, f64 * root_0, f64 * root_1, f64 * root_2) {
+	const f64 * const power[4] = { d, c, b, a };
+	f64 * const roots[3] = { root_0, root_1, root_2 };
+	solve_polynomial_unit_batch(power, 3, count, roots);
+}
+
+void solve_polynomial_unit_batch(const f64 * const * power, u32 degree, size_t count, f64 * const * roots) {
+	size_t i = 0;
+	
+#if defined(__SSE2__)
+	__m128d lane_power[k_max_bernstein_degree + 1];
+	__m128d found[k_max_bernstein_degree];
+	__m128d valid[k_max_bernstein_degree];
+	
+	for (; i + 2 <= count; i += 2) {
+		for (u32 k = 0; k <= degree; ++k) lane_power[k] = _mm_loadu_pd(power[k] + i);
+		
+		unit_roots(lane_power, degree, found, valid);
+		
+		// Pack each lane's roots to the front.
+		for (u32 lane = 0; lane < 2; ++lane) {
+			u32 written = 0;
+			for (u32 j = 0; j < degree; ++j) {
+				f64 root[2];
+				_mm_storeu_pd(root, found[j]);
+				if (_mm_movemask_pd(valid[j]) & (1 << lane)) roots[written++][i + lane] = root[lane];
+			}
+			
+			for (; written < degree; ++written) roots[written][i + lane] = std::numeric_limits<f64>::quiet_NaN();
+		}
+	}
+#endif
+	
+	f64 lane_coeff[k_max_bernstein_degree + 1];
+	f64 lane_roots[k_max_bernstein_degree];
+	
+	for (; i < count; ++i) {
+		for (u32 k = 0; k <= degree; ++k) lane_coeff[k] = power[k][i];
+		
+		unit_roots(lane_coeff, degree, lane_roots);
+		for (u32 j = 0; j < degree; ++j) roots[j][i] = lane_roots[j];
+	}
+}
+
+/*****************************************************************************/
+} // End of namespace dnr.
@@ -0,0 +1,84 @@
+/*
+ * polynomial_roots.h
+ * Bezier
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+#ifndef _POLYNOMIAL_ROOTS_H
+#define _POLYNOMIAL_ROOTS_H
+
+#include <cstddef>
+#include "bernstein.h"
+
+namespace dnr {
+/*****************************************************************************/
+
+/* Batch root solvers, the array counterparts of solve_quadratic(),
+ * solve_cubic_unit() and solve_polynomial_unit().  Coefficients are passed
+ * as separate arrays so that two polynomials share each SSE2 register.
+ * 
+ * Roots are written to one array per root slot: for each polynomial, the
+ * roots found are packed into the first slots in increasing order and the
+ * remaining slots are set to NaN.
+**/
+
+/**
+ * Solve a t^2 + b t + c = 0 for every i, using the same Citardauq form as
+ * solve_quadratic().  Roots that are infinite, such as q / a when a is zero,
+ * are dropped.
+ * 
+ * @param	count			Number of equations.
+ * @param	root_0			Receives the smallest root of each equation.
+ * @param	root_1			Receives the largest root of each equation.
+ * @param	unit_interval	If true, only keep roots in [0, 1].
+**/
+void solve_quadratic_batch(const f64 * a, const f64 * b, const f64 * c, size_t count, f64 * root_0, f64 * root_1, bool unit_interval = false);
+
+/**
+ * Find the roots in [0, 1] of a t^3 + b t^2 + c t + d for every i, see
+ * solve_polynomial_unit_batch().
+**/
+void solve_cubic_unit_batch(const f64 * a, const f64 * b, const f64 * c, const f64 * d, size_t count, f64 * root_0, f64 * root_1, f64 * root_2);
+
+/**
+ * Find the roots in [0, 1] of many polynomials given in power basis.
+ * 
+ * The real roots of a polynomial are separated by the roots of its
+ * derivative, so the roots of each derivative, starting from a quadratic
+ * solved in closed form, bracket the roots of the next.  The polynomial is monotonic inside every
+ * bracket, which leaves at most one root to polish with the same safeguarded
+ * Newton iteration as polish_bracketed_root().  Unlike bernstein_roots()
+ * there is no recursion, so every lane runs the same instructions.
+ * 
+ * A root that lands exactly on a root of the derivative, a double root, may
+ * be reported twice.
+ * 
+ * @param	power	degree + 1 arrays of coefficients, lowest degree first,
+ *					each holding count values.
+ * @param	degree	Degree of the polynomials, at most k_max_bernstein_degree.
+ * @param	count	Number of polynomials.
+ * @param	roots	degree arrays, each receiving count values.
+**/
+void solve_polynomial_unit_batch(const f64 * const * power, u32 degree, size_t count, f64 * const * roots);
+
+/*****************************************************************************/
+} // End of namespace dnr.
+
+#endif // _POLYNOMIAL_ROOTS_H.
@@ -0,0 +1,137 @@
+/*
+ * render_driver.cpp
+ * Bezier
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+
+#include "render_driver.h"
+#include <sys/time.h>
+
+/*****************************************************************************/
+
+/**
+ * Get the current time, in seconds.
+**/
+static f64 current_time() {
+	timeval tv;
+	gettimeofday(&tv, 0);
+	return f64(tv.tv_sec) + f64(tv.tv_usec) * 1.0e-6;
+}
+
+render_driver::render_driver(bezier_backend& backend, u32 width, u32 height)
+		: m_backend(backend)
+		, m_surface(0)
+		, m_width(width)
+		, m_height(height)
+		, m_full_redraw(true)
+		, m_frame_time(0.0)
+		, m_frame_count(0) {
+	create_surface();
+}
+
+render_driver::~render_driver() {
+	cairo_surface_destroy(m_surface);
+}
+
+void render_driver::resize(u32 width, u32 height) {
+	if (width == m_width && height == m_height) return;
+	
+	m_width = width;
+	m_height = height;
+	
+	cairo_surface_destroy(m_surface);
+	create_surface();
+	m_full_redraw = true;
+}
+
+bool render_driver::render_frame() {
+	m_frame_region.deactivate();
+	
+	if (!m_full_redraw && !m_backend.needs_redraw()) return false;
+	
+	// Put the damaged region in pixels, rounded out to whole pixels so that
+	// the clip does not antialias its edges.
+	const vector2dd offset(0.5 * m_width, 0.5 * m_height);
+	aabboxd region(0.0, 0.0, m_width, m_height);
+	
+	if (!m_full_redraw) {
+		const aabboxd& damage = m_backend.damage();
+		if (!damage.active) {
+			// Nothing visible changed.
+			m_backend.clear_damage();
+			return false;
+		}
+		
+		const vector2dd top_left = damage.origin + offset;
+		const vector2dd bottom_right = top_left + damage.extent;
+		
+		const f64 left = max_(floor(top_left.x), 0.0);
+		const f64 top = max_(floor(top_left.y), 0.0);
+		const f64 right = min_(ceil(bottom_right.x), f64(m_width));
+		const f64 bottom = min_(ceil(bottom_right.y), f64(m_height));
+		
+		if (left >= right || top >= bottom) {
+			// Changed entirely outside of the view.
+			m_backend.clear_damage();
+			return false;
+		}
+		
+		region = aabboxd(left, top, right - left, bottom - top);
+	}
+	
+	const f64 start = current_time();
+	
+	cairo_t * context = cairo_create(m_surface);
+	cairo_rectangle(context, region.origin.x, region.origin.y, region.extent.x, region.extent.y);
+	cairo_clip(context);
+	
+	// Draw in view coordinates.
+	cairo_translate(context, offset.x, offset.y);
+	m_backend.render(context, vector2dd(m_width, m_height));
+	
+	cairo_destroy(context);
+	cairo_surface_flush(m_surface);
+	
+	m_frame_time = current_time() - start;
+	m_frame_region = region;
+	m_full_redraw = false;
+	++m_frame_count;
+	
+	return true;
+}
+
+bool render_driver::write_png(const char * filename) const {
+#if CAIRO_HAS_PNG_FUNCTIONS
+	return cairo_surface_write_to_png(m_surface, filename) == CAIRO_STATUS_SUCCESS;
+#else
+	(void) filename;
+	return false;
+#endif
+}
+
+/**
+ * Create m_surface at the current size.
+**/
+void render_driver::create_surface() {
+	m_surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, m_width, m_height);
+}
+
+/*****************************************************************************/
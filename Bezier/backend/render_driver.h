@@ -0,0 +1,123 @@
+/*
+ * render_driver.h
+ * Bezier
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+
+#ifndef _RENDER_DRIVER_H
+#define _RENDER_DRIVER_H
+
+#include <cairo/cairo.h>
+#include "bezier_backend.h"
+
+/*****************************************************************************/
+
+/**
+ * Renders a bezier_backend into an image surface, without a window system.
+ * 
+ * The view origin is at the center of the surface, as in CairoView.  After
+ * the first frame only the region the backend reports as damaged is
+ * repainted, with everything else left from the previous frame.
+**/
+class render_driver {
+public:
+	/**
+	 * Create a driver with an ARGB32 surface of the given size.
+	**/
+	render_driver(bezier_backend& backend, u32 width, u32 height);
+	~render_driver();
+	
+	/**
+	 * Resize the surface, which repaints all of it on the next frame.
+	**/
+	void resize(u32 width, u32 height);
+	
+	/**
+	 * Repaint all of the surface on the next frame.
+	**/
+	void invalidate() { m_full_redraw = true; }
+	
+	/**
+	 * Render a frame if anything has changed.
+	 * 
+	 * @return	true if anything was repainted.
+	**/
+	bool render_frame();
+	
+	/**
+	 * Write the surface to a PNG file.
+	 * 
+	 * @return	true on success, always false if cairo was built without PNG
+	 * 			support.
+	**/
+	bool write_png(const char * filename) const;
+	
+	/*************************************************************************/
+	// Accessors.
+	
+	/**
+	 * Get the surface rendered to.
+	**/
+	cairo_surface_t * surface() const { return m_surface; }
+	
+	u32 width() const { return m_width; }
+	u32 height() const { return m_height; }
+	
+	/**
+	 * Get the time the last repaint took, in seconds.
+	**/
+	f64 frame_time() const { return m_frame_time; }
+	
+	/**
+	 * Get the region repainted by the last frame, in pixels.  Inactive if the
+	 * last call to render_frame() repainted nothing.
+	**/
+	const aabboxd& frame_region() const { return m_frame_region; }
+	
+	/**
+	 * Get the number of frames repainted.
+	**/
+	u32 frame_count() const { return m_frame_count; }
+	
+private:
+	bezier_backend& m_backend;
+	cairo_surface_t * m_surface;
+	u32 m_width;
+	u32 m_height;
+	bool m_full_redraw;
+	
+	f64 m_frame_time;
+	aabboxd m_frame_region;
+	u32 m_frame_count;
+	
+	/**
+	 * Create m_surface at the current size.
+	**/
+	void create_surface();
+	
+	// Not copyable.
+	render_driver(const render_driver&);
+	render_driver& operator=(const render_driver&);
+};
+
+/*****************************************************************************/
+
+#endif // _RENDER_DRIVER_H.
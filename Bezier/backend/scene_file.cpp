@@ -0,0 +1,458 @@
+/*
+ * scene_file.cpp
+ * Bezier
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+
+#include "scene_file.h"
+#include <cstring>
+#include <string>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#include <cstdlib>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace dnr {
+/*****************************************************************************/
+
+static const c8 k_magic[4] = { 'B', 'Z', 'S', 'C' };
+
+/// Value of scene_writer::m_file once the file is closed.
+#if defined(_WIN32)
+static FILE * const k_no_file = 0;
+#else
+static const int k_no_file = -1;
+#endif
+
+/**
+ * Round a file offset up to the start of the next block.
+**/
+static inline u64 align_block(u64 offset) {
+	return (offset + scene_header::k_alignment - 1) & ~u64(scene_header::k_alignment - 1);
+}
+
+/**
+ * Get the number of segments in a path of count points.
+**/
+static inline u64 path_segments(u64 count) {
+	return count < 4 ? 0 : (count - 1) / 3;
+}
+
+/**
+ * Copy a box field by field over zeroed memory, so that the padding written
+ * to the file is deterministic.
+**/
+static inline void copy_box(const aabboxd& box, aabboxd& out) {
+	memset(static_cast<void *>(&out), 0, sizeof(out));
+	out.origin = box.origin;
+	out.extent = box.extent;
+	out.active = box.active;
+}
+
+/*****************************************************************************/
+// scene_writer.
+
+scene_writer::scene_writer(const char * filename, u64 path_count, u64 point_count, u32 flags)
+		: m_file(k_no_file)
+		, m_paths_written(0)
+		, m_points_written(0) {
+	if (flags & ~u32(scene_header::k_has_bounds)) throw std::logic_error("only k_has_bounds may be requested");
+	
+	// Everything but the magic, which finish() adds once the file is whole.
+	memset(&m_header, 0, sizeof(m_header));
+	m_header.version = scene_header::k_version;
+	m_header.byte_order = scene_header::k_byte_order;
+	m_header.flags = flags;
+	m_header.box_size = sizeof(aabboxd);
+	m_header.node_size = sizeof(bvh::node);
+	m_header.path_count = path_count;
+	m_header.point_count = point_count;
+	
+	// The declared sizes fix where each block starts.  The bounds are the
+	// last streamed block, so the segment count is not needed yet.
+	m_header.paths_offset = align_block(sizeof(scene_header));
+	m_header.x_offset = align_block(m_header.paths_offset + path_count * sizeof(scene_path));
+	m_header.y_offset = align_block(m_header.x_offset + point_count * sizeof(f64));
+	
+	if (flags & scene_header::k_has_bounds) {
+		m_header.bounds_offset = align_block(m_header.y_offset + point_count * sizeof(f64));
+	}
+	
+	m_paths.offset = m_header.paths_offset;
+	m_x.offset = m_header.x_offset;
+	m_y.offset = m_header.y_offset;
+	m_bounds.offset = m_header.bounds_offset;
+	
+#if defined(_WIN32)
+	m_file = fopen(filename, "wb");
+	if (!m_file) throw std::runtime_error(std::string("cannot create scene file ") + filename);
+#else
+	m_file = ::open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (m_file < 0) throw std::runtime_error(std::string("cannot create scene file ") + filename);
+#endif
+	
+	// Reserve the header with zeros, an unfinished file has no magic.
+	write_at(0, &m_header, sizeof(m_header));
+}
+
+scene_writer::~scene_writer() {
+	if (!is_open()) return;
+	
+#if defined(_WIN32)
+	fclose(m_file);
+#else
+	::close(m_file);
+#endif
+}
+
+bool scene_writer::is_open() const {
+	return m_file != k_no_file;
+}
+
+void scene_writer::append(const cubic_spline& path) {
+	append(path.points(), path.point_count());
+}
+
+void scene_writer::append(const cubic_bezier& curve) {
+	const vector2dd points[4] = { curve.origin, curve.control_1, curve.control_2, curve.endpoint };
+	append(points, 4);
+}
+
+void scene_writer::append(const vector2dd * points, size_t count) {
+	if (!is_open()) throw std::logic_error("scene file is already finished");
+	if (m_paths_written == m_header.path_count || count > m_header.point_count - m_points_written) {
+		throw std::logic_error("more paths or points than declared");
+	}
+	
+	scene_path record;
+	record.first_point = m_points_written;
+	record.point_count = count;
+	record.first_segment = m_header.segment_count;
+	write(m_paths, &record, sizeof(record));
+	
+	for (size_t i = 0; i < count; ++i) {
+		write(m_x, &points[i].x, sizeof(f64));
+		write(m_y, &points[i].y, sizeof(f64));
+	}
+	
+	const u64 segments = path_segments(count);
+	
+	if (segments && (m_header.flags & scene_header::k_has_bounds)) {
+		m_segment_bounds.resize(size_t(segments));
+		bounds_batch(points, 3, size_t(segments), &m_segment_bounds[0]);
+		
+		for (size_t i = 0; i < segments; ++i) {
+			aabboxd box;
+			copy_box(m_segment_bounds[i], box);
+			write(m_bounds, &box, sizeof(box));
+		}
+	}
+	
+	m_header.segment_count += segments;
+	m_points_written += count;
+	++m_paths_written;
+}
+
+void scene_writer::finish(const bvh * tree) {
+	if (!is_open()) throw std::logic_error("scene file is already finished");
+	if (m_paths_written != m_header.path_count || m_points_written != m_header.point_count) {
+		throw std::logic_error("fewer paths or points than declared");
+	}
+	
+	flush(m_paths);
+	flush(m_x);
+	flush(m_y);
+	flush(m_bounds);
+	
+	u64 end = m_header.y_offset + m_header.point_count * sizeof(f64);
+	if (m_header.flags & scene_header::k_has_bounds) {
+		end = m_header.bounds_offset + m_header.segment_count * sizeof(aabboxd);
+	}
+	
+	if (tree) {
+		if (!(m_header.flags & scene_header::k_has_bounds)) throw std::logic_error("a stored bvh requires k_has_bounds");
+		if (tree->size() != m_header.segment_count) throw std::logic_error("bvh items do not match the segments");
+		
+		const std::vector<bvh::node>& nodes = tree->nodes();
+		const std::vector<u32>& items = tree->items();
+		
+		m_header.flags |= scene_header::k_has_bvh;
+		m_header.node_count = nodes.size();
+		m_header.nodes_offset = align_block(end);
+		m_header.items_offset = align_block(m_header.nodes_offset + nodes.size() * sizeof(bvh::node));
+		
+		// The streamed blocks are done, reuse a stream for each of these.
+		stream& out = m_paths;
+		out.offset = m_header.nodes_offset;
+		
+		for (size_t i = 0; i < nodes.size(); ++i) {
+			bvh::node node;
+			memset(static_cast<void *>(&node), 0, sizeof(node));
+			copy_box(nodes[i].box, node.box);
+			node.first = nodes[i].first;
+			node.count = nodes[i].count;
+			node.parent = nodes[i].parent;
+			write(out, &node, sizeof(node));
+		}
+		
+		flush(out);
+		
+		out.offset = m_header.items_offset;
+		if (!items.empty()) write(out, &items[0], items.size() * sizeof(u32));
+		flush(out);
+		
+		end = m_header.items_offset + items.size() * sizeof(u32);
+	}
+	
+	// Empty trailing blocks are never written, extend the file to cover them.
+	m_header.file_size = end;
+	
+#if defined(_WIN32)
+	if (fflush(m_file) != 0 || _chsize_s(_fileno(m_file), s64(end)) != 0) throw std::runtime_error("cannot resize scene file");
+#else
+	if (ftruncate(m_file, off_t(end)) != 0) throw std::runtime_error("cannot resize scene file");
+#endif
+	
+	memcpy(m_header.magic, k_magic, sizeof(k_magic));
+	write_at(0, &m_header, sizeof(m_header));
+	
+#if defined(_WIN32)
+	FILE * file = m_file;
+	m_file = k_no_file;
+	if (fclose(file) != 0) throw std::runtime_error("cannot close scene file");
+#else
+	const int file = m_file;
+	m_file = k_no_file;
+	if (::close(file) != 0) throw std::runtime_error("cannot close scene file");
+#endif
+}
+
+void scene_writer::write(stream& s, const void * data, size_t size) {
+	const u8 * bytes = static_cast<const u8 *>(data);
+	s.buffer.insert(s.buffer.end(), bytes, bytes + size);
+	
+	if (s.buffer.size() >= k_buffer_size) flush(s);
+}
+
+void scene_writer::flush(stream& s) {
+	if (s.buffer.empty()) return;
+	
+	write_at(s.offset, &s.buffer[0], s.buffer.size());
+	s.offset += s.buffer.size();
+	s.buffer.clear();
+}
+
+void scene_writer::write_at(u64 offset, const void * data, size_t size) {
+#if defined(_WIN32)
+	if (_fseeki64(m_file, s64(offset), SEEK_SET) != 0 || fwrite(data, 1, size, m_file) != size) {
+		throw std::runtime_error("cannot write scene file");
+	}
+#else
+	const u8 * bytes = static_cast<const u8 *>(data);
+	
+	while (size) {
+		const ssize_t written = pwrite(m_file, bytes, size, off_t(offset));
+		if (written <= 0) throw std::runtime_error("cannot write scene file");
+		
+		bytes += written;
+		offset += u64(written);
+		size -= size_t(written);
+	}
+#endif
+}
+
+/*****************************************************************************/
+// scene_file.
+
+/**
+ * Check that a block of count elements at offset lies within the file.
+**/
+static bool valid_block(const scene_header& header, u64 offset, u64 count, u64 element_size) {
+	if (offset < sizeof(scene_header) || offset % scene_header::k_alignment != 0) return false;
+	if (offset > header.file_size) return false;
+	
+	return count <= (header.file_size - offset) / element_size;
+}
+
+/**
+ * Check a header against the size of its file.
+**/
+static bool valid_header(const scene_header& header, size_t size) {
+	if (memcmp(header.magic, k_magic, sizeof(k_magic)) != 0) return false;
+	if (header.version != scene_header::k_version || header.byte_order != scene_header::k_byte_order) return false;
+	if (header.box_size != sizeof(aabboxd) || header.node_size != sizeof(bvh::node)) return false;
+	if (header.file_size != size) return false;
+	
+	const u32 known = scene_header::k_has_bounds | scene_header::k_has_bvh;
+	if (header.flags & ~known) return false;
+	
+	if (!valid_block(header, header.paths_offset, header.path_count, sizeof(scene_path))) return false;
+	if (!valid_block(header, header.x_offset, header.point_count, sizeof(f64))) return false;
+	if (!valid_block(header, header.y_offset, header.point_count, sizeof(f64))) return false;
+	if (header.segment_count > header.point_count / 3) return false;
+	
+	if (header.flags & scene_header::k_has_bounds) {
+		if (!valid_block(header, header.bounds_offset, header.segment_count, sizeof(aabboxd))) return false;
+	} else if (header.bounds_offset) {
+		return false;
+	}
+	
+	if (header.flags & scene_header::k_has_bvh) {
+		if (!(header.flags & scene_header::k_has_bounds)) return false;
+		if (!valid_block(header, header.nodes_offset, header.node_count, sizeof(bvh::node))) return false;
+		if (!valid_block(header, header.items_offset, header.segment_count, sizeof(u32))) return false;
+	} else if (header.nodes_offset || header.items_offset || header.node_count) {
+		return false;
+	}
+	
+	return true;
+}
+
+void scene_file::open(const char * filename) {
+	close();
+	
+#if defined(_WIN32)
+	FILE * file = fopen(filename, "rb");
+	if (!file) throw std::runtime_error(std::string("cannot open scene file ") + filename);
+	
+	s64 length = -1;
+	if (_fseeki64(file, 0, SEEK_END) == 0) length = _ftelli64(file);
+	
+	if (length < s64(sizeof(scene_header)) || _fseeki64(file, 0, SEEK_SET) != 0) {
+		fclose(file);
+		throw std::runtime_error(std::string("not a scene file: ") + filename);
+	}
+	
+	// Read the whole file, malloc aligns it at least as well as an f64.
+	const size_t size = size_t(length);
+	void * data = malloc(size);
+	const bool read = data && fread(data, 1, size, file) == size;
+	fclose(file);
+	
+	if (!read) {
+		free(data);
+		throw std::runtime_error(std::string("cannot read scene file ") + filename);
+	}
+#else
+	const int file = ::open(filename, O_RDONLY);
+	if (file < 0) throw std::runtime_error(std::string("cannot open scene file ") + filename);
+	
+	struct stat info;
+	if (fstat(file, &info) != 0 || info.st_size < off_t(sizeof(scene_header))) {
+		::close(file);
+		throw std::runtime_error(std::string("not a scene file: ") + filename);
+	}
+	
+	const size_t size = size_t(info.st_size);
+	void * data = mmap(0, size, PROT_READ, MAP_PRIVATE, file, 0);
+	::close(file); // The mapping keeps the file alive.
+	
+	if (data == MAP_FAILED) throw std::runtime_error(std::string("cannot map scene file ") + filename);
+#endif
+	
+	m_data = static_cast<const u8 *>(data);
+	m_size = size;
+	
+	if (!valid_header(header(), m_size)) {
+		close();
+		throw std::runtime_error(std::string("not a scene file: ") + filename);
+	}
+}
+
+void scene_file::close() {
+#if defined(_WIN32)
+	free(const_cast<u8 *>(m_data));
+#else
+	if (m_data) munmap(const_cast<u8 *>(m_data), m_size);
+#endif
+	
+	m_data = 0;
+	m_size = 0;
+}
+
+const scene_path& scene_file::checked_path(size_t idx) const {
+	if (idx >= path_count()) throw std::out_of_range("invalid path");
+	
+	const scene_header& h = header();
+	const scene_path& record = paths()[idx];
+	
+	const bool valid = record.first_point <= h.point_count
+		&& record.point_count <= h.point_count - record.first_point
+		&& (record.point_count == 0 || (record.point_count - 1) % 3 == 0)
+		&& record.first_segment <= h.segment_count
+		&& path_segments(record.point_count) <= h.segment_count - record.first_segment;
+	
+	if (!valid) throw std::out_of_range("invalid path record");
+	return record;
+}
+
+cubic_spline scene_file::path(size_t idx) const {
+	const scene_path& record = checked_path(idx);
+	cubic_spline path;
+	if (record.point_count == 0) return path;
+	
+	const f64 * px = x() + record.first_point;
+	const f64 * py = y() + record.first_point;
+	
+	path.reserve(size_t(path_segments(record.point_count)));
+	path.move_to(vector2dd(px[0], py[0]));
+	
+	for (size_t i = 1; i < record.point_count; i += 3) {
+		path.append(vector2dd(px[i], py[i]), vector2dd(px[i + 1], py[i + 1]), vector2dd(px[i + 2], py[i + 2]));
+	}
+	
+	return path;
+}
+
+cubic_bezier scene_file::segment(size_t path_idx, size_t segment_idx) const {
+	const scene_path& record = checked_path(path_idx);
+	if (segment_idx >= path_segments(record.point_count)) throw std::out_of_range("invalid segment");
+	
+	const size_t first = size_t(record.first_point) + 3 * segment_idx;
+	const f64 * px = x() + first;
+	const f64 * py = y() + first;
+	
+	return cubic_bezier(
+		vector2dd(px[0], py[0]),
+		vector2dd(px[1], py[1]),
+		vector2dd(px[2], py[2]),
+		vector2dd(px[3], py[3])
+	);
+}
+
+void scene_file::load_bvh(bvh& tree) const {
+	if (!(header().flags & scene_header::k_has_bvh)) {
+		tree.clear();
+		return;
+	}
+	
+	tree.assign(nodes(), node_count(), items(), bounds(), segment_count());
+}
+
+/*****************************************************************************/
+} // End of namespace dnr.
@@ -0,0 +1,319 @@
+/*
+ * scene_file.h
+ * Bezier
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+
+#ifndef _SCENE_FILE_H
+#define _SCENE_FILE_H
+
+#include <cstdio>
+#include <vector>
+#include "cubic_spline.h"
+#include "bvh.h"
+
+namespace dnr {
+/*****************************************************************************/
+
+/**
+ * Header at the start of a scene file.
+ * 
+ * A scene is a list of paths stored so that the file can be mapped into
+ * memory and used in place.  Every block starts at a multiple of
+ * k_alignment, in this order:
+ * 
+ * - path_count scene_path records.
+ * - point_count x-coordinates, then point_count y-coordinates, as f64.  The
+ *   points of each path are contiguous and laid out like cubic_spline, with
+ *   neighboring segments sharing their anchor.
+ * - With k_has_bounds, segment_count aabboxd, the bounds of every segment
+ *   in path order.
+ * - With k_has_bvh, node_count bvh::node followed by segment_count u32
+ *   item indices, a bvh over the segment bounds.
+ * 
+ * Values are stored in the byte order and struct layout of the machine that
+ * wrote the file, the header records both so that a mismatch is detected
+ * instead of misread.
+**/
+struct scene_header {
+	/// Version of the layout described above.
+	static const u32 k_version = 1;
+	
+	/// Written as a u32, reads differently on a machine of the other byte order.
+	static const u32 k_byte_order = 0x01020304;
+	
+	/// Alignment of every block, in bytes.
+	static const u32 k_alignment = 64;
+	
+	/// Flags for the optional blocks.
+	enum {
+		k_has_bounds	= 1 << 0,	///< Segment bounds are stored.
+		k_has_bvh		= 1 << 1	///< A bvh over the segment bounds is stored.
+	};
+	
+	c8 magic[4];		/// "BZSC".
+	u32 version;		/// k_version.
+	u32 byte_order;		/// k_byte_order.
+	u32 flags;			/// Combination of k_has_bounds and k_has_bvh.
+	u32 box_size;		/// sizeof(aabboxd) of the writer.
+	u32 node_size;		/// sizeof(bvh::node) of the writer.
+	
+	u64 path_count;
+	u64 point_count;
+	u64 segment_count;
+	u64 node_count;
+	
+	/// Byte offsets of the blocks, 0 for a block that is not stored.
+	u64 paths_offset;
+	u64 x_offset;
+	u64 y_offset;
+	u64 bounds_offset;
+	u64 nodes_offset;
+	u64 items_offset;
+	
+	u64 file_size;		/// Total size of the file, in bytes.
+};
+
+/**
+ * Location of one path within the blocks of a scene file.
+**/
+struct scene_path {
+	u64 first_point;	/// Index of the path's first point in the x and y blocks.
+	u64 point_count;	/// Number of points, 3 * segments + 1 or 0 for an empty path.
+	u64 first_segment;	/// Index of the path's first segment in the bounds block.
+};
+
+/*****************************************************************************/
+
+/**
+ * Writes a scene file one path at a time.
+ * 
+ * The size of the scene must be known up front, which fixes where every
+ * block starts, but the paths themselves are streamed: each block is staged
+ * in a small buffer and written at its own offset when the buffer fills, so
+ * memory use does not grow with the scene.  The header is written last by
+ * finish(), a file that was never finished is rejected by scene_file.
+ * 
+ * Errors throw std::runtime_error for I/O failures and std::logic_error for
+ * misuse, such as appending more points than were declared.
+**/
+class scene_writer {
+public:
+	/**
+	 * Create a scene file, replacing any existing file.
+	 * 
+	 * @param	filename	File to write.
+	 * @param	path_count	Number of paths that will be appended.
+	 * @param	point_count	Total number of points in those paths.
+	 * @param	flags		scene_header::k_has_bounds to store the bounds of
+	 * 						every segment.
+	**/
+	scene_writer(const char * filename, u64 path_count, u64 point_count, u32 flags = scene_header::k_has_bounds);
+	
+	/**
+	 * Close the file, which is left incomplete if finish() was not called.
+	**/
+	~scene_writer();
+	
+	/**
+	 * Append a path.
+	**/
+	void append(const cubic_spline& path);
+	
+	/**
+	 * Append a path of one segment.
+	**/
+	void append(const cubic_bezier& curve);
+	
+	/**
+	 * Write the remaining blocks and the header, and close the file.
+	 * 
+	 * @param	tree	Optional bvh over the segment bounds, with one item per
+	 * 					segment in path order.  Requires k_has_bounds.
+	**/
+	void finish(const bvh * tree = 0);
+	
+	/**
+	 * Get the number of segments appended so far.
+	**/
+	u64 segment_count() const { return m_header.segment_count; }
+	
+private:
+	/// Size of the staging buffer of each block, in bytes.
+	static const size_t k_buffer_size = 64 * 1024;
+	
+	/**
+	 * A block being written sequentially from a fixed file offset.
+	**/
+	struct stream {
+		u64 offset; // File offset of the next byte to write.
+		std::vector<u8> buffer;
+		
+		stream() : offset(0) { }
+	};
+	
+#if defined(_WIN32)
+	FILE * m_file; // There is no pwrite, blocks are written with fseek and fwrite.
+#else
+	int m_file;
+#endif
+	scene_header m_header;
+	u64 m_paths_written;
+	u64 m_points_written;
+	
+	stream m_paths;
+	stream m_x;
+	stream m_y;
+	stream m_bounds;
+	
+	std::vector<aabboxd> m_segment_bounds; // Scratch space for append().
+	
+	/**
+	 * Append the points of one path, see cubic_spline for the layout.
+	**/
+	void append(const vector2dd * points, size_t count);
+	
+	/// Is the file still being written, before finish()?
+	bool is_open() const;
+	
+	void write(stream& s, const void * data, size_t size);
+	void flush(stream& s);
+	void write_at(u64 offset, const void * data, size_t size);
+	
+	// Not copyable.
+	scene_writer(const scene_writer&);
+	scene_writer& operator=(const scene_writer&);
+};
+
+/*****************************************************************************/
+
+/**
+ * A scene file mapped into memory.
+ * 
+ * Opening only checks the header and maps the file, the blocks are used in
+ * place without being parsed or copied, so opening a large scene costs the
+ * same as opening a small one until its pages are touched.  The accessors
+ * that return pointers refer to the mapping and stay valid until close().
+ * 
+ * On Windows the file is read into memory instead of mapped.
+ * 
+ * Errors throw std::runtime_error when a file cannot be opened or is not a
+ * valid scene, and std::out_of_range for an index outside the scene or a
+ * path record that points outside its blocks.
+**/
+class scene_file {
+public:
+	scene_file() : m_data(0), m_size(0) { }
+	
+	explicit scene_file(const char * filename) : m_data(0), m_size(0) {
+		open(filename);
+	}
+	
+	~scene_file() { close(); }
+	
+	/**
+	 * Map a scene file, closing any file already open.
+	**/
+	void open(const char * filename);
+	
+	/**
+	 * Unmap the file.
+	**/
+	void close();
+	
+	/**
+	 * Is a file open?
+	**/
+	bool is_open() const { return m_data != 0; }
+	
+	/*************************************************************************/
+	// Blocks.
+	
+	const scene_header& header() const {
+		if (!m_data) throw std::logic_error("scene file is not open");
+		return *reinterpret_cast<const scene_header *>(m_data);
+	}
+	
+	size_t path_count() const { return size_t(header().path_count); }
+	size_t point_count() const { return size_t(header().point_count); }
+	size_t segment_count() const { return size_t(header().segment_count); }
+	
+	/// Path records.
+	const scene_path * paths() const { return block<scene_path>(header().paths_offset); }
+	
+	/// Coordinates of every point.
+	const f64 * x() const { return block<f64>(header().x_offset); }
+	const f64 * y() const { return block<f64>(header().y_offset); }
+	
+	/// Bounds of every segment, or 0 if they were not stored.
+	const aabboxd * bounds() const { return block<aabboxd>(header().bounds_offset); }
+	
+	/// Nodes and items of the stored bvh, or 0 if there is none.
+	size_t node_count() const { return size_t(header().node_count); }
+	const bvh::node * nodes() const { return block<bvh::node>(header().nodes_offset); }
+	const u32 * items() const { return block<u32>(header().items_offset); }
+	
+	/*************************************************************************/
+	// Copying out.
+	
+	/**
+	 * Get a copy of a path.
+	**/
+	cubic_spline path(size_t idx) const;
+	
+	/**
+	 * Get a copy of one segment of a path.
+	**/
+	cubic_bezier segment(size_t path_idx, size_t segment_idx) const;
+	
+	/**
+	 * Load the stored bvh into a tree, which is faster than building it
+	 * again from bounds().  Clears the tree if the file has none.
+	**/
+	void load_bvh(bvh& tree) const;
+	
+private:
+	const u8 * m_data;
+	size_t m_size;
+	
+	/**
+	 * Get a block by its offset, 0 for a missing block.
+	**/
+	template <typename T>
+	const T * block(u64 offset) const {
+		if (!m_data) throw std::logic_error("scene file is not open");
+		return offset ? reinterpret_cast<const T *>(m_data + offset) : 0;
+	}
+	
+	/**
+	 * Get the record of a path, checked against the point block.
+	**/
+	const scene_path& checked_path(size_t idx) const;
+	
+	// Not copyable.
+	scene_file(const scene_file&);
+	scene_file& operator=(const scene_file&);
+};
+
+/*****************************************************************************/
+} // End of namespace dnr.
+
+#endif // _SCENE_FILE_H.
@@ -0,0 +1,63 @@
+/*
+ * spline_index.cpp
+ * Bezier
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+#include "spline_index.h"
+
+namespace dnr {
+/*****************************************************************************/
+
+void spline_index::build(const cubic_spline& spline) {
+	std::vector<aabboxd> boxes(spline.point_count());
+	
+	for (size_t i = 0; i < boxes.size(); ++i) {
+		boxes[i].reset(spline.point(i));
+	}
+	
+	m_points.build(boxes.empty() ? 0 : &boxes[0], boxes.size());
+	
+	boxes.resize(spline.size());
+	if (!boxes.empty()) spline.segment_bounds(&boxes[0]);
+	
+	m_segments.build(boxes.empty() ? 0 : &boxes[0], boxes.size());
+}
+
+void spline_index::point_moved(const cubic_spline& spline, size_t point_idx) {
+	aabboxd box;
+	box.reset(spline.point(point_idx));
+	m_points.refit(u32(point_idx), box);
+	
+	// Anchors at 3i are shared by segments i - 1 and i, control points
+	// belong to segment i / 3 only.
+	const size_t segments = spline.size();
+	size_t first = point_idx / 3;
+	size_t last = first;
+	if (point_idx % 3 == 0 && first > 0) --first;
+	
+	for (size_t i = first; i <= last && i < segments; ++i) {
+		bounds_batch(spline.points() + 3 * i, 3, 1, &box);
+		m_segments.refit(u32(i), box);
+	}
+}
+
+/*****************************************************************************/
+} // End of namespace dnr.
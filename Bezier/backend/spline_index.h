@@ -0,0 +1,99 @@
+/*
+ * spline_index.h
+ * Bezier
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+#ifndef _SPLINE_INDEX_H
+#define _SPLINE_INDEX_H
+
+#include "bvh.h"
+#include "cubic_spline.h"
+
+namespace dnr {
+/*****************************************************************************/
+
+/**
+ * Spatial index over the control points and segments of a cubic_spline,
+ * for picking and selection.
+ * 
+ * Points and segments are identified by their index in the spline.  The
+ * index does not track the spline, call point_moved() after moving a point
+ * and build() after adding or removing segments.
+**/
+class spline_index {
+public:
+	spline_index() { }
+	
+	/**
+	 * Build the index from scratch.
+	**/
+	void build(const cubic_spline& spline);
+	
+	/**
+	 * Refit after a control point has moved, updating the point and the one
+	 * or two segments that use it.
+	**/
+	void point_moved(const cubic_spline& spline, size_t point_idx);
+	
+	/**
+	 * Find the control point nearest to pt.
+	 * 
+	 * @return	Point index, or bvh::k_invalid if none is within radius.
+	**/
+	u32 nearest_point(const vector2dd& pt, f64 radius) const {
+		return m_points.nearest(pt, radius);
+	}
+	
+	/**
+	 * Find the segments whose bounding box is within radius of pt.  These
+	 * are the candidates for a hit test against the curve itself.
+	**/
+	void pick_segments(const vector2dd& pt, f64 radius, std::vector<u32>& out) const {
+		m_segments.query_point(pt, radius, out);
+	}
+	
+	/**
+	 * Find the control points inside a rectangle.
+	**/
+	void select_points(const aabboxd& rect, std::vector<u32>& out) const {
+		m_points.query_rect(rect, out);
+	}
+	
+	/**
+	 * Find the segments whose bounding box overlaps a rectangle.
+	**/
+	void select_segments(const aabboxd& rect, std::vector<u32>& out) const {
+		m_segments.query_rect(rect, out);
+	}
+	
+	/// Access the underlying trees.
+	const bvh& points() const { return m_points; }
+	const bvh& segments() const { return m_segments; }
+	
+private:
+	bvh m_points;
+	bvh m_segments;
+};
+
+/*****************************************************************************/
+} // End of namespace dnr.
+
+#endif // _SPLINE_INDEX_H.
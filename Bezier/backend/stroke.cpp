@@ -0,0 +1,463 @@
+/*
+ * stroke.cpp
+ * Bezier
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+#include <algorithm>
+#include "stroke.h"
+
+namespace dnr {
+/*****************************************************************************/
+
+/// Halving limit when fitting a piece of an offset, 1024 pieces at most.
+static const u32 k_max_offset_depth = 10;
+
+/// Split points closer than this in t are merged.
+static const f64 k_min_piece = 1e-9;
+
+/// Positions in each piece where the fit is checked against the exact offset.
+static const f64 k_samples[3] = { 0.25, 0.5, 0.75 };
+
+/*****************************************************************************/
+
+static inline f64 cross(const vector2dd& a, const vector2dd& b) {
+	return a.x * b.y - a.y * b.x;
+}
+
+/// The vector turned 90 degrees to the left, (x, y) to (-y, x).
+static inline vector2dd left_normal(const vector2dd& v) {
+	return vector2dd(-v.y, v.x);
+}
+
+static inline const vector2dd& last_point(const cubic_spline& out) {
+	return out.point(out.point_count() - 1);
+}
+
+/**
+ * Append a straight line from the end of out, as a cubic.
+**/
+static inline void append_line(cubic_spline& out, const vector2dd& to) {
+	const vector2dd from = last_point(out);
+	const vector2dd third = (to - from) / 3.0;
+	out.append(from + third, to - third, to);
+}
+
+/**
+ * Append a circular arc around center from the end of out to end, which must
+ * be at the same radius.  The arc is split into pieces of at most 90 degrees,
+ * each with handles of length 4/3 tan(angle / 4) times the radius.
+ * 
+ * @param	sweep	Signed angle to sweep in radians, positive turns from +x
+ * 					towards +y.
+**/
+static void append_arc(cubic_spline& out, const vector2dd& center, const vector2dd& end, f64 sweep) {
+	const u32 pieces = max_(u32(1), u32(ceil(abs_(sweep) / (0.5 * PI64))));
+	const f64 step = sweep / f64(pieces);
+	const f64 handle = 4.0 / 3.0 * tan(0.25 * step);
+	
+	const vector2dd start = last_point(out) - center;
+	vector2dd from = start;
+	
+	for (u32 i = 1; i <= pieces; ++i) {
+		vector2dd to = start;
+		to.rotate_rad(step * f64(i));
+		if (i == pieces) to = end - center;
+		
+		out.append(center + from + handle * left_normal(from), center + to - handle * left_normal(to), center + to);
+		from = to;
+	}
+}
+
+/**
+ * Connect the offset of one piece of a path, which out ends on, to the offset
+ * of the next, around the joint where they meet.
+ * 
+ * @param	point		Point on the path where the pieces meet.
+ * @param	in_dir		Unit tangent at the end of the first piece.
+ * @param	out_dir		Unit tangent at the start of the next piece.
+**/
+static void append_join(cubic_spline& out, const vector2dd& point, const vector2dd& in_dir, const vector2dd& out_dir, f64 distance, stroke_style::join_style join, f64 miter_limit) {
+	const vector2dd from = last_point(out);
+	const vector2dd to = point + distance * left_normal(out_dir);
+	if (from.x == to.x && from.y == to.y) return;
+	
+	const f64 turn = cross(in_dir, out_dir);
+	const f64 cos_turn = in_dir.dot_product(out_dir);
+	
+	// Nearly straight, the offsets already meet.
+	if (iszero(turn) && cos_turn > 0.0) {
+		append_line(out, to);
+		return;
+	}
+	
+	// The path turns towards this side, connect through the joint.
+	if (turn * distance > 0.0) {
+		append_line(out, point);
+		append_line(out, to);
+		return;
+	}
+	
+	switch (join) {
+		case stroke_style::k_join_round: {
+			// Around the outside, which turns the same way as the path.
+			const f64 angle = atan2(abs_(turn), cos_turn);
+			append_arc(out, point, to, distance > 0.0 ? -angle : angle);
+			break;
+		}
+		
+		case stroke_style::k_join_miter: {
+			/* The miter is 1 / cos(angle / 2) times the width, and
+			 * cos^2(angle / 2) = (1 + cos(angle)) / 2.
+			**/
+			if (2.0 < miter_limit * miter_limit * (1.0 + cos_turn)) {
+				const vector2dd tip = point + distance * (left_normal(in_dir) + left_normal(out_dir)) / (1.0 + cos_turn);
+				append_line(out, tip);
+			}
+			
+			append_line(out, to);
+			break;
+		}
+		
+		case stroke_style::k_join_bevel:
+		default:
+			append_line(out, to);
+			break;
+	}
+}
+
+/**
+ * Append an end cap, from the end of out on the left of point to the
+ * opposite side.
+ * 
+ * @param	dir		Unit tangent arriving at point.
+**/
+static void append_cap(cubic_spline& out, const vector2dd& point, const vector2dd& dir, f64 half_width, stroke_style::cap_style cap) {
+	const vector2dd to = point - half_width * left_normal(dir);
+	
+	switch (cap) {
+		case stroke_style::k_cap_round:
+			append_arc(out, point, to, -PI64);
+			break;
+		
+		case stroke_style::k_cap_square: {
+			const vector2dd extend = half_width * dir;
+			append_line(out, last_point(out) + extend);
+			append_line(out, to + extend);
+			append_line(out, to);
+			break;
+		}
+		
+		case stroke_style::k_cap_butt:
+		default:
+			append_line(out, to);
+			break;
+	}
+}
+
+/*****************************************************************************/
+// Offsetting.
+
+/**
+ * The third derivative, constant over the curve.
+**/
+static inline vector2dd third_derivative(const cubic_bezier& curve) {
+	return 6.0 * (curve.endpoint - curve.origin + 3.0 * (curve.control_1 - curve.control_2));
+}
+
+/**
+ * Unit tangent at t.  At a cusp, or where the derivative is zero because
+ * control points coincide, the direction comes from the second derivative,
+ * reversed when arriving, or failing that the third.
+ * 
+ * @param	arriving	Get the direction arriving at t rather than leaving.
+ * @param	cusp		t is a cusp, ignore the first derivative.
+**/
+static vector2dd direction(const cubic_bezier& curve, f64 t, bool arriving, bool cusp) {
+	vector2dd dir = curve.get_tangent(t);
+	
+	if (cusp || dir.length_sq() == 0.0) {
+		dir = curve.get_normal(t);
+		if (arriving) dir = -dir;
+		
+		if (dir.length_sq() == 0.0) dir = third_derivative(curve);
+	}
+	
+	return dir.normalize();
+}
+
+/**
+ * Exact offset of the curve at t, for a t away from cusps.
+**/
+static inline vector2dd offset_point(const cubic_bezier& curve, f64 t, f64 distance) {
+	vector2dd dir = curve.get_tangent(t);
+	dir.normalize();
+	return curve.get_point(t) + distance * left_normal(dir);
+}
+
+/**
+ * Length of the handle of an offset piece at one end, the source handle
+ * scaled by 1 - distance * curvature.  Near a cusp the curvature is
+ * unbounded, so the handle is limited to the chord of the piece.
+**/
+static inline f64 offset_handle(const cubic_bezier& curve, f64 t, f64 dt, f64 distance, f64 chord) {
+	const vector2dd d1 = curve.get_tangent(t);
+	const vector2dd d2 = curve.get_normal(t);
+	const f64 speed = d1.length();
+	if (speed == 0.0) return 0.0;
+	
+	// speed * (1 - distance * cross / speed^3).
+	const f64 scaled = speed - distance * cross(d1, d2) / (speed * speed);
+	return clamp(scaled * dt / 3.0, 0.0, chord);
+}
+
+/**
+ * Fit the offset of the curve between t0 and t1 with cubics, appending them
+ * to out, which already ends at the start of the offset.
+ * 
+ * @param	dir0	Unit tangent leaving t0.
+ * @param	dir1	Unit tangent arriving at t1.
+**/
+static void offset_piece(const cubic_bezier& curve, f64 t0, f64 t1, const vector2dd& dir0, const vector2dd& dir1, f64 distance, f64 tolerance, u32 depth, cubic_spline& out) {
+	const f64 dt = t1 - t0;
+	const vector2dd start = last_point(out);
+	const vector2dd end = curve.get_point(t1) + distance * left_normal(dir1);
+	const f64 chord = start.distance(end);
+	
+	const cubic_bezier fit(
+		start,
+		start + offset_handle(curve, t0, dt, distance, chord) * dir0,
+		end - offset_handle(curve, t1, dt, distance, chord) * dir1,
+		end
+	);
+	
+	if (depth < k_max_offset_depth) {
+		const f64 tolerance_sq = tolerance * tolerance;
+		
+		for (u32 i = 0; i < 3; ++i) {
+			const f64 s = k_samples[i];
+			if (fit.get_point(s).distance_sq(offset_point(curve, t0 + s * dt, distance)) > tolerance_sq) {
+				const f64 mid = t0 + 0.5 * dt;
+				const vector2dd mid_dir = direction(curve, mid, false, false);
+				
+				offset_piece(curve, t0, mid, dir0, mid_dir, distance, tolerance, depth + 1, out);
+				offset_piece(curve, mid, t1, mid_dir, dir1, distance, tolerance, depth + 1, out);
+				return;
+			}
+		}
+	}
+	
+	out.append(fit.control_1, fit.control_2, fit.endpoint);
+}
+
+/**
+ * Find where the curve needs to be split for offsetting, in increasing
+ * order and excluding the ends.
+ * 
+ * @param	splits	Receives up to 5 positions.
+ * @param	cusps	Receives whether each split is a cusp.
+ * @return	Number of splits.
+**/
+static u32 find_splits(const cubic_bezier& curve, f64 tolerance, f64 * splits, bool * cusps) {
+	/* With B(t) = a t^3 + b t^2 + c t + d, B' = 3a t^2 + 2b t + c and
+	 * B'' = 6a t + 2b.
+	 * 
+	 * Inflections are where B' x B'' = 0:
+	 * -6 (a x b) t^2 + 6 (c x a) t + 2 (c x b)
+	 * 
+	 * The speed is smallest where B' . B'' = 0:
+	 * 18 (a . a) t^3 + 18 (a . b) t^2 + (4 b . b + 6 a . c) t + 2 b . c
+	 * 
+	 * which is a cusp when the tangent turns around within tolerance, when
+	 * |B'|^2 / |B''| is under it.
+	**/
+	const cubic_coefficients coeff = curve.power_basis();
+	const vector2dd& a = coeff.a;
+	const vector2dd& b = coeff.b;
+	const vector2dd& c = coeff.c;
+	
+	f64 found[5];
+	bool found_cusp[5];
+	u32 count = solve_quadratic_unit(-6.0 * cross(a, b), 6.0 * cross(c, a), 2.0 * cross(c, b), found);
+	for (u32 i = 0; i < count; ++i) found_cusp[i] = false;
+	
+	f64 slowest[3];
+	const u32 slowest_count = solve_cubic_unit(
+		18.0 * a.dot_product(a),
+		18.0 * a.dot_product(b),
+		4.0 * b.dot_product(b) + 6.0 * a.dot_product(c),
+		2.0 * b.dot_product(c),
+		slowest
+	);
+	
+	for (u32 i = 0; i < slowest_count; ++i) {
+		const f64 speed_sq = curve.get_tangent(slowest[i]).length_sq();
+		if (speed_sq <= tolerance * curve.get_normal(slowest[i]).length()) {
+			found[count] = slowest[i];
+			found_cusp[count] = true;
+			++count;
+		}
+	}
+	
+	// Sort, dropping splits at the ends or on top of another.  A cusp wins.
+	u32 splits_count = 0;
+	for (u32 pass = 0; pass < count; ++pass) {
+		u32 next = count;
+		for (u32 i = 0; i < count; ++i) {
+			if (found[i] < 0.0) continue;
+			if (next == count || found[i] < found[next]) next = i;
+		}
+		
+		const f64 t = found[next];
+		const bool cusp = found_cusp[next];
+		found[next] = -1.0;
+		
+		if (t <= k_min_piece || t >= 1.0 - k_min_piece) continue;
+		
+		if (splits_count && t - splits[splits_count - 1] <= k_min_piece) {
+			cusps[splits_count - 1] = cusps[splits_count - 1] || cusp;
+			continue;
+		}
+		
+		splits[splits_count] = t;
+		cusps[splits_count] = cusp;
+		++splits_count;
+	}
+	
+	return splits_count;
+}
+
+void offset_curve(const cubic_bezier& curve, f64 distance, f64 tolerance, cubic_spline& out) {
+	f64 splits[5];
+	bool cusps[5];
+	const u32 count = find_splits(curve, tolerance, splits, cusps);
+	
+	const vector2dd start = curve.origin + distance * left_normal(direction(curve, 0.0, false, false));
+	if (!out.point_count()) out.move_to(start);
+	else if (last_point(out) != start) append_line(out, start);
+	
+	f64 t0 = 0.0;
+	bool cusp0 = false;
+	
+	for (u32 i = 0; i <= count; ++i) {
+		const f64 t1 = (i < count) ? splits[i] : 1.0;
+		const bool cusp1 = (i < count) && cusps[i];
+		
+		const vector2dd dir0 = direction(curve, t0, false, cusp0);
+		const vector2dd dir1 = direction(curve, t1, true, cusp1);
+		offset_piece(curve, t0, t1, dir0, dir1, distance, tolerance, 0, out);
+		
+		if (cusp1) {
+			/* The tangent reverses at a cusp.  Either side of it, B'(t) is
+			 * close to B''(t1) (t - t1) + B'''(t - t1)^2 / 2, so the path
+			 * turns by -(B'' x B''').  The offset on the outside of that turn
+			 * is rounded over the tip, the inside is connected through it.
+			**/
+			const vector2dd point = curve.get_point(t1);
+			const vector2dd to = point + distance * left_normal(direction(curve, t1, false, true));
+			const f64 turn = -cross(curve.get_normal(t1), third_derivative(curve));
+			
+			if (turn * distance > 0.0) {
+				append_line(out, point);
+				append_line(out, to);
+			} else {
+				append_arc(out, point, to, distance > 0.0 ? -PI64 : PI64);
+			}
+		}
+		
+		t0 = t1;
+		cusp0 = cusp1;
+	}
+}
+
+/*****************************************************************************/
+// Stroking.
+
+/**
+ * Get a segment of a path, reversed if requested.
+**/
+static inline cubic_bezier path_segment(const cubic_spline& path, size_t idx, bool reversed) {
+	if (!reversed) return path.segment(idx);
+	
+	const cubic_bezier curve = path.segment(path.size() - 1 - idx);
+	return cubic_bezier(curve.endpoint, curve.control_2, curve.control_1, curve.origin);
+}
+
+/**
+ * Append the left edge of a path, or of the reversed path, with joins
+ * between its segments.
+**/
+static void append_edge(const cubic_spline& path, bool reversed, const stroke_style& style, cubic_spline& out) {
+	const f64 half_width = 0.5 * style.width;
+	const size_t segments = path.size();
+	vector2dd last_dir;
+	
+	for (size_t i = 0; i < segments; ++i) {
+		const cubic_bezier curve = path_segment(path, i, reversed);
+		
+		if (i) {
+			append_join(out, curve.origin, last_dir, direction(curve, 0.0, false, false), half_width, style.join, style.miter_limit);
+		}
+		
+		offset_curve(curve, half_width, style.tolerance, out);
+		last_dir = direction(curve, 1.0, true, false);
+	}
+}
+
+size_t stroke(const cubic_spline& path, const stroke_style& style, std::vector<cubic_spline>& contours) {
+	const size_t segments = path.size();
+	if (!segments) return 0;
+	
+	const f64 half_width = 0.5 * style.width;
+	const cubic_bezier first = path.segment(0);
+	const cubic_bezier last = path.segment(segments - 1);
+	const vector2dd start_dir = direction(first, 0.0, false, false);
+	const vector2dd end_dir = direction(last, 1.0, true, false);
+	
+	if (first.origin == last.endpoint) {
+		// Closed, each edge is its own contour joined where the ends meet.
+		contours.push_back(cubic_spline());
+		append_edge(path, false, style, contours.back());
+		append_join(contours.back(), first.origin, end_dir, start_dir, half_width, style.join, style.miter_limit);
+		
+		contours.push_back(cubic_spline());
+		append_edge(path, true, style, contours.back());
+		append_join(contours.back(), first.origin, -start_dir, -end_dir, half_width, style.join, style.miter_limit);
+		return 2;
+	}
+	
+	contours.push_back(cubic_spline());
+	cubic_spline& out = contours.back();
+	
+	append_edge(path, false, style, out);
+	append_cap(out, last.endpoint, end_dir, half_width, style.cap);
+	append_edge(path, true, style, out);
+	append_cap(out, first.origin, -start_dir, half_width, style.cap);
+	return 1;
+}
+
+size_t stroke(const cubic_bezier& curve, const stroke_style& style, std::vector<cubic_spline>& contours) {
+	cubic_spline path(curve.origin);
+	path.append(curve);
+	return stroke(path, style, contours);
+}
+
+/*****************************************************************************/
+} // End of namespace dnr.
@@ -0,0 +1,114 @@
+/*
+ * stroke.h
+ * Bezier
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+#ifndef _STROKE_H
+#define _STROKE_H
+
+#include <vector>
+#include "cubic_spline.h"
+
+namespace dnr {
+/*****************************************************************************/
+
+/**
+ * Parameters for stroking a path, with the same meaning as cairo's.
+**/
+struct stroke_style {
+	enum join_style {
+		k_join_miter = 0,	/// Extend the outer edges until they meet, see miter_limit.
+		k_join_round = 1,	/// Circular arc around the joint.
+		k_join_bevel = 2	/// Straight edge across the outside of the joint.
+	};
+	
+	enum cap_style {
+		k_cap_butt = 0,		/// End flat at the endpoint.
+		k_cap_round = 1,	/// Semicircle around the endpoint.
+		k_cap_square = 2	/// End flat, half the width past the endpoint.
+	};
+	
+	f64 width;
+	join_style join;
+	cap_style cap;
+	f64 miter_limit;	/// Longest miter as a multiple of the width, longer ones are beveled.
+	f64 tolerance;		/// Largest distance between the outline and the exact offset.
+	
+	stroke_style(f64 _width = 1.0, join_style _join = k_join_miter, cap_style _cap = k_cap_butt)
+			: width(_width),
+			  join(_join),
+			  cap(_cap),
+			  miter_limit(10.0),
+			  tolerance(0.1) {
+	}
+};
+
+/**
+ * Append the offset of a curve, the points at a fixed distance along its
+ * normal, as cubic segments.
+ * 
+ * The curve is split at its inflections and cusps, found with
+ * solve_quadratic_unit() and solve_cubic_unit() from the first and second
+ * derivatives, so that each piece turns one way.  A piece is approximated by
+ * a cubic with the same end tangents, handles scaled by the change in speed
+ * 1 - distance * curvature, and is halved until samples of it are within
+ * tolerance of the exact offset.  Cusps are rounded with an arc.
+ * 
+ * @param	curve		Curve to offset.
+ * @param	distance	Signed distance, positive to the left of the direction
+ * 						of travel, where left is the tangent (x, y) turned to
+ * 						(-y, x).
+ * @param	tolerance	Largest distance from the exact offset.
+ * @param	out			The segments are appended to this.  An empty path
+ * 						starts at the start of the offset, otherwise a line
+ * 						joins the end of the path to it.
+**/
+void offset_curve(const cubic_bezier& curve, f64 distance, f64 tolerance, cubic_spline& out);
+
+/**
+ * Build the outline of a stroked path, as closed contours to be filled with
+ * the nonzero winding rule.  Unlike flattening the path and offsetting the
+ * polyline, the outline is made of cubic segments whose count does not
+ * depend on the scale it is drawn at.
+ * 
+ * An open path gives one contour, running along the left edge, around the
+ * end cap, back along the right edge and around the start cap.  A path whose
+ * ends meet gives two, the left and right edges, joined where the ends meet.
+ * On the inside of a joint the edges are connected through the joint
+ * itself, so the overlap stays covered under the nonzero rule.
+ * 
+ * @param	path		Path to stroke.
+ * @param	style		Width, joins, caps and tolerance.
+ * @param	contours	The contours are appended to this, each ends at the
+ * 						point it starts at.
+ * @return	Number of contours appended.
+**/
+size_t stroke(const cubic_spline& path, const stroke_style& style, std::vector<cubic_spline>& contours);
+
+/**
+ * Build the outline of a single stroked curve, see stroke().
+**/
+size_t stroke(const cubic_bezier& curve, const stroke_style& style, std::vector<cubic_spline>& contours);
+
+/*****************************************************************************/
+} // End of namespace dnr.
+
+#endif // _STROKE_H.
@@ -40,6 +40,8 @@ namespace dnr {
 	typedef __int16 s16;			/// 16 bit signed variable.
 	typedef unsigned __int32 u32;	/// 32 bit unsigned variable.
 	typedef __int32 s32;			/// 32 bit signed variable.
+	typedef unsigned __int64 u64;	/// 64 bit unsigned variable.
+	typedef __int64 s64;			/// 64 bit signed variable.
 	
 // C99-compatible compiler.
 #elif defined(HAS_STDINT)
@@ -49,6 +51,8 @@ namespace dnr {
 	typedef int16_t s16;			/// 16 bit signed variable.
 	typedef uint32_t u32;			/// 32 bit unsigned variable.
 	typedef int32_t s32;			/// 32 bit signed variable.
+	typedef uint64_t u64;			/// 64 bit unsigned variable.
+	typedef int64_t s64;			/// 64 bit signed variable.
 	
 // Other compiler.
 #else
@@ -58,6 +62,8 @@ namespace dnr {
 	typedef signed short s16;		/// 16 bit signed variable.
 	typedef unsigned int u32;		/// 32 bit unsigned variable.
 	typedef signed int s32;			/// 32 bit signed variable.
+	typedef unsigned long long u64;	/// 64 bit unsigned variable.
+	typedef signed long long s64;	/// 64 bit signed variable.
 	
 #endif
 
@@ -69,6 +75,32 @@ typedef double f64;					/// 64 bit floating point variable.
 /// Insert a string literal and its length into a parameter list.
 #define CONST_STR_LEN(str) str, ((sizeof(str) / sizeof(*str)) - 1)
 
+/// Inline even when the compiler's heuristics would not.
+#if defined(_MSC_VER)
+	#define FORCE_INLINE __forceinline
+#elif defined(__GNUC__)
+	#define FORCE_INLINE inline __attribute__((always_inline))
+#else
+	#define FORCE_INLINE inline
+#endif
+
+/// constexpr and noexcept where the language has them.  constexpr functions
+/// need C++14, which allows more than a single return statement; older
+/// compilers get plain inline functions.
+#if __cplusplus >= 201402L
+	#define CONSTEXPR constexpr
+#else
+	#define CONSTEXPR inline
+#endif
+
+#if __cplusplus >= 201103L
+	#define CONSTEXPR_VAR constexpr
+	#define NOEXCEPT noexcept
+#else
+	#define CONSTEXPR_VAR const
+	#define NOEXCEPT
+#endif
+
 /*****************************************************************************/
 } // End of namespace dnr.
 
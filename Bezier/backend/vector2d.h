@@ -27,6 +27,14 @@
 #include "mathutil.h"
 #include <ostream>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if __cplusplus >= 201103L
+#include <type_traits>
+#endif
+
 namespace dnr {
 /*****************************************************************************/
 
@@ -46,18 +54,18 @@ struct vector2d {
 	/*************************************************************************/
 	// Constructors.
 	
-	vector2d() : x(0), y(0) { }
+	CONSTEXPR vector2d() NOEXCEPT : x(0), y(0) { }
 	
-	// Standard constructors.
-	vector2d(const vector2d<T>& other) : x(other.x), y(other.y) { }
-	vector2d(T _x, T _y) : x(_x), y(_y) { }
+	// Standard constructors.  Copying is left to the compiler, which keeps
+	// the type trivially copyable.
+	CONSTEXPR vector2d(T _x, T _y) NOEXCEPT : x(_x), y(_y) { }
 	
 	// Cast constructors.
 	template <typename S>
-	vector2d(const vector2d<S>& other) : x(other.x), y(other.y) { }
+	CONSTEXPR vector2d(const vector2d<S>& other) NOEXCEPT : x(other.x), y(other.y) { }
 	
 	template <typename S>
-	vector2d(S _x, S _y) : x(_x), y(_y) { }
+	CONSTEXPR vector2d(S _x, S _y) NOEXCEPT : x(_x), y(_y) { }
 	
 	/*************************************************************************/
 	// Manipulators.
@@ -65,7 +73,7 @@ struct vector2d {
 	/**
 	 * Standard set.
 	**/
-	void set(const vector2d<T>& rhs) {
+	CONSTEXPR void set(const vector2d<T>& rhs) NOEXCEPT {
 		x = rhs.x;
 		y = rhs.y;
 	}
@@ -73,7 +81,7 @@ struct vector2d {
 	/**
 	 * Individual set.
 	**/
-	void set(T _x, T _y) {
+	CONSTEXPR void set(T _x, T _y) NOEXCEPT {
 		x = _x;
 		y = _y;
 	}
@@ -82,7 +90,7 @@ struct vector2d {
 	 * Set with cast.
 	**/
 	template <typename S>
-	void set(const vector2d<S>& rhs) {
+	CONSTEXPR void set(const vector2d<S>& rhs) NOEXCEPT {
 		x = rhs.x;
 		y = rhs.y;
 	}
@@ -91,60 +99,60 @@ struct vector2d {
 	 * Individual set with cast.
 	**/
 	template <typename S>
-	void set(S _x, S _y) {
+	CONSTEXPR void set(S _x, S _y) NOEXCEPT {
 		x = _x;
 		y = _y;
 	}
 	
-	bool equals(const vector2d<T>& rhs) const {
+	CONSTEXPR bool equals(const vector2d<T>& rhs) const NOEXCEPT {
 		return ::dnr::equals(x, rhs.x) && ::dnr::equals(y, rhs.y);
 	}
 	
 	/**
 	 * Get the length or square length of the vector.
 	**/
-	T length() const { return (T) sqrt(f64(x * x + y * y)); }
-	T length_sq() const { return x * x + y * y; }
+	T length() const NOEXCEPT { return (T) sqrt(f64(x * x + y * y)); }
+	CONSTEXPR T length_sq() const NOEXCEPT { return x * x + y * y; }
 	
 	/**
 	 * Gets the distance between two vectors, assuming that each represents
 	 * a point in space.
 	**/
-	T distance(const vector2d<T>& rhs) const { return (rhs - *this).length(); }
-	T distance_sq(const vector2d<T>& rhs) const { return (rhs - *this).length_sq(); }
+	T distance(const vector2d<T>& rhs) const NOEXCEPT { return (rhs - *this).length(); }
+	CONSTEXPR T distance_sq(const vector2d<T>& rhs) const NOEXCEPT { return (rhs - *this).length_sq(); }
 	
 	/**
 	 * Finds the dot product.
 	**/
-	T dot_product(const vector2d<T>& rhs) const { return x * rhs.x + y * rhs.y; }
+	CONSTEXPR T dot_product(const vector2d<T>& rhs) const NOEXCEPT { return x * rhs.x + y * rhs.y; }
 	
 	/**
 	 * Rotate this vector.
 	**/
-	void rotate(f64 degrees) {
+	void rotate(f64 degrees) NOEXCEPT {
 		degrees *= DEGTORAD64;
 		rotate(vector2d<T>((T) cos(degrees), (T) sin(degrees)));
 	}
 	
-	void rotate_rad(f64 rad) {
+	void rotate_rad(f64 rad) NOEXCEPT {
 		rotate(vector2d<T>((T) cos(rad), (T) sin(rad)));
 	}
 	
-	void rotate(const vector2d<T>& cos_sin) {
+	CONSTEXPR void rotate(const vector2d<T>& cos_sin) NOEXCEPT {
 		set(x * cos_sin.x - y * cos_sin.y, x * cos_sin.y + y * cos_sin.x);
 	}
 	
 	/**
 	 * Get the angle that this vector makes with the +x axis, in radians.
 	**/
-	T angle() const {
+	T angle() const NOEXCEPT {
 		return (T) atan2(f64(y), f64(x));
 	}
 	
 	/**
 	 * Normalize this vector.
 	**/
-	vector2d<T>& normalize() {
+	vector2d<T>& normalize() NOEXCEPT {
 		T len = length();
 		
 		if (iszero(len)) {
@@ -159,52 +167,58 @@ struct vector2d {
 		return *this;
 	}
 	
+	/**
+	 * Normalize this vector using an approximate reciprocal square root,
+	 * where one is available.  The length is only accurate to about 1 part
+	 * in 10^6 for vector2df, and is exact otherwise.
+	**/
+	vector2d<T>& normalize_fast() NOEXCEPT { return normalize(); }
+	
 	/*************************************************************************/
 	// Operators.
 	
-	vector2d<T> operator-() const { return vector2d<T>(-x, -y); }
-	vector2d<T>& operator=(const vector2d<T>& rhs) { set(rhs); return *this; }
+	CONSTEXPR vector2d<T> operator-() const NOEXCEPT { return vector2d<T>(-x, -y); }
 	
 	template <typename S>
-	vector2d<T>& operator=(const vector2d<S>& rhs) { set(rhs); return *this; }
+	CONSTEXPR vector2d<T>& operator=(const vector2d<S>& rhs) NOEXCEPT { set(rhs); return *this; }
 	
 	// Addition.
-	vector2d<T> operator+(const vector2d<T>& rhs) const { return vector2d<T>(x + rhs.x, y + rhs.y); }
-	vector2d<T>& operator+=(const vector2d<T>& rhs) { x += rhs.x; y += rhs.y; return *this; }
-	vector2d<T> operator+(const T a) const { return vector2d<T>(x + a, y + a); }
-	vector2d<T>& operator+=(const T a) { x += a; y += a; return *this; }
-	friend vector2d<T> operator+(const T a, const vector2d<T>& other) { return vector2d<T>(a + other.x, a + other.y); }
+	CONSTEXPR vector2d<T> operator+(const vector2d<T>& rhs) const NOEXCEPT { return vector2d<T>(x + rhs.x, y + rhs.y); }
+	CONSTEXPR vector2d<T>& operator+=(const vector2d<T>& rhs) NOEXCEPT { x += rhs.x; y += rhs.y; return *this; }
+	CONSTEXPR vector2d<T> operator+(const T a) const NOEXCEPT { return vector2d<T>(x + a, y + a); }
+	CONSTEXPR vector2d<T>& operator+=(const T a) NOEXCEPT { x += a; y += a; return *this; }
+	friend CONSTEXPR vector2d<T> operator+(const T a, const vector2d<T>& other) NOEXCEPT { return vector2d<T>(a + other.x, a + other.y); }
 	
 	// Subtraction.
-	vector2d<T> operator-(const vector2d<T>& rhs) const { return vector2d<T>(x - rhs.x, y - rhs.y); }
-	vector2d<T>& operator-=(const vector2d<T>& rhs) { x -= rhs.x; y -= rhs.y; return *this; }
-	vector2d<T> operator-(const T a) const { return vector2d<T>(x - a, y - a); }
-	vector2d<T>& operator-=(const T a) { x -= a; y -= a; return *this; }
-	friend vector2d<T> operator-(const T a, const vector2d<T>& other) { return vector2d<T>(a - other.x, a - other.y); }
+	CONSTEXPR vector2d<T> operator-(const vector2d<T>& rhs) const NOEXCEPT { return vector2d<T>(x - rhs.x, y - rhs.y); }
+	CONSTEXPR vector2d<T>& operator-=(const vector2d<T>& rhs) NOEXCEPT { x -= rhs.x; y -= rhs.y; return *this; }
+	CONSTEXPR vector2d<T> operator-(const T a) const NOEXCEPT { return vector2d<T>(x - a, y - a); }
+	CONSTEXPR vector2d<T>& operator-=(const T a) NOEXCEPT { x -= a; y -= a; return *this; }
+	friend CONSTEXPR vector2d<T> operator-(const T a, const vector2d<T>& other) NOEXCEPT { return vector2d<T>(a - other.x, a - other.y); }
 	
 	// Multiplication.
-	vector2d<T> operator*(const vector2d<T>& rhs) const { return vector2d<T>(x * rhs.x, y * rhs.y); }
-	vector2d<T>& operator*=(const vector2d<T>& rhs) { x *= rhs.x; y *= rhs.y; return *this; }
-	vector2d<T> operator*(const T a) const { return vector2d<T>(x * a, y * a); }
-	vector2d<T>& operator*=(const T a) { x *= a; y *= a; return *this; }
-	friend vector2d<T> operator*(const T a, const vector2d<T>& other) { return vector2d<T>(a * other.x, a * other.y); }
+	CONSTEXPR vector2d<T> operator*(const vector2d<T>& rhs) const NOEXCEPT { return vector2d<T>(x * rhs.x, y * rhs.y); }
+	CONSTEXPR vector2d<T>& operator*=(const vector2d<T>& rhs) NOEXCEPT { x *= rhs.x; y *= rhs.y; return *this; }
+	CONSTEXPR vector2d<T> operator*(const T a) const NOEXCEPT { return vector2d<T>(x * a, y * a); }
+	CONSTEXPR vector2d<T>& operator*=(const T a) NOEXCEPT { x *= a; y *= a; return *this; }
+	friend CONSTEXPR vector2d<T> operator*(const T a, const vector2d<T>& other) NOEXCEPT { return vector2d<T>(a * other.x, a * other.y); }
 	
 	// Division.
-	vector2d<T> operator/(const vector2d<T>& rhs) const { return vector2d<T>(x / rhs.x, y / rhs.y); }
-	vector2d<T>& operator/=(const vector2d<T>& rhs) { x /= rhs.x; y /= rhs.y; return *this; }
-	vector2d<T> operator/(const T a) const { return vector2d<T>(x / a, y / a); }
-	vector2d<T>& operator/=(const T a) { x /= a; y /= a; return *this; }
-	friend vector2d<T> operator/(const T a, const vector2d<T>& other) { return vector2d<T>(a / other.x, a / other.y); }
+	CONSTEXPR vector2d<T> operator/(const vector2d<T>& rhs) const NOEXCEPT { return vector2d<T>(x / rhs.x, y / rhs.y); }
+	CONSTEXPR vector2d<T>& operator/=(const vector2d<T>& rhs) NOEXCEPT { x /= rhs.x; y /= rhs.y; return *this; }
+	CONSTEXPR vector2d<T> operator/(const T a) const NOEXCEPT { return vector2d<T>(x / a, y / a); }
+	CONSTEXPR vector2d<T>& operator/=(const T a) NOEXCEPT { x /= a; y /= a; return *this; }
+	friend CONSTEXPR vector2d<T> operator/(const T a, const vector2d<T>& other) NOEXCEPT { return vector2d<T>(a / other.x, a / other.y); }
 	
 	// Comparison.
-	bool operator<=(const vector2d<T>& rhs) const { return x <= rhs.x && y <= rhs.y; }
-	bool operator>=(const vector2d<T>& rhs) const { return x >= rhs.x && y >= rhs.y; }
+	CONSTEXPR bool operator<=(const vector2d<T>& rhs) const NOEXCEPT { return x <= rhs.x && y <= rhs.y; }
+	CONSTEXPR bool operator>=(const vector2d<T>& rhs) const NOEXCEPT { return x >= rhs.x && y >= rhs.y; }
 	
-	bool operator<(const vector2d<T>& rhs) const { return x < rhs.x && y < rhs.y; }
-	bool operator>(const vector2d<T>& rhs) const { return x > rhs.x && y > rhs.y; }
+	CONSTEXPR bool operator<(const vector2d<T>& rhs) const NOEXCEPT { return x < rhs.x && y < rhs.y; }
+	CONSTEXPR bool operator>(const vector2d<T>& rhs) const NOEXCEPT { return x > rhs.x && y > rhs.y; }
 	
-	bool operator==(const vector2d<T>& rhs) const { return equals(rhs); }
-	bool operator!=(const vector2d<T>& rhs) const { return !equals(rhs); }
+	CONSTEXPR bool operator==(const vector2d<T>& rhs) const NOEXCEPT { return equals(rhs); }
+	CONSTEXPR bool operator!=(const vector2d<T>& rhs) const NOEXCEPT { return !equals(rhs); }
 	
 	// Ostream.
 	friend std::ostream& operator<<(std::ostream& os, const vector2d<T>& vec) {
@@ -214,9 +228,46 @@ struct vector2d {
 };
 
 
+/*****************************************************************************/
+// Specializations.
+
+/* The generic length() goes through f64 so that integer vectors get a
+ * sensible result.  Floats can use the single precision square root, which
+ * rounds to the same value.
+**/
+template <> inline f32 vector2d<f32>::length() const NOEXCEPT { return sqrtf(x * x + y * y); }
+
+#if defined(__SSE2__)
+/**
+ * rsqrtss is accurate to 12 bits, one Newton-Raphson step brings it to 22.
+**/
+template <> inline vector2d<f32>& vector2d<f32>::normalize_fast() NOEXCEPT {
+	const f32 len_sq = x * x + y * y;
+	
+	// Same cutoff as normalize(), on the square length.
+	if (iszero(len_sq, ROUNDING_ERROR_32 * ROUNDING_ERROR_32)) {
+		x = 0.0f;
+		y = 0.0f;
+	} else {
+		f32 mag = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(len_sq)));
+		mag *= 1.5f - 0.5f * len_sq * mag * mag;
+		x *= mag;
+		y *= mag;
+	}
+	
+	return *this;
+}
+#endif
+
 /*****************************************************************************/
 // Defaults struct.
 
+/* From C++14, where CONSTEXPR makes the constructor constexpr, these are
+ * constant-initialized and safe to use from other static initializers.
+ * Before C++14 they are initialized dynamically, so a static initializer in
+ * another translation unit may still see them zeroed.
+**/
+
 template <typename T> const vector2d<T> vector2d<T>::defaults::zero = vector2d<T>(T(0), T(0));
 
 template <typename T> const vector2d<T> vector2d<T>::defaults::xaxis = vector2d<T>(T(1), T(0));
@@ -233,6 +284,20 @@ typedef vector2d<f64> vector2dd;
 
 typedef vector2d<s32> vector2di;
 
+/* Points are copied in bulk with memcpy and viewed as flat f64 arrays, and
+ * tables of them are built at compile time.
+**/
+#if __cplusplus >= 201103L
+static_assert(std::is_trivially_copyable<vector2dd>::value, "vector2dd must be trivially copyable");
+static_assert(std::is_trivially_copyable<vector2df>::value, "vector2df must be trivially copyable");
+static_assert(sizeof(vector2dd) == 2 * sizeof(f64), "vector2dd must be two packed f64s");
+#endif
+
+#if __cplusplus >= 201402L
+static_assert((vector2dd(1.0, 2.0) + vector2dd(3.0, 4.0)).dot_product(vector2dd(1.0, 1.0)) == 10.0,
+			  "vector2d arithmetic must be usable in constant expressions");
+#endif
+
 /*****************************************************************************/
 } // End of namespace dnr.
 
@@ -0,0 +1,598 @@
+/*
+ * vector2d_array.h
+ * Bezier
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+#ifndef _VECTOR2D_ARRAY_H
+#define _VECTOR2D_ARRAY_H
+
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include "vector2d.h"
+
+namespace dnr {
+/*****************************************************************************/
+
+/* Arrays of vectors stored as separate x and y arrays, with lazy expressions
+ * over them.  An expression such as
+ * 
+ * out = (1.0 - t) * (1.0 - t) * p_0 + 2.0 * (1.0 - t) * t * p_1 + t * t * p_2;
+ * 
+ * where t is a scalar_view and out a vector2d_array, builds a tree of small
+ * nodes and is evaluated by one loop when assigned, with no temporary arrays.
+ * Each node only does scalar arithmetic per element, so the loop can be
+ * auto-vectorized.
+ * 
+ * Scalar expressions produce one value per element, vector expressions an x
+ * and a y.  Constants have a size of 0 and match any size, all other
+ * operands of an expression must have the same size.
+ * 
+ * Every node can report whether it reads from a range of memory, which lets
+ * evaluation detect when the output is also an operand.
+**/
+
+/**
+ * Base for expressions producing a scalar per element.
+**/
+template <typename T, typename E>
+struct scalar_expr {
+	FORCE_INLINE const E& self() const { return static_cast<const E&>(*this); }
+	
+	size_t size() const { return self().size(); }
+	FORCE_INLINE T operator[](size_t i) const { return self()[i]; }
+	
+	/// Does the expression read from [begin, end)?
+	bool reads(const T * begin, const T * end) const { return self().reads(begin, end); }
+};
+
+/**
+ * Base for expressions producing a vector per element.
+**/
+template <typename T, typename E>
+struct vector_expr {
+	FORCE_INLINE const E& self() const { return static_cast<const E&>(*this); }
+	
+	size_t size() const { return self().size(); }
+	FORCE_INLINE T x(size_t i) const { return self().x(i); }
+	FORCE_INLINE T y(size_t i) const { return self().y(i); }
+	
+	/// Does the expression read from [begin, end)?
+	bool reads(const T * begin, const T * end) const { return self().reads(begin, end); }
+};
+
+/**
+ * How an expression node holds its operands.  Nodes are held by value since
+ * they are temporaries of the full expression, arrays as a vector_view.
+**/
+template <typename E>
+struct expr_storage {
+	typedef const E type;
+};
+
+/**
+ * Get the size of a binary expression, taking whichever side is not a
+ * constant.  Both sides must have the same size unless one is a constant.
+**/
+inline size_t expr_size(size_t lhs, size_t rhs) {
+	assert(!lhs || !rhs || lhs == rhs);
+	return lhs ? lhs : rhs;
+}
+
+/**
+ * Does the array [data, data + count) overlap [begin, end)?
+**/
+template <typename T>
+inline bool ranges_overlap(const T * data, size_t count, const T * begin, const T * end) {
+	return count && data < end && begin < data + count;
+}
+
+/*****************************************************************************/
+// Operations.
+
+struct expr_add { template <typename T> static FORCE_INLINE T apply(T a, T b) { return a + b; } };
+struct expr_sub { template <typename T> static FORCE_INLINE T apply(T a, T b) { return a - b; } };
+struct expr_mul { template <typename T> static FORCE_INLINE T apply(T a, T b) { return a * b; } };
+struct expr_div { template <typename T> static FORCE_INLINE T apply(T a, T b) { return a / b; } };
+
+/*****************************************************************************/
+// Scalar expressions.
+
+/**
+ * A scalar array owned elsewhere, such as a list of t values.
+**/
+template <typename T>
+struct scalar_view : public scalar_expr<T, scalar_view<T> > {
+	const T * data;
+	size_t count;
+	
+	scalar_view(const T * _data, size_t _count) : data(_data), count(_count) { }
+	
+	size_t size() const { return count; }
+	FORCE_INLINE T operator[](size_t i) const { return data[i]; }
+	bool reads(const T * begin, const T * end) const { return ranges_overlap(data, count, begin, end); }
+};
+
+/**
+ * A scalar repeated for every element.
+**/
+template <typename T>
+struct scalar_constant : public scalar_expr<T, scalar_constant<T> > {
+	T value;
+	
+	explicit scalar_constant(T _value) : value(_value) { }
+	
+	size_t size() const { return 0; }
+	FORCE_INLINE T operator[](size_t) const { return value; }
+	bool reads(const T *, const T *) const { return false; }
+};
+
+template <typename T, typename L, typename R, typename Op>
+struct scalar_binary : public scalar_expr<T, scalar_binary<T, L, R, Op> > {
+	typename expr_storage<L>::type lhs;
+	typename expr_storage<R>::type rhs;
+	
+	scalar_binary(const L& _lhs, const R& _rhs) : lhs(_lhs), rhs(_rhs) { }
+	
+	size_t size() const { return expr_size(lhs.size(), rhs.size()); }
+	FORCE_INLINE T operator[](size_t i) const { return Op::apply(lhs[i], rhs[i]); }
+	bool reads(const T * begin, const T * end) const { return lhs.reads(begin, end) || rhs.reads(begin, end); }
+};
+
+/**
+ * The dot product of two vector expressions.
+**/
+template <typename T, typename L, typename R>
+struct vector_dot : public scalar_expr<T, vector_dot<T, L, R> > {
+	typename expr_storage<L>::type lhs;
+	typename expr_storage<R>::type rhs;
+	
+	vector_dot(const L& _lhs, const R& _rhs) : lhs(_lhs), rhs(_rhs) { }
+	
+	size_t size() const { return expr_size(lhs.size(), rhs.size()); }
+	FORCE_INLINE T operator[](size_t i) const { return lhs.x(i) * rhs.x(i) + lhs.y(i) * rhs.y(i); }
+	bool reads(const T * begin, const T * end) const { return lhs.reads(begin, end) || rhs.reads(begin, end); }
+};
+
+/*****************************************************************************/
+// Vector expressions.
+
+/**
+ * A vector repeated for every element.
+**/
+template <typename T>
+struct vector_constant : public vector_expr<T, vector_constant<T> > {
+	vector2d<T> value;
+	
+	explicit vector_constant(const vector2d<T>& _value) : value(_value) { }
+	
+	size_t size() const { return 0; }
+	FORCE_INLINE T x(size_t) const { return value.x; }
+	FORCE_INLINE T y(size_t) const { return value.y; }
+	bool reads(const T *, const T *) const { return false; }
+};
+
+template <typename T, typename L, typename R, typename Op>
+struct vector_binary : public vector_expr<T, vector_binary<T, L, R, Op> > {
+	typename expr_storage<L>::type lhs;
+	typename expr_storage<R>::type rhs;
+	
+	vector_binary(const L& _lhs, const R& _rhs) : lhs(_lhs), rhs(_rhs) { }
+	
+	size_t size() const { return expr_size(lhs.size(), rhs.size()); }
+	FORCE_INLINE T x(size_t i) const { return Op::apply(lhs.x(i), rhs.x(i)); }
+	FORCE_INLINE T y(size_t i) const { return Op::apply(lhs.y(i), rhs.y(i)); }
+	bool reads(const T * begin, const T * end) const { return lhs.reads(begin, end) || rhs.reads(begin, end); }
+};
+
+/**
+ * A vector expression combined with a scalar expression, in either order.
+ * 
+ * @tparam	ScalarFirst		Is the scalar the left operand?
+**/
+template <typename T, typename V, typename S, typename Op, bool ScalarFirst>
+struct vector_scalar : public vector_expr<T, vector_scalar<T, V, S, Op, ScalarFirst> > {
+	typename expr_storage<V>::type vec;
+	typename expr_storage<S>::type scalar;
+	
+	vector_scalar(const V& _vec, const S& _scalar) : vec(_vec), scalar(_scalar) { }
+	
+	size_t size() const { return expr_size(vec.size(), scalar.size()); }
+	FORCE_INLINE T x(size_t i) const { return ScalarFirst ? Op::apply(scalar[i], vec.x(i)) : Op::apply(vec.x(i), scalar[i]); }
+	FORCE_INLINE T y(size_t i) const { return ScalarFirst ? Op::apply(scalar[i], vec.y(i)) : Op::apply(vec.y(i), scalar[i]); }
+	bool reads(const T * begin, const T * end) const { return vec.reads(begin, end) || scalar.reads(begin, end); }
+};
+
+template <typename T, typename E>
+struct vector_negate : public vector_expr<T, vector_negate<T, E> > {
+	typename expr_storage<E>::type vec;
+	
+	explicit vector_negate(const E& _vec) : vec(_vec) { }
+	
+	size_t size() const { return vec.size(); }
+	FORCE_INLINE T x(size_t i) const { return -vec.x(i); }
+	FORCE_INLINE T y(size_t i) const { return -vec.y(i); }
+	bool reads(const T * begin, const T * end) const { return vec.reads(begin, end); }
+};
+
+template <typename T, typename E>
+void evaluate(const vector_expr<T, E>& expr, T * out_x, T * out_y);
+
+/*****************************************************************************/
+// Storage.
+
+/**
+ * An array of vectors stored as separate x and y arrays, each aligned for
+ * SSE2/AVX loads.
+**/
+template <typename T>
+class vector2d_array : public vector_expr<T, vector2d_array<T> > {
+public:
+	static const size_t k_alignment = 32;
+	
+	/*************************************************************************/
+	// Constructors.
+	
+	vector2d_array() : m_x(0), m_y(0), m_size(0), m_capacity(0) { }
+	
+	explicit vector2d_array(size_t size) : m_x(0), m_y(0), m_size(0), m_capacity(0) {
+		resize(size);
+	}
+	
+	vector2d_array(const vector2d_array<T>& other) : m_x(0), m_y(0), m_size(0), m_capacity(0) {
+		*this = other;
+	}
+	
+	template <typename E>
+	vector2d_array(const vector_expr<T, E>& expr) : m_x(0), m_y(0), m_size(0), m_capacity(0) {
+		*this = expr;
+	}
+	
+	~vector2d_array() {
+		deallocate(m_x);
+	}
+	
+	/*************************************************************************/
+	// Structure.
+	
+	size_t size() const { return m_size; }
+	bool empty() const { return m_size == 0; }
+	
+	/**
+	 * Change the number of elements, keeping existing ones.  New elements are
+	 * zero.
+	**/
+	void resize(size_t size) {
+		if (size > m_capacity) {
+			// Round up so that the y array stays aligned.
+			const size_t per_line = k_alignment / sizeof(T);
+			const size_t capacity = (size + per_line - 1) / per_line * per_line;
+			
+			T * data = allocate(capacity * 2);
+			if (m_size) {
+				memcpy(data, m_x, m_size * sizeof(T));
+				memcpy(data + capacity, m_y, m_size * sizeof(T));
+			}
+			
+			deallocate(m_x);
+			m_x = data;
+			m_y = data + capacity;
+			m_capacity = capacity;
+		}
+		
+		for (size_t i = m_size; i < size; ++i) {
+			m_x[i] = T(0);
+			m_y[i] = T(0);
+		}
+		
+		m_size = size;
+	}
+	
+	void clear() { m_size = 0; }
+	
+	/*************************************************************************/
+	// Element access.
+	
+	/**
+	 * Direct access to the coordinate arrays.
+	**/
+	T * x() { return m_x; }
+	const T * x() const { return m_x; }
+	T * y() { return m_y; }
+	const T * y() const { return m_y; }
+	
+	FORCE_INLINE T x(size_t i) const { return m_x[i]; }
+	FORCE_INLINE T y(size_t i) const { return m_y[i]; }
+	
+	vector2d<T> operator[](size_t i) const { return vector2d<T>(m_x[i], m_y[i]); }
+	
+	bool reads(const T * begin, const T * end) const {
+		return ranges_overlap(m_x, m_size, begin, end) || ranges_overlap(m_y, m_size, begin, end);
+	}
+	
+	void set(size_t i, const vector2d<T>& vec) {
+		m_x[i] = vec.x;
+		m_y[i] = vec.y;
+	}
+	
+	/*************************************************************************/
+	// Assignment.
+	
+	vector2d_array<T>& operator=(const vector2d_array<T>& other) {
+		if (this != &other) {
+			resize(other.size());
+			if (m_size) {
+				memcpy(m_x, other.m_x, m_size * sizeof(T));
+				memcpy(m_y, other.m_y, m_size * sizeof(T));
+			}
+		}
+		
+		return *this;
+	}
+	
+	/**
+	 * Evaluate an expression into this array.  The expression may refer to
+	 * this array, as long as the size does not change.
+	**/
+	template <typename E>
+	vector2d_array<T>& operator=(const vector_expr<T, E>& expr) {
+		resize(expr.size());
+		evaluate(expr, m_x, m_y);
+		return *this;
+	}
+	
+	template <typename E>
+	vector2d_array<T>& operator+=(const vector_expr<T, E>& expr) {
+		return *this = *this + expr;
+	}
+	
+	template <typename E>
+	vector2d_array<T>& operator-=(const vector_expr<T, E>& expr) {
+		return *this = *this - expr;
+	}
+	
+	vector2d_array<T>& operator*=(T a) {
+		for (size_t i = 0; i < m_size; ++i) {
+			m_x[i] *= a;
+			m_y[i] *= a;
+		}
+		
+		return *this;
+	}
+	
+private:
+	T * m_x;
+	T * m_y; // Part of the same allocation as m_x.
+	size_t m_size;
+	size_t m_capacity;
+	
+	static T * allocate(size_t count) {
+		void * data = 0;
+#if defined(_MSC_VER)
+		data = _aligned_malloc(count * sizeof(T), k_alignment);
+#else
+		if (posix_memalign(&data, k_alignment, count * sizeof(T)) != 0) data = 0;
+#endif
+		if (!data) throw std::bad_alloc();
+		return static_cast<T *>(data);
+	}
+	
+	static void deallocate(T * data) {
+#if defined(_MSC_VER)
+		_aligned_free(data);
+#else
+		free(data);
+#endif
+	}
+};
+
+/**
+ * The coordinate arrays of a vector2d_array, which is how expressions hold
+ * one.  Copying the pointers lets the evaluation loop keep them in
+ * registers.
+**/
+template <typename T>
+struct vector_view : public vector_expr<T, vector_view<T> > {
+	const T * xs;
+	const T * ys;
+	size_t count;
+	
+	vector_view(const vector2d_array<T>& array) : xs(array.x()), ys(array.y()), count(array.size()) { }
+	
+	size_t size() const { return count; }
+	FORCE_INLINE T x(size_t i) const { return xs[i]; }
+	FORCE_INLINE T y(size_t i) const { return ys[i]; }
+	
+	bool reads(const T * begin, const T * end) const {
+		return ranges_overlap(xs, count, begin, end) || ranges_overlap(ys, count, begin, end);
+	}
+};
+
+template <typename T>
+struct expr_storage<vector2d_array<T> > {
+	typedef const vector_view<T> type;
+};
+
+/*****************************************************************************/
+// Operators.
+
+#define EXPR_OPERATOR(op, Op) \
+	template <typename T, typename L, typename R> \
+	FORCE_INLINE scalar_binary<T, L, R, Op> operator op(const scalar_expr<T, L>& lhs, const scalar_expr<T, R>& rhs) { \
+		return scalar_binary<T, L, R, Op>(lhs.self(), rhs.self()); \
+	} \
+	template <typename T, typename L> \
+	FORCE_INLINE scalar_binary<T, L, scalar_constant<T>, Op> operator op(const scalar_expr<T, L>& lhs, T rhs) { \
+		return scalar_binary<T, L, scalar_constant<T>, Op>(lhs.self(), scalar_constant<T>(rhs)); \
+	} \
+	template <typename T, typename R> \
+	FORCE_INLINE scalar_binary<T, scalar_constant<T>, R, Op> operator op(T lhs, const scalar_expr<T, R>& rhs) { \
+		return scalar_binary<T, scalar_constant<T>, R, Op>(scalar_constant<T>(lhs), rhs.self()); \
+	} \
+	template <typename T, typename L, typename R> \
+	FORCE_INLINE vector_binary<T, L, R, Op> operator op(const vector_expr<T, L>& lhs, const vector_expr<T, R>& rhs) { \
+		return vector_binary<T, L, R, Op>(lhs.self(), rhs.self()); \
+	} \
+	template <typename T, typename L> \
+	FORCE_INLINE vector_binary<T, L, vector_constant<T>, Op> operator op(const vector_expr<T, L>& lhs, const vector2d<T>& rhs) { \
+		return vector_binary<T, L, vector_constant<T>, Op>(lhs.self(), vector_constant<T>(rhs)); \
+	} \
+	template <typename T, typename R> \
+	FORCE_INLINE vector_binary<T, vector_constant<T>, R, Op> operator op(const vector2d<T>& lhs, const vector_expr<T, R>& rhs) { \
+		return vector_binary<T, vector_constant<T>, R, Op>(vector_constant<T>(lhs), rhs.self()); \
+	} \
+	template <typename T, typename V, typename S> \
+	FORCE_INLINE vector_scalar<T, V, S, Op, false> operator op(const vector_expr<T, V>& lhs, const scalar_expr<T, S>& rhs) { \
+		return vector_scalar<T, V, S, Op, false>(lhs.self(), rhs.self()); \
+	} \
+	template <typename T, typename S, typename V> \
+	FORCE_INLINE vector_scalar<T, V, S, Op, true> operator op(const scalar_expr<T, S>& lhs, const vector_expr<T, V>& rhs) { \
+		return vector_scalar<T, V, S, Op, true>(rhs.self(), lhs.self()); \
+	} \
+	template <typename T, typename V> \
+	FORCE_INLINE vector_scalar<T, V, scalar_constant<T>, Op, false> operator op(const vector_expr<T, V>& lhs, T rhs) { \
+		return vector_scalar<T, V, scalar_constant<T>, Op, false>(lhs.self(), scalar_constant<T>(rhs)); \
+	} \
+	template <typename T, typename V> \
+	FORCE_INLINE vector_scalar<T, V, scalar_constant<T>, Op, true> operator op(T lhs, const vector_expr<T, V>& rhs) { \
+		return vector_scalar<T, V, scalar_constant<T>, Op, true>(rhs.self(), scalar_constant<T>(lhs)); \
+	} \
+	template <typename T, typename S> \
+	FORCE_INLINE vector_scalar<T, vector_constant<T>, S, Op, true> operator op(const scalar_expr<T, S>& lhs, const vector2d<T>& rhs) { \
+		return vector_scalar<T, vector_constant<T>, S, Op, true>(vector_constant<T>(rhs), lhs.self()); \
+	} \
+	template <typename T, typename S> \
+	FORCE_INLINE vector_scalar<T, vector_constant<T>, S, Op, false> operator op(const vector2d<T>& lhs, const scalar_expr<T, S>& rhs) { \
+		return vector_scalar<T, vector_constant<T>, S, Op, false>(vector_constant<T>(lhs), rhs.self()); \
+	}
+
+EXPR_OPERATOR(+, expr_add)
+EXPR_OPERATOR(-, expr_sub)
+EXPR_OPERATOR(*, expr_mul)
+EXPR_OPERATOR(/, expr_div)
+
+#undef EXPR_OPERATOR
+
+template <typename T, typename E>
+FORCE_INLINE vector_negate<T, E> operator-(const vector_expr<T, E>& vec) {
+	return vector_negate<T, E>(vec.self());
+}
+
+/**
+ * Get the dot product of two vector expressions, per element.
+**/
+template <typename T, typename L, typename R>
+FORCE_INLINE vector_dot<T, L, R> dot_product(const vector_expr<T, L>& lhs, const vector_expr<T, R>& rhs) {
+	return vector_dot<T, L, R>(lhs.self(), rhs.self());
+}
+
+/**
+ * Get the square length of a vector expression, per element.
+**/
+template <typename T, typename E>
+FORCE_INLINE vector_dot<T, E, E> length_sq(const vector_expr<T, E>& vec) {
+	return vector_dot<T, E, E>(vec.self(), vec.self());
+}
+
+/**
+ * Wrap a scalar array for use in expressions.
+**/
+template <typename T>
+inline scalar_view<T> scalars(const T * data, size_t count) {
+	return scalar_view<T>(data, count);
+}
+
+/* The evaluation loops copy the tree, which lets its leaves be kept in
+ * registers; the original would be reloaded after every store in case the
+ * stores alias it.  When no leaf reads the output, the loop writes through
+ * __restrict pointers so that it does not need a run-time overlap check
+ * against every leaf, which would stop GCC from vectorizing anything but the
+ * smallest expressions.  Otherwise, such as for a += b or a = -a * 2.0 + a,
+ * a plain loop is used; it is correct as long as each output element only
+ * overlaps the same element of its operands, since that is read before it
+ * is written.
+**/
+
+template <typename T, typename E>
+inline void evaluate_restrict(const E& e, size_t count, T * __restrict out) {
+	for (size_t i = 0; i < count; ++i) out[i] = e[i];
+}
+
+template <typename T, typename E>
+inline void evaluate_aliased(const E& e, size_t count, T * out) {
+	for (size_t i = 0; i < count; ++i) out[i] = e[i];
+}
+
+template <typename T, typename E>
+inline void evaluate_restrict(const E& e, size_t count, T * __restrict out_x, T * __restrict out_y) {
+	for (size_t i = 0; i < count; ++i) {
+		const T x = e.x(i);
+		const T y = e.y(i);
+		out_x[i] = x;
+		out_y[i] = y;
+	}
+}
+
+template <typename T, typename E>
+inline void evaluate_aliased(const E& e, size_t count, T * out_x, T * out_y) {
+	for (size_t i = 0; i < count; ++i) {
+		const T x = e.x(i);
+		const T y = e.y(i);
+		out_x[i] = x;
+		out_y[i] = y;
+	}
+}
+
+/**
+ * Evaluate a scalar expression into an array of expr.size() values.
+**/
+template <typename T, typename E>
+inline void evaluate(const scalar_expr<T, E>& expr, T * out) {
+	const E e = expr.self();
+	const size_t count = e.size();
+	
+	if (e.reads(out, out + count)) evaluate_aliased(e, count, out);
+	else evaluate_restrict(e, count, out);
+}
+
+/**
+ * Evaluate a vector expression into x and y arrays of expr.size() values.
+**/
+template <typename T, typename E>
+inline void evaluate(const vector_expr<T, E>& expr, T * out_x, T * out_y) {
+	const E e = expr.self();
+	const size_t count = e.size();
+	
+	if (e.reads(out_x, out_x + count) || e.reads(out_y, out_y + count)) evaluate_aliased(e, count, out_x, out_y);
+	else evaluate_restrict(e, count, out_x, out_y);
+}
+
+/*****************************************************************************/
+// Helper typedefs.
+
+typedef vector2d_array<f32> vector2df_array;
+typedef vector2d_array<f64> vector2dd_array;
+
+/*****************************************************************************/
+} // End of namespace dnr.
+
+#endif // _VECTOR2D_ARRAY_H.
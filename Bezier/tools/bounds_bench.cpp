@@ -0,0 +1,186 @@
+/*
+ * bounds_bench.cpp
+ * Bezier
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+/**
+ * Benchmark for the batched bounds kernel.  Build from the Bezier directory
+ * with:
+ * 
+ * c++ -O2 -Ibackend tools/bounds_bench.cpp backend/cubic_bezier.cpp \
+ *     -o bounds_bench
+ * 
+ * Times cubic_bezier::bounds() called in a loop against bounds_batch(), on
+ * an array of curves and on a path with shared anchors, then checks that
+ * they give the same boxes.  The check adds curves with a linear or
+ * constant derivative, which take the degenerate paths through both.
+**/
+
+#include "cubic_bezier.h"
+#include <sys/time.h>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace dnr;
+
+/// Random curves bounded.
+static const size_t k_curves = 100000;
+
+/// Passes over every curve for each timing.
+static const u32 k_passes = 20;
+
+/// Timings taken of each method, the fastest is reported.
+static const u32 k_runs = 3;
+
+/// Keeps results alive so that the timed loops are not optimized away.
+static volatile f64 g_sink;
+
+/**
+ * Get the current time, in seconds.
+**/
+static f64 current_time() {
+	timeval tv;
+	gettimeofday(&tv, 0);
+	return f64(tv.tv_sec) + f64(tv.tv_usec) * 1.0e-6;
+}
+
+static vector2dd random_point() {
+	return vector2dd(f64(rand()) / f64(RAND_MAX) * 1000.0 - 500.0, f64(rand()) / f64(RAND_MAX) * 1000.0 - 500.0);
+}
+
+enum bounds_method {
+	k_scalar = 0,		/// cubic_bezier::bounds() on each curve.
+	k_batch = 1,		/// bounds_batch() on the curves.
+	k_batch_path = 2	/// bounds_batch() on the path points, with a stride of 3.
+};
+
+static void run_method(bounds_method method, const std::vector<cubic_bezier>& curves, const std::vector<vector2dd>& path, aabboxd * out) {
+	if (method == k_scalar) {
+		for (size_t i = 0; i < curves.size(); ++i) out[i] = curves[i].bounds();
+	} else if (method == k_batch) {
+		bounds_batch(&curves[0], curves.size(), out);
+	} else {
+		bounds_batch(&path[0], 3, (path.size() - 1) / 3, out);
+	}
+}
+
+/**
+ * Time a method over every curve.
+ * 
+ * @return	Millions of curves per second, from the fastest run.
+**/
+static f64 time_method(bounds_method method, const std::vector<cubic_bezier>& curves, const std::vector<vector2dd>& path) {
+	std::vector<aabboxd> out(curves.size());
+	f64 best = 0.0;
+	
+	for (u32 run = 0; run < k_runs; ++run) {
+		const f64 start = current_time();
+		
+		for (u32 pass = 0; pass < k_passes; ++pass) {
+			run_method(method, curves, path, &out[0]);
+			g_sink += out[pass].origin.x;
+		}
+		
+		const f64 elapsed = current_time() - start;
+		best = max_(best, f64(k_passes) * f64(curves.size()) / elapsed * 1.0e-6);
+	}
+	
+	return best;
+}
+
+/**
+ * Find the largest difference between the boxes from bounds() and from a
+ * batched method.
+**/
+static f64 max_difference(bounds_method method, const std::vector<cubic_bezier>& curves, const std::vector<vector2dd>& path) {
+	std::vector<aabboxd> expected(curves.size()), actual(curves.size());
+	run_method(k_scalar, curves, path, &expected[0]);
+	run_method(method, curves, path, &actual[0]);
+	
+	f64 worst = 0.0;
+	for (size_t i = 0; i < curves.size(); ++i) {
+		worst = max_(worst, max_(abs_(actual[i].origin.x - expected[i].origin.x), abs_(actual[i].origin.y - expected[i].origin.y)));
+		worst = max_(worst, max_(abs_(actual[i].extent.x - expected[i].extent.x), abs_(actual[i].extent.y - expected[i].extent.y)));
+	}
+	
+	return worst;
+}
+
+/**
+ * Build a path from curves, sharing each endpoint with the next origin.
+**/
+static std::vector<vector2dd> make_path(const std::vector<cubic_bezier>& curves) {
+	std::vector<vector2dd> path;
+	path.push_back(curves[0].origin);
+	
+	for (size_t i = 0; i < curves.size(); ++i) {
+		path.push_back(curves[i].control_1);
+		path.push_back(curves[i].control_2);
+		path.push_back(curves[i].endpoint);
+	}
+	
+	return path;
+}
+
+int main() {
+	srand(1);
+	
+	// Random curves, each starting where the last ended so they form a path.
+	std::vector<cubic_bezier> curves;
+	vector2dd start = random_point();
+	
+	for (size_t i = 0; i < k_curves; ++i) {
+		curves.push_back(cubic_bezier(start, random_point(), random_point(), random_point()));
+		start = curves.back().endpoint;
+	}
+	
+	std::vector<vector2dd> path = make_path(curves);
+	
+	printf("%u curves\n\n", u32(k_curves));
+	printf("bounds()                  %6.1f M/s\n", time_method(k_scalar, curves, path));
+	printf("bounds_batch(curves)      %6.1f M/s\n", time_method(k_batch, curves, path));
+	printf("bounds_batch(path, 3)     %6.1f M/s\n", time_method(k_batch_path, curves, path));
+	
+	/* Add degenerate curves for the check.  Control points evenly spaced on
+	 * a line give a constant derivative, P_3 = P_0 - 3 P_1 + 3 P_2 zeroes the
+	 * t^2 term of the derivative and leaves a linear one, and a curve
+	 * collapsed to a point has none.
+	**/
+	for (size_t i = 0; i < k_curves / 10; ++i) {
+		const vector2dd a = curves.back().endpoint;
+		const vector2dd c = random_point();
+		const vector2dd d = random_point();
+		const vector2dd e = a - 3.0 * c + 3.0 * d;
+		const vector2dd b = random_point();
+		
+		curves.push_back(cubic_bezier(a, c, d, e));
+		curves.push_back(cubic_bezier(e, e, e, e));
+		curves.push_back(cubic_bezier(e, e + (b - e) / 3.0, e + 2.0 * (b - e) / 3.0, b));
+	}
+	
+	path = make_path(curves);
+	
+	printf("\nLargest difference from bounds() over %u curves:\n", u32(curves.size()));
+	printf("bounds_batch(curves)      %g\n", max_difference(k_batch, curves, path));
+	printf("bounds_batch(path, 3)     %g\n", max_difference(k_batch_path, curves, path));
+	return 0;
+}
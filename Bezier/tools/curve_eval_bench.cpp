@@ -0,0 +1,242 @@
+/*
+ * curve_eval_bench.cpp
+ * Bezier
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+/**
+ * Benchmark for the batched curve evaluation.  Build from the Bezier
+ * directory with:
+ * 
+ * c++ -O2 -Ibackend tools/curve_eval_bench.cpp backend/cubic_bezier.cpp \
+ *     -o curve_eval_bench
+ * 
+ * and add -mavx2 for the AVX kernels.  Each curve is evaluated at the same
+ * k_positions random t values, by calling get_point(), get_tangent() and
+ * get_normal() in a loop and by the batched get_points(), get_tangents()
+ * and get_normals().  get_points_uniform() is timed for as many points.
+ * The largest difference from the scalar results is printed with each.
+**/
+
+#include "cubic_bezier.h"
+#include <sys/time.h>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace dnr;
+
+/// Random curves evaluated.
+static const size_t k_curves = 1024;
+
+/// Positions evaluated on each curve.
+static const size_t k_positions = 256;
+
+/// Passes over every curve for each timing.
+static const u32 k_passes = 200;
+
+/// Timings taken of each method, the fastest is reported.
+static const u32 k_runs = 3;
+
+/// Keeps results alive so that the timed loops are not optimized away.
+static volatile f64 g_sink;
+
+/**
+ * Get the current time, in seconds.
+**/
+static f64 current_time() {
+	timeval tv;
+	gettimeofday(&tv, 0);
+	return f64(tv.tv_sec) + f64(tv.tv_usec) * 1.0e-6;
+}
+
+static f64 random_coord() {
+	return f64(rand()) / f64(RAND_MAX) * 1000.0 - 500.0;
+}
+
+enum eval_kind {
+	k_point = 0,
+	k_tangent = 1,
+	k_normal = 2
+};
+
+/**
+ * Evaluate one curve a point at a time.
+**/
+static void eval_scalar(const cubic_bezier& curve, eval_kind kind, const f64 * t, f64 * out_x, f64 * out_y) {
+	if (kind == k_point) {
+		for (size_t i = 0; i < k_positions; ++i) {
+			const vector2dd v = curve.get_point(t[i]);
+			out_x[i] = v.x;
+			out_y[i] = v.y;
+		}
+	} else if (kind == k_tangent) {
+		for (size_t i = 0; i < k_positions; ++i) {
+			const vector2dd v = curve.get_tangent(t[i]);
+			out_x[i] = v.x;
+			out_y[i] = v.y;
+		}
+	} else {
+		for (size_t i = 0; i < k_positions; ++i) {
+			const vector2dd v = curve.get_normal(t[i]);
+			out_x[i] = v.x;
+			out_y[i] = v.y;
+		}
+	}
+}
+
+/**
+ * Evaluate one curve with the batched methods.
+**/
+static void eval_batch(const cubic_bezier& curve, eval_kind kind, const f64 * t, f64 * out_x, f64 * out_y) {
+	if (kind == k_point) curve.get_points(t, k_positions, out_x, out_y);
+	else if (kind == k_tangent) curve.get_tangents(t, k_positions, out_x, out_y);
+	else curve.get_normals(t, k_positions, out_x, out_y);
+}
+
+/**
+ * Time an evaluation over every curve.
+ * 
+ * @return	Millions of points per second, from the fastest run.
+**/
+static f64 time_eval(const std::vector<cubic_bezier>& curves, const f64 * t, eval_kind kind, bool batch) {
+	std::vector<f64> out_x(k_positions + 1), out_y(k_positions + 1);
+	f64 best = 0.0;
+	
+	for (u32 run = 0; run < k_runs; ++run) {
+		const f64 start = current_time();
+		
+		for (u32 pass = 0; pass < k_passes; ++pass) {
+			for (size_t i = 0; i < curves.size(); ++i) {
+				if (batch) eval_batch(curves[i], kind, t, &out_x[0], &out_y[0]);
+				else eval_scalar(curves[i], kind, t, &out_x[0], &out_y[0]);
+				g_sink += out_x[i % k_positions];
+			}
+		}
+		
+		const f64 elapsed = current_time() - start;
+		best = max_(best, f64(k_passes) * f64(curves.size()) * f64(k_positions) / elapsed * 1.0e-6);
+	}
+	
+	return best;
+}
+
+/**
+ * Time get_points_uniform() for k_positions points per curve.
+ * 
+ * @return	Millions of points per second, from the fastest run.
+**/
+static f64 time_uniform(const std::vector<cubic_bezier>& curves) {
+	std::vector<f64> out_x(k_positions), out_y(k_positions);
+	f64 best = 0.0;
+	
+	for (u32 run = 0; run < k_runs; ++run) {
+		const f64 start = current_time();
+		
+		for (u32 pass = 0; pass < k_passes; ++pass) {
+			for (size_t i = 0; i < curves.size(); ++i) {
+				curves[i].get_points_uniform(k_positions - 1, &out_x[0], &out_y[0]);
+				g_sink += out_x[i % k_positions];
+			}
+		}
+		
+		const f64 elapsed = current_time() - start;
+		best = max_(best, f64(k_passes) * f64(curves.size()) * f64(k_positions) / elapsed * 1.0e-6);
+	}
+	
+	return best;
+}
+
+/**
+ * Find the largest difference between the scalar and batched results,
+ * relative to the size of the scalar result.
+**/
+static f64 max_difference(const std::vector<cubic_bezier>& curves, const f64 * t, eval_kind kind) {
+	std::vector<f64> scalar_x(k_positions), scalar_y(k_positions);
+	std::vector<f64> batch_x(k_positions), batch_y(k_positions);
+	f64 worst = 0.0;
+	
+	for (size_t i = 0; i < curves.size(); ++i) {
+		eval_scalar(curves[i], kind, t, &scalar_x[0], &scalar_y[0]);
+		eval_batch(curves[i], kind, t, &batch_x[0], &batch_y[0]);
+		
+		for (size_t j = 0; j < k_positions; ++j) {
+			const f64 scale = max_(1.0, max_(abs_(scalar_x[j]), abs_(scalar_y[j])));
+			worst = max_(worst, abs_(batch_x[j] - scalar_x[j]) / scale);
+			worst = max_(worst, abs_(batch_y[j] - scalar_y[j]) / scale);
+		}
+	}
+	
+	return worst;
+}
+
+/**
+ * Find the largest difference between get_points_uniform() and get_point().
+**/
+static f64 max_difference_uniform(const std::vector<cubic_bezier>& curves) {
+	std::vector<f64> out_x(k_positions), out_y(k_positions);
+	f64 worst = 0.0;
+	
+	for (size_t i = 0; i < curves.size(); ++i) {
+		curves[i].get_points_uniform(k_positions - 1, &out_x[0], &out_y[0]);
+		
+		for (size_t j = 0; j < k_positions; ++j) {
+			const vector2dd pt = curves[i].get_point(f64(j) / f64(k_positions - 1));
+			const f64 scale = max_(1.0, max_(abs_(pt.x), abs_(pt.y)));
+			worst = max_(worst, max_(abs_(out_x[j] - pt.x), abs_(out_y[j] - pt.y)) / scale);
+		}
+	}
+	
+	return worst;
+}
+
+int main() {
+	srand(1);
+	
+	std::vector<cubic_bezier> curves;
+	for (size_t i = 0; i < k_curves; ++i) {
+		curves.push_back(cubic_bezier(vector2dd(random_coord(), random_coord()), vector2dd(random_coord(), random_coord()),
+									  vector2dd(random_coord(), random_coord()), vector2dd(random_coord(), random_coord())));
+	}
+	
+	std::vector<f64> t(k_positions);
+	for (size_t i = 0; i < k_positions; ++i) t[i] = f64(rand()) / f64(RAND_MAX);
+	
+#if defined(__AVX__)
+	const char * kernel = "AVX";
+#elif defined(__SSE2__)
+	const char * kernel = "SSE2";
+#else
+	const char * kernel = "scalar";
+#endif
+	
+	printf("%u curves, %u positions each, %s kernels\n\n", u32(k_curves), u32(k_positions), kernel);
+	printf("               loop M/s   batch M/s   max difference\n");
+	
+	static const char * names[] = { "points", "tangents", "normals" };
+	for (u32 kind = k_point; kind <= k_normal; ++kind) {
+		const f64 scalar = time_eval(curves, &t[0], eval_kind(kind), false);
+		const f64 batch = time_eval(curves, &t[0], eval_kind(kind), true);
+		printf("%-12s %10.0f %11.0f %16.2g\n", names[kind], scalar, batch, max_difference(curves, &t[0], eval_kind(kind)));
+	}
+	
+	printf("uniform      %10s %11.0f %16.2g\n", "", time_uniform(curves), max_difference_uniform(curves));
+	return 0;
+}
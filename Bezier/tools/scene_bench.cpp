@@ -0,0 +1,306 @@
+/*
+ * scene_bench.cpp
+ * Bezier
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+/**
+ * Benchmark for scene files.  Build from the Bezier directory with:
+ * 
+ * c++ -O2 -Ibackend tools/scene_bench.cpp backend/scene_file.cpp \
+ *     backend/cubic_spline.cpp backend/cubic_bezier.cpp backend/bvh.cpp \
+ *     -o scene_bench
+ * 
+ * and run it as scene_bench [FILE], which writes a scene of random paths to
+ * FILE (scene_bench.scene by default) and reads it back.  Loading the scene
+ * is timed four ways, each ending with every point and bound touched and a
+ * bvh over the segments:
+ * 
+ * - In memory: build each cubic_spline, bound its segments and build the
+ *   bvh, as a program that parses its scene would.
+ * - SVG path text: the same, parsing the paths from "M x,y C ..." text in
+ *   memory with strtod, as a program storing its scene as SVG would.
+ * - Cold open: open the file after dropping it from the page cache, and
+ *   load the stored bvh.  Needs posix_fadvise, elsewhere it is skipped.
+ * - Warm open: the same with the file already cached.
+ * 
+ * load_bvh() is also timed alone against building the bvh.
+**/
+
+#include "scene_file.h"
+#include <sys/time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+using namespace dnr;
+
+/// Paths in the scene.
+static const size_t k_paths = 2000;
+
+/// Most segments in a path, the counts are uniform from 1.
+static const size_t k_max_segments = 190;
+
+/// Timings taken of each warm measurement, the fastest is reported.
+static const u32 k_runs = 5;
+
+/// Keeps results alive so that the timed loops are not optimized away.
+static volatile f64 g_sink;
+
+/**
+ * Get the current time, in seconds.
+**/
+static f64 current_time() {
+	timeval tv;
+	gettimeofday(&tv, 0);
+	return f64(tv.tv_sec) + f64(tv.tv_usec) * 1.0e-6;
+}
+
+static vector2dd random_point() {
+	return vector2dd(f64(rand()) / f64(RAND_MAX) * 1000.0, f64(rand()) / f64(RAND_MAX) * 1000.0);
+}
+
+/**
+ * Points of every path as a parser would leave them, before any
+ * cubic_spline is built.
+**/
+struct raw_scene {
+	std::vector<std::vector<vector2dd> > paths;
+	size_t point_count;
+	
+	raw_scene() : point_count(0) {
+		srand(1);
+		paths.resize(k_paths);
+		
+		for (size_t i = 0; i < k_paths; ++i) {
+			const size_t segments = 1 + size_t(rand()) % k_max_segments;
+			for (size_t j = 0; j < 3 * segments + 1; ++j) paths[i].push_back(random_point());
+			point_count += paths[i].size();
+		}
+	}
+};
+
+/**
+ * Build the scene in memory.
+ * 
+ * @return	Seconds taken.
+**/
+static f64 build_in_memory(const raw_scene& raw, std::vector<cubic_spline>& paths, std::vector<aabboxd>& boxes, bvh& tree) {
+	const f64 start = current_time();
+	
+	paths.assign(raw.paths.size(), cubic_spline());
+	boxes.clear();
+	
+	for (size_t i = 0; i < raw.paths.size(); ++i) {
+		const std::vector<vector2dd>& points = raw.paths[i];
+		cubic_spline& path = paths[i];
+		
+		path.reserve((points.size() - 1) / 3);
+		path.move_to(points[0]);
+		for (size_t j = 1; j < points.size(); j += 3) path.append(points[j], points[j + 1], points[j + 2]);
+		
+		const size_t first = boxes.size();
+		boxes.resize(first + path.size());
+		path.segment_bounds(&boxes[first]);
+	}
+	
+	tree.build(&boxes[0], boxes.size());
+	return current_time() - start;
+}
+
+/**
+ * Write the scene as SVG path data, one path per line, with enough digits
+ * to read every point back exactly.
+**/
+static std::string write_svg(const raw_scene& raw) {
+	std::string text;
+	char buffer[64];
+	
+	for (size_t i = 0; i < raw.paths.size(); ++i) {
+		const std::vector<vector2dd>& points = raw.paths[i];
+		
+		for (size_t j = 0; j < points.size(); ++j) {
+			const char * command = (j == 0) ? "M" : (j % 3 == 1) ? " C" : " ";
+			snprintf(buffer, sizeof(buffer), "%s%.17g,%.17g", command, points[j].x, points[j].y);
+			text += buffer;
+		}
+		
+		text += '\n';
+	}
+	
+	return text;
+}
+
+/**
+ * Read a point of SVG path data, skipping the separators before it.
+**/
+static vector2dd read_svg_point(const char *& text) {
+	char * end;
+	const f64 x = strtod(text, &end);
+	const f64 y = strtod(end + 1, &end); // Past the comma.
+	
+	text = end;
+	return vector2dd(x, y);
+}
+
+/**
+ * Parse the scene from SVG path data written by write_svg(), then bound
+ * it and build the bvh as build_in_memory() does.
+ * 
+ * @return	Seconds taken.
+**/
+static f64 parse_svg(const std::string& svg, std::vector<cubic_spline>& paths, std::vector<aabboxd>& boxes, bvh& tree) {
+	const f64 start = current_time();
+	
+	paths.clear();
+	boxes.clear();
+	
+	for (const char * text = svg.c_str(); *text; ) {
+		if (*text == 'M') {
+			paths.push_back(cubic_spline());
+			paths.back().move_to(read_svg_point(++text));
+		} else if (*text == 'C') {
+			const vector2dd control_1 = read_svg_point(++text);
+			const vector2dd control_2 = read_svg_point(text);
+			paths.back().append(control_1, control_2, read_svg_point(text));
+		} else {
+			++text; // Spaces and newlines.
+		}
+	}
+	
+	for (size_t i = 0; i < paths.size(); ++i) {
+		const size_t first = boxes.size();
+		boxes.resize(first + paths[i].size());
+		paths[i].segment_bounds(&boxes[first]);
+	}
+	
+	tree.build(&boxes[0], boxes.size());
+	return current_time() - start;
+}
+
+/**
+ * Open the scene file, touch every point and bound, and load its bvh.
+ * 
+ * @return	Seconds taken.
+**/
+static f64 open_scene(const char * filename, bvh& tree) {
+	const f64 start = current_time();
+	
+	scene_file file(filename);
+	
+	const f64 * x = file.x();
+	const f64 * y = file.y();
+	f64 sum = 0.0;
+	for (size_t i = 0; i < file.point_count(); ++i) sum += x[i] + y[i];
+	
+	const aabboxd * bounds = file.bounds();
+	for (size_t i = 0; i < file.segment_count(); ++i) sum += bounds[i].extent.x;
+	
+	file.load_bvh(tree);
+	g_sink += sum;
+	
+	return current_time() - start;
+}
+
+/**
+ * Drop a file from the page cache.
+ * 
+ * @return	false if this system cannot.
+**/
+static bool evict(const char * filename) {
+#if defined(POSIX_FADV_DONTNEED)
+	const int file = open(filename, O_RDONLY);
+	if (file < 0) return false;
+	
+	const bool evicted = (fdatasync(file) == 0 && posix_fadvise(file, 0, 0, POSIX_FADV_DONTNEED) == 0);
+	close(file);
+	return evicted;
+#else
+	(void) filename;
+	return false;
+#endif
+}
+
+int main(int argc, char ** argv) {
+	const char * filename = (argc > 1) ? argv[1] : "scene_bench.scene";
+	
+	const raw_scene raw;
+	std::vector<cubic_spline> paths;
+	std::vector<aabboxd> boxes;
+	bvh tree;
+	
+	f64 in_memory = 1.0e30;
+	for (u32 run = 0; run < k_runs; ++run) in_memory = min_(in_memory, build_in_memory(raw, paths, boxes, tree));
+	
+	printf("%u paths, %u segments, %u points\n\n", u32(paths.size()), u32(boxes.size()), u32(raw.point_count));
+	
+	try {
+		f64 start = current_time();
+		
+		scene_writer writer(filename, paths.size(), raw.point_count);
+		for (size_t i = 0; i < paths.size(); ++i) writer.append(paths[i]);
+		writer.finish(&tree);
+		
+		printf("write            %8.2f ms\n", (current_time() - start) * 1.0e3);
+		printf("in memory        %8.2f ms\n", in_memory * 1.0e3);
+		
+		const std::string svg = write_svg(raw);
+		std::vector<cubic_spline> parsed_paths;
+		std::vector<aabboxd> parsed_boxes;
+		bvh parsed;
+		
+		f64 text = 1.0e30;
+		for (u32 run = 0; run < k_runs; ++run) text = min_(text, parse_svg(svg, parsed_paths, parsed_boxes, parsed));
+		printf("SVG path text    %8.2f ms, %.1f MB of text\n", text * 1.0e3, f64(svg.size()) / (1024.0 * 1024.0));
+		
+		bvh loaded;
+		if (evict(filename)) printf("cold open        %8.2f ms\n", open_scene(filename, loaded) * 1.0e3);
+		else printf("cold open        skipped, the page cache cannot be dropped here\n");
+		
+		f64 warm = 1.0e30;
+		for (u32 run = 0; run < k_runs; ++run) warm = min_(warm, open_scene(filename, loaded));
+		printf("warm open        %8.2f ms\n", warm * 1.0e3);
+		
+		// The bvh alone.
+		scene_file file(filename);
+		f64 load = 1.0e30, build = 1.0e30;
+		
+		for (u32 run = 0; run < k_runs; ++run) {
+			start = current_time();
+			file.load_bvh(loaded);
+			load = min_(load, current_time() - start);
+			
+			start = current_time();
+			tree.build(&boxes[0], boxes.size());
+			build = min_(build, current_time() - start);
+		}
+		
+		printf("\nload_bvh()       %8.2f ms\n", load * 1.0e3);
+		printf("bvh::build()     %8.2f ms\n", build * 1.0e3);
+	} catch (const std::exception& e) {
+		fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+	
+	return 0;
+}
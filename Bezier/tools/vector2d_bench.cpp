@@ -0,0 +1,336 @@
+/*
+ * vector2d_bench.cpp
+ * Bezier
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+/**
+ * Microbenchmark for vector2d.  Build from the Bezier directory with:
+ * 
+ * c++ -O2 -Ibackend tools/vector2d_bench.cpp -o vector2d_bench
+ * 
+ * Each operator is timed over arrays of k_count vectors, for vector2dd and
+ * vector2df.  The normalize variants are also timed as a dependent chain,
+ * where latency counts rather than throughput, and normalize_fast() is
+ * checked against the exact length.
+ * 
+ * On SSE2 targets the vector2dd alternatives that were tried and left out
+ * are timed alongside: operator+ on a 16-byte aligned __m128d, and a
+ * normalize from an rsqrtss estimate with two Newton-Raphson steps.  The
+ * sizes of structures that 16-byte alignment would change are printed too.
+**/
+
+#include "vector2d.h"
+#include "curve_projection.h"
+#include "bvh.h"
+#include <sys/time.h>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace dnr;
+
+/// Vectors in each array, few enough to stay in the first level cache.
+static const size_t k_count = 4096;
+
+/// Passes over the arrays for each operator.
+static const u32 k_passes = 20000;
+
+/// Steps in each dependent chain.
+static const u32 k_chain_steps = 10000000;
+
+/// Random vectors normalize_fast() is checked with.
+static const u32 k_accuracy_samples = 1000000;
+
+/// Keeps results alive so that the timed loops are not optimized away.
+static volatile f64 g_sink;
+
+/**
+ * Get the current time, in seconds.
+**/
+static f64 current_time() {
+	timeval tv;
+	gettimeofday(&tv, 0);
+	return f64(tv.tv_sec) + f64(tv.tv_usec) * 1.0e-6;
+}
+
+static void report(const char * type, const char * name, f64 ns) {
+	printf("%s %-22s %6.2f ns\n", type, name, ns);
+}
+
+/**
+ * Operands and results for the operator timings.
+**/
+template <typename T>
+struct bench_arrays {
+	std::vector<vector2d<T> > a;
+	std::vector<vector2d<T> > b;
+	std::vector<vector2d<T> > out;
+	std::vector<T> scalar;
+	
+	bench_arrays() : a(k_count), b(k_count), out(k_count), scalar(k_count) {
+		srand(1);
+		
+		for (size_t i = 0; i < k_count; ++i) {
+			a[i].set(T(rand() % 1000 - 500) / T(7), T(rand() % 1000 - 500) / T(3));
+			b[i].set(T(rand() % 1000 + 1) / T(5), T(rand() % 1000 + 1) / T(11));
+		}
+	}
+};
+
+/**
+ * Time an operation over every element of the arrays.
+ * 
+ * @return	Nanoseconds per element.
+**/
+template <typename T, typename Op>
+static f64 time_operator(bench_arrays<T>& arrays, Op op) {
+	const vector2d<T> * a = &arrays.a[0];
+	const vector2d<T> * b = &arrays.b[0];
+	vector2d<T> * out = &arrays.out[0];
+	T * scalar = &arrays.scalar[0];
+	
+	const f64 start = current_time();
+	
+	for (u32 pass = 0; pass < k_passes; ++pass) {
+		for (size_t i = 0; i < k_count; ++i) op(a[i], b[i], out[i], scalar[i]);
+		g_sink += f64(out[pass % k_count].x) + f64(scalar[pass % k_count]);
+	}
+	
+	return (current_time() - start) * 1.0e9 / (f64(k_passes) * f64(k_count));
+}
+
+// One functor per operator, each writing to the vector or scalar result.
+#define VECTOR2D_BENCH_OP(name, body) \
+	struct op_##name { \
+		template <typename T> \
+		void operator()(const vector2d<T>& a, const vector2d<T>& b, vector2d<T>& out, T& scalar) const { \
+			(void) a; (void) b; (void) out; (void) scalar; \
+			body; \
+		} \
+	};
+
+VECTOR2D_BENCH_OP(add, out = a + b)
+VECTOR2D_BENCH_OP(sub, out = a - b)
+VECTOR2D_BENCH_OP(mul, out = a * b)
+VECTOR2D_BENCH_OP(div, out = a / b)
+VECTOR2D_BENCH_OP(scale, out = a * T(1.5))
+VECTOR2D_BENCH_OP(add_assign, out += a)
+VECTOR2D_BENCH_OP(neg, out = -a)
+VECTOR2D_BENCH_OP(dot, scalar = a.dot_product(b))
+VECTOR2D_BENCH_OP(length_sq, scalar = a.length_sq())
+VECTOR2D_BENCH_OP(length, scalar = a.length())
+VECTOR2D_BENCH_OP(distance, scalar = a.distance(b))
+VECTOR2D_BENCH_OP(normalize, out = a; out.normalize())
+VECTOR2D_BENCH_OP(normalize_fast, out = a; out.normalize_fast())
+VECTOR2D_BENCH_OP(equals, scalar = T(a == b))
+VECTOR2D_BENCH_OP(rotate, out = a; out.rotate(b))
+
+#undef VECTOR2D_BENCH_OP
+
+template <typename T>
+static void run_operators(const char * type) {
+	bench_arrays<T> arrays;
+	
+	report(type, "add", time_operator(arrays, op_add()));
+	report(type, "sub", time_operator(arrays, op_sub()));
+	report(type, "mul", time_operator(arrays, op_mul()));
+	report(type, "div", time_operator(arrays, op_div()));
+	report(type, "scale", time_operator(arrays, op_scale()));
+	report(type, "add_assign", time_operator(arrays, op_add_assign()));
+	report(type, "neg", time_operator(arrays, op_neg()));
+	report(type, "dot", time_operator(arrays, op_dot()));
+	report(type, "length_sq", time_operator(arrays, op_length_sq()));
+	report(type, "length", time_operator(arrays, op_length()));
+	report(type, "distance", time_operator(arrays, op_distance()));
+	report(type, "normalize", time_operator(arrays, op_normalize()));
+	report(type, "normalize_fast", time_operator(arrays, op_normalize_fast()));
+	report(type, "equals", time_operator(arrays, op_equals()));
+	report(type, "rotate", time_operator(arrays, op_rotate()));
+}
+
+/**
+ * Time a normalize where each step depends on the last.
+ * 
+ * @return	Nanoseconds per step.
+**/
+template <typename T, typename Normalize>
+static f64 time_chain(Normalize normalize) {
+	vector2d<T> v(T(3), T(4));
+	const vector2d<T> step(T(0.25), T(-0.5));
+	
+	const f64 start = current_time();
+	
+	for (u32 i = 0; i < k_chain_steps; ++i) {
+		v += step;
+		normalize(v);
+	}
+	
+	g_sink += f64(v.x);
+	return (current_time() - start) * 1.0e9 / f64(k_chain_steps);
+}
+
+struct chain_normalize {
+	template <typename T>
+	void operator()(vector2d<T>& v) const { v.normalize(); }
+};
+
+struct chain_normalize_fast {
+	template <typename T>
+	void operator()(vector2d<T>& v) const { v.normalize_fast(); }
+};
+
+/**
+ * Find the largest error in the length of vectors from normalize_fast().
+**/
+template <typename T>
+static f64 normalize_fast_error() {
+	srand(2);
+	f64 worst = 0.0;
+	
+	for (u32 i = 0; i < k_accuracy_samples; ++i) {
+		vector2d<T> v(T(rand()) / T(RAND_MAX) * T(200) - T(100), T(rand()) / T(RAND_MAX) * T(200) - T(100));
+		if (iszero(v.length())) continue;
+		
+		v.normalize_fast();
+		worst = max_(worst, abs_(sqrt(f64(v.x) * f64(v.x) + f64(v.y) * f64(v.y)) - 1.0));
+	}
+	
+	return worst;
+}
+
+#if defined(__SSE2__)
+/**
+ * vector2dd in one SSE2 register, as the specialization that was tried.
+**/
+struct sse_vector2dd {
+	__m128d xy;
+	
+	sse_vector2dd operator+(const sse_vector2dd& rhs) const {
+		sse_vector2dd res;
+		res.xy = _mm_add_pd(xy, rhs.xy);
+		return res;
+	}
+};
+
+/**
+ * Time sse_vector2dd::operator+ on the same operands as the f64 add.
+ * 
+ * @return	Nanoseconds per element.
+**/
+static f64 time_sse_add() {
+	const bench_arrays<f64> arrays;
+	std::vector<sse_vector2dd> a(k_count), b(k_count), out(k_count);
+	
+	for (size_t i = 0; i < k_count; ++i) {
+		a[i].xy = _mm_set_pd(arrays.a[i].y, arrays.a[i].x);
+		b[i].xy = _mm_set_pd(arrays.b[i].y, arrays.b[i].x);
+	}
+	
+	const f64 start = current_time();
+	
+	for (u32 pass = 0; pass < k_passes; ++pass) {
+		for (size_t i = 0; i < k_count; ++i) out[i] = a[i] + b[i];
+		g_sink += _mm_cvtsd_f64(out[pass % k_count].xy);
+	}
+	
+	return (current_time() - start) * 1.0e9 / (f64(k_passes) * f64(k_count));
+}
+
+/**
+ * Normalize a vector2dd from an rsqrtss estimate, which is good to 12 bits,
+ * and two Newton-Raphson steps to bring it close to full precision.
+**/
+struct chain_normalize_rsqrt {
+	void operator()(vector2dd& v) const {
+		const f64 len_sq = v.length_sq();
+		
+		if (iszero(len_sq, ROUNDING_ERROR_64 * ROUNDING_ERROR_64)) {
+			v.set(0.0, 0.0);
+			return;
+		}
+		
+		f64 mag = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(f32(len_sq))));
+		mag *= 1.5 - 0.5 * len_sq * mag * mag;
+		mag *= 1.5 - 0.5 * len_sq * mag * mag;
+		v *= mag;
+	}
+};
+
+/// vector2dd as it would be laid out with 16-byte alignment.
+struct aligned_vector2dd {
+	f64 x;
+	f64 y;
+} __attribute__((aligned(16)));
+
+/// curve_projection with aligned_vector2dd.
+struct aligned_curve_projection {
+	f64 t;
+	aligned_vector2dd point;
+	f64 distance_sq;
+};
+
+/// aabboxd with aligned_vector2dd.
+struct aligned_aabboxd {
+	aligned_vector2dd origin;
+	aligned_vector2dd extent;
+	bool active;
+};
+
+/// bvh::node with aligned_vector2dd.
+struct aligned_bvh_node {
+	aligned_aabboxd box;
+	u32 first;
+	u32 count;
+	u32 parent;
+};
+#endif
+
+int main() {
+	run_operators<f64>("f64");
+	run_operators<f32>("f32");
+	
+	printf("\nDependent chains:\n");
+	report("f64", "normalize", time_chain<f64>(chain_normalize()));
+	report("f64", "normalize_fast", time_chain<f64>(chain_normalize_fast()));
+	report("f32", "normalize", time_chain<f32>(chain_normalize()));
+	report("f32", "normalize_fast", time_chain<f32>(chain_normalize_fast()));
+	
+	printf("\nLargest length error from normalize_fast() over %u vectors:\n", k_accuracy_samples);
+	printf("f64 %g\n", normalize_fast_error<f64>());
+	printf("f32 %g\n", normalize_fast_error<f32>());
+	
+#if defined(__SSE2__)
+	printf("\nAlternatives for vector2dd:\n");
+	bench_arrays<f64> arrays;
+	report("f64", "add", time_operator(arrays, op_add()));
+	report("f64", "add, __m128d", time_sse_add());
+	report("f64", "normalize chain", time_chain<f64>(chain_normalize()));
+	report("f64", "normalize chain, rsqrt", time_chain<f64>(chain_normalize_rsqrt()));
+	
+	printf("\nSizes, as is and with 16-byte aligned vectors:\n");
+	printf("vector2dd         %2u %2u\n", u32(sizeof(vector2dd)), u32(sizeof(aligned_vector2dd)));
+	printf("aabboxd           %2u %2u\n", u32(sizeof(aabboxd)), u32(sizeof(aligned_aabboxd)));
+	printf("curve_projection  %2u %2u\n", u32(sizeof(curve_projection)), u32(sizeof(aligned_curve_projection)));
+	printf("bvh::node         %2u %2u\n", u32(sizeof(bvh::node)), u32(sizeof(aligned_bvh_node)));
+#endif
+	
+	return 0;
+}
@@ -94,6 +94,9 @@
 - (void) onRender: (cairo_t *) context: (float) width: (float) height {
 	vector2dd size(width, height);
 	m_backend->render(context, size);
+	
+	// Keep drawing while the caustics are being refined.
+	if (m_backend->needs_redraw()) [m_view setNeedsDisplay: YES];
 }
 
 static float clamp_radius(float rad) {
@@ -143,15 +146,15 @@ static float clamp_radius(float rad) {
 
 /// Called when the refraction presets are changed.
 - (void) onSelectPreset: (NSMenuItem *) caller {
-	float val = m_backend->n_presets().at([caller tag]).n;
+	const lens_backend::index& preset = m_backend->n_presets().at([caller tag]);
 	
 	if ([caller menu] == [m_inside_presets menu]) {
-		m_backend->inside_n(val);
-		[m_inside_n setFloatValue: val];
+		m_backend->inside_material(preset.material);
+		[m_inside_n setFloatValue: preset.n];
 		
 	} else if ([caller menu] == [m_outside_presets menu]) {
-		m_backend->outside_n(val);
-		[m_outside_n setFloatValue: val];
+		m_backend->outside_material(preset.material);
+		[m_outside_n setFloatValue: preset.n];
 	}
 	
 	[m_view setNeedsDisplay: YES];
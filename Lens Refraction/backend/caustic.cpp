@@ -0,0 +1,350 @@
+/*
+ * caustic.cpp
+ * Lens Refraction
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+#include "caustic.h"
+#include "ray_tracer.h"
+#include "thread_pool.h"
+
+#ifdef WINDOWS
+#include <cairo.h>
+#else
+#include <cairo/cairo.h>
+#endif
+
+#include <algorithm>
+
+/**
+ * Marsaglia's xorshift128 generator.  Each task gets its own, seeded from
+ * the pass and task numbers, so runs are repeatable.
+**/
+struct xorshift {
+	u32 x, y, z, w;
+	
+	explicit xorshift(u32 seed) {
+		// Spread the seed over the state with Wang's integer hash.
+		x = hash(seed);
+		y = hash(x);
+		z = hash(y);
+		w = hash(z) | 1;
+	}
+	
+	u32 next() {
+		const u32 t = x ^ (x << 11);
+		x = y;
+		y = z;
+		z = w;
+		w = w ^ (w >> 19) ^ t ^ (t >> 8);
+		return w;
+	}
+	
+	/**
+	 * Get a number in [0, 1).
+	**/
+	f64 uniform() {
+		return next() * (1.0 / 4294967296.0);
+	}
+	
+	static u32 hash(u32 a) {
+		a = (a ^ 61) ^ (a >> 16);
+		a += a << 3;
+		a ^= a >> 4;
+		a *= 0x27d4eb2d;
+		a ^= a >> 15;
+		return a;
+	}
+};
+
+/**
+ * Arguments for tracing a pass on a thread pool, one task per grid.
+**/
+struct caustic_task {
+	caustic_map * map;
+	const ray_tracer * tracer;
+	const light_source * source;
+	size_t rays;
+	size_t tasks;
+};
+
+void caustic_map::trace_chunk(void * context, size_t begin, size_t end) {
+	caustic_task& task = *static_cast<caustic_task *>(context);
+	
+	for (size_t i = begin; i < end; ++i) {
+		task.map->trace_task(*task.tracer, *task.source,
+							 task.rays * i / task.tasks, task.rays * (i + 1) / task.tasks, u32(i));
+	}
+}
+
+caustic_map::caustic_map()
+		: m_cell_size(1.0)
+		, m_width(0)
+		, m_height(0)
+		, m_ray_count(0)
+		, m_pass(0)
+		, m_exposure(1.0)
+		, m_surface(0)
+		, m_surface_stale(true) {
+}
+
+caustic_map::~caustic_map() {
+	if (m_surface) cairo_surface_destroy(m_surface);
+}
+
+void caustic_map::resize(const vector2dd& origin, f64 cell_size, u32 width, u32 height) {
+	m_origin = origin;
+	m_cell_size = cell_size;
+	m_width = width;
+	m_height = height;
+	
+	m_cells.assign(size_t(width) * height, 0.0f);
+	m_thread_cells.clear();
+	
+	if (m_surface) {
+		cairo_surface_destroy(m_surface);
+		m_surface = 0;
+	}
+	
+	clear();
+}
+
+void caustic_map::clear() {
+	std::fill(m_cells.begin(), m_cells.end(), 0.0f);
+	m_ray_count = 0;
+	m_pass = 0;
+	m_surface_stale = true;
+}
+
+void caustic_map::trace(const ray_tracer& tracer, const light_source& source, size_t rays, thread_pool * pool) {
+	if (m_cells.empty() || rays == 0) return;
+	
+	const size_t tasks = pool ? pool->size() : 1;
+	m_thread_cells.resize(tasks);
+	for (size_t i = 0; i < tasks; ++i) {
+		m_thread_cells[i].assign(m_cells.size(), 0.0f);
+	}
+	
+	caustic_task task;
+	task.map = this;
+	task.tracer = &tracer;
+	task.source = &source;
+	task.rays = rays;
+	task.tasks = tasks;
+	
+	if (pool) pool->parallel_for(tasks, 1, &trace_chunk, &task);
+	else trace_chunk(&task, 0, 1);
+	
+	// Sum the grids.
+	for (size_t i = 0; i < tasks; ++i) {
+		const f32 * src = &m_thread_cells[i][0];
+		f32 * dst = &m_cells[0];
+		
+		for (size_t cell = 0; cell < m_cells.size(); ++cell) {
+			dst[cell] += src[cell];
+		}
+	}
+	
+	m_ray_count += rays;
+	++m_pass;
+	m_surface_stale = true;
+}
+
+/**
+ * Trace rays [begin, end) of a pass into a task's grid.
+**/
+void caustic_map::trace_task(const ray_tracer& tracer, const light_source& source, size_t begin, size_t end, u32 task) {
+	const optical_system& system = tracer.system();
+	const f64 * indices = system.indices();
+	std::vector<f32>& cells = m_thread_cells[task];
+	
+	xorshift random(m_pass * 0x9e3779b9u + task);
+	
+	vector2dd across(-source.direction.y, source.direction.x);
+	across.normalize();
+	const f64 base_angle = atan2(source.direction.y, source.direction.x);
+	
+	ray_state state;
+	ray_hit hit;
+	for (size_t ray = begin; ray < end; ++ray) {
+		state.start = source.origin + (random.uniform() - 0.5) * source.width * across;
+		const f64 angle = base_angle + (random.uniform() - 0.5) * source.spread;
+		state.dir.set(cos(angle), sin(angle));
+		state.gap = system.gap_at(state.start);
+		state.from = ray_tracer::k_no_surface;
+		
+		bool escaped = false;
+		
+		for (u32 cast = 0; cast < tracer.cast_limit(); ++cast) {
+			const ray_tracer::step_result result = tracer.step(state, hit);
+			if (result == ray_tracer::k_step_escaped) {
+				escaped = true;
+				break;
+			}
+			
+			if (result == ray_tracer::k_step_blocked) break;
+			
+			/* Fresnel reflectance for unpolarized light, the mean of the s and
+			 * p reflectances:
+			 * 
+			 * r_s = (eta cos_i - cos_t) / (eta cos_i + cos_t)
+			 * r_p = (eta cos_t - cos_i) / (eta cos_t + cos_i)
+			 * 
+			 * with eta = n_1 / n_2.  Past the critical angle it is 1.
+			**/
+			const f64 eta = indices[state.gap] / indices[state.gap_across()];
+			const f64 cos_i = abs_(hit.normal.dot_product(state.dir));
+			const f64 sin_t_sq = eta * eta * (1.0 - cos_i * cos_i);
+			
+			f64 reflectance = 1.0;
+			if (sin_t_sq < 1.0) {
+				const f64 cos_t = sqrt(1.0 - sin_t_sq);
+				
+				const f64 r_s = (eta * cos_i - cos_t) / (eta * cos_i + cos_t);
+				const f64 r_p = (eta * cos_t - cos_i) / (eta * cos_t + cos_i);
+				reflectance = 0.5 * (r_s * r_s + r_p * r_p);
+			}
+			
+			if (random.uniform() < reflectance) tracer.reflect(state, hit);
+			else tracer.refract(state, hit, eta);
+		}
+		
+		if (escaped) splat(state.start, state.dir, cells);
+	}
+}
+
+/**
+ * Add the length of a ray through each cell it crosses.
+ * 
+ * The ray is walked one cell at a time along its major axis.  It moves at
+ * most one cell along the other axis per step, so each step covers one or
+ * two cells, and the step's length is split between them where the ray
+ * crosses from one to the other.
+**/
+void caustic_map::splat(const vector2dd& start, const vector2dd& dir, std::vector<f32>& cells) const {
+	// Into cell coordinates.
+	const vector2dd p = (start - m_origin) / m_cell_size;
+	const f64 dir_v[2] = { dir.x, dir.y };
+	const f64 p_v[2] = { p.x, p.y };
+	const s32 size_v[2] = { s32(m_width), s32(m_height) };
+	
+	// Clip the ray to the grid.
+	f64 t_enter = 0.0;
+	f64 t_exit = 1e30;
+	
+	for (u32 axis = 0; axis < 2; ++axis) {
+		if (iszero(dir_v[axis], 1e-12)) {
+			if (p_v[axis] < 0.0 || p_v[axis] >= size_v[axis]) return;
+			continue;
+		}
+		
+		f64 t_0 = -p_v[axis] / dir_v[axis];
+		f64 t_1 = (size_v[axis] - p_v[axis]) / dir_v[axis];
+		if (t_0 > t_1) std::swap(t_0, t_1);
+		
+		t_enter = max_(t_enter, t_0);
+		t_exit = min_(t_exit, t_1);
+	}
+	
+	if (t_enter >= t_exit) return;
+	
+	const u32 major = (abs_(dir.x) >= abs_(dir.y)) ? 0 : 1;
+	const u32 minor = 1 - major;
+	const size_t major_stride = (major == 0) ? 1 : m_width;
+	const size_t minor_stride = (major == 0) ? m_width : 1;
+	const s32 minor_last = size_v[minor] - 1;
+	
+	// Walk the major axis upwards, whichever way the ray points.
+	f64 a_0 = p_v[major] + t_enter * dir_v[major];
+	f64 a_1 = p_v[major] + t_exit * dir_v[major];
+	f64 b_0 = p_v[minor] + t_enter * dir_v[minor];
+	f64 b_1 = p_v[minor] + t_exit * dir_v[minor];
+	
+	if (a_0 > a_1) {
+		std::swap(a_0, a_1);
+		std::swap(b_0, b_1);
+	}
+	
+	if (a_1 - a_0 < 1e-12) return;
+	
+	const f64 slope = (b_1 - b_0) / (a_1 - a_0);
+	const f64 length = (t_exit - t_enter) / (a_1 - a_0); // Ray length per cell along the major axis.
+	
+	const s32 first = max_(s32(floor(a_0)), s32(0));
+	const s32 last = min_(s32(ceil(a_1)), size_v[major]) - 1;
+	
+	for (s32 a = first; a <= last; ++a) {
+		const f64 seg_0 = max_(a_0, f64(a));
+		const f64 seg_1 = min_(a_1, f64(a + 1));
+		const f64 seg_length = (seg_1 - seg_0) * length;
+		
+		const f64 y_0 = b_0 + (seg_0 - a_0) * slope;
+		const f64 y_1 = b_0 + (seg_1 - a_0) * slope;
+		// Truncation is floor here, anything below 0 clamps to row 0 anyway.
+		const s32 row_0 = clamp(s32(y_0), s32(0), minor_last);
+		const s32 row_1 = clamp(s32(y_1), s32(0), minor_last);
+		
+		f32 * column = &cells[a * major_stride];
+		
+		if (row_0 == row_1) {
+			column[row_0 * minor_stride] += f32(seg_length);
+		} else {
+			// Split at the boundary between the rows.
+			const f64 split = (max_(row_0, row_1) - y_0) / (y_1 - y_0);
+			column[row_0 * minor_stride] += f32(seg_length * split);
+			column[row_1 * minor_stride] += f32(seg_length * (1.0 - split));
+		}
+	}
+}
+
+cairo_surface_t * caustic_map::surface() {
+	if (m_width == 0 || m_height == 0) return 0;
+	
+	if (!m_surface) {
+		m_surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24, m_width, m_height);
+		m_surface_stale = true;
+	}
+	
+	if (!m_surface_stale) return m_surface;
+	
+	cairo_surface_flush(m_surface);
+	
+	u8 * data = cairo_image_surface_get_data(m_surface);
+	const s32 stride = cairo_image_surface_get_stride(m_surface);
+	
+	// A beam filling the height puts about ray_count / height in each cell.
+	const f64 scale = m_ray_count ? m_exposure * m_height / m_ray_count : 0.0;
+	
+	for (u32 y = 0; y < m_height; ++y) {
+		u32 * row = reinterpret_cast<u32 *>(data + y * stride);
+		const f32 * src = &m_cells[size_t(y) * m_width];
+		
+		for (u32 x = 0; x < m_width; ++x) {
+			// Map the unbounded energy into [0, 255) with 1 - e^-v.
+			const u32 value = u32(255.0 * (1.0 - exp(-src[x] * scale)));
+			row[x] = (value << 16) | (value << 8) | value;
+		}
+	}
+	
+	cairo_surface_mark_dirty(m_surface);
+	m_surface_stale = false;
+	
+	return m_surface;
+}
@@ -0,0 +1,153 @@
+/*
+ * caustic.h
+ * Lens Refraction
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+#ifndef _CAUSTIC_H
+#define _CAUSTIC_H
+
+typedef struct _cairo_surface cairo_surface_t;
+
+#include "vector2d.h"
+#include <vector>
+using namespace donner;
+
+class ray_tracer;
+class thread_pool;
+
+/**
+ * Where the rays of a caustic_map start: evenly along a segment across the
+ * mean direction, fanning out over an angle.  A width of 0 gives a point
+ * source and a spread of 0 a parallel beam.
+**/
+struct light_source {
+	light_source()
+			: origin(0.0, 0.0)
+			, direction(1.0, 0.0)
+			, width(0.0)
+			, spread(0.0) {
+	}
+	
+	vector2dd origin;		/// Center of the segment, in meters.
+	vector2dd direction;	/// Mean direction of the rays.
+	f64 width;				/// Length of the segment, in meters.
+	f64 spread;				/// Angle the rays fan out over, in radians.
+};
+
+/**
+ * Accumulates where light goes after it leaves an optical system.
+ * 
+ * Random rays from a light_source are traced through the system.  At each
+ * surface a ray reflects with the probability given by the Fresnel
+ * equations and refracts otherwise, so on average the energy splits as it
+ * would between the two.  Each ray that escapes is drawn into a grid of
+ * cells, adding the length it travels through each cell, which is
+ * proportional to the energy passing through.
+ * 
+ * Calling trace() repeatedly refines the same map, and surface() shows the
+ * result so far.
+**/
+class caustic_map {
+public:
+	caustic_map();
+	~caustic_map();
+	
+	/**
+	 * Set the area the map covers, which clears it.
+	 * 
+	 * @param	origin		Corner of the first cell, in meters.
+	 * @param	cell_size	Width and height of a cell, in meters.
+	 * @param	width		Number of cells across.
+	 * @param	height		Number of cells down.
+	**/
+	void resize(const vector2dd& origin, f64 cell_size, u32 width, u32 height);
+	
+	/**
+	 * Clear the map, to start again with a new system or source.
+	**/
+	void clear();
+	
+	/**
+	 * Trace more rays into the map.  Each thread accumulates into its own
+	 * grid, and the grids are summed once every ray is done.
+	 * 
+	 * @param	tracer	System to trace through.  Its cast limit is the most
+	 * 					surfaces a ray may meet.
+	 * @param	source	Where the rays start.
+	 * @param	rays	Number of rays to add.
+	 * @param	pool	Threads to trace on, or null to trace on the calling
+	 * 					thread.
+	**/
+	void trace(const ray_tracer& tracer, const light_source& source, size_t rays, thread_pool * pool = 0);
+	
+	u32 width() const { return m_width; }
+	u32 height() const { return m_height; }
+	
+	/**
+	 * Get the total number of rays traced into the map.
+	**/
+	size_t ray_count() const { return m_ray_count; }
+	
+	/**
+	 * Get the cells, row by row, holding the length of escaped rays through
+	 * each, in cells.
+	**/
+	const f32 * cells() const { return m_cells.empty() ? 0 : &m_cells[0]; }
+	
+	/// Gets/sets the brightness of surface().  At 1, a cell that rays cross
+	/// as densely as a parallel beam filling the height of the map is about
+	/// 63% white.
+	f64 exposure() const { return m_exposure; }
+	void exposure(f64 exposure) { m_exposure = exposure; m_surface_stale = true; }
+	
+	/**
+	 * Get the map as an image, one pixel per cell, updated to include every
+	 * ray traced so far.  The surface is owned by the map and stays valid
+	 * until the next resize().
+	**/
+	cairo_surface_t * surface();
+	
+private:
+	vector2dd m_origin;
+	f64 m_cell_size;
+	u32 m_width;
+	u32 m_height;
+	
+	std::vector<f32> m_cells;
+	std::vector<std::vector<f32> > m_thread_cells; // One grid per task.
+	
+	size_t m_ray_count;
+	u32 m_pass;
+	f64 m_exposure;
+	
+	cairo_surface_t * m_surface;
+	bool m_surface_stale;
+	
+	static void trace_chunk(void * context, size_t begin, size_t end);
+	void trace_task(const ray_tracer& tracer, const light_source& source, size_t begin, size_t end, u32 task);
+	void splat(const vector2dd& start, const vector2dd& dir, std::vector<f32>& cells) const;
+	
+	// Not copyable.
+	caustic_map(const caustic_map&);
+	caustic_map& operator=(const caustic_map&);
+};
+
+#endif // _CAUSTIC_H
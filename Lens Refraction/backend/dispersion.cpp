@@ -0,0 +1,125 @@
+/*
+ * dispersion.cpp
+ * Lens Refraction
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+#include "dispersion.h"
+
+/// Fraunhofer F and C lines, which the Abbe number is measured between.
+static const f64 k_f_line = 0.4861; // Micrometers.
+static const f64 k_c_line = 0.6563; // Micrometers.
+
+dispersion dispersion::cauchy(f64 a, f64 b, f64 c) {
+	dispersion d(a);
+	d.m_model = k_cauchy;
+	d.m_coeff[1] = b;
+	d.m_coeff[2] = c;
+	return d;
+}
+
+dispersion dispersion::abbe(f64 n_d, f64 v_d) {
+	// n_F - n_C = B (1 / l_F^2 - 1 / l_C^2), then A puts n_d at the reference.
+	const f64 b = (n_d - 1.0) / (v_d * (1.0 / (k_f_line * k_f_line) - 1.0 / (k_c_line * k_c_line)));
+	const f64 l_d = k_reference_wavelength * 0.001;
+	
+	return cauchy(n_d - b / (l_d * l_d), b);
+}
+
+dispersion dispersion::sellmeier(f64 b_1, f64 b_2, f64 b_3, f64 c_1, f64 c_2, f64 c_3) {
+	dispersion d;
+	d.m_model = k_sellmeier;
+	d.m_coeff[0] = b_1;
+	d.m_coeff[1] = b_2;
+	d.m_coeff[2] = b_3;
+	d.m_coeff[3] = c_1;
+	d.m_coeff[4] = c_2;
+	d.m_coeff[5] = c_3;
+	return d;
+}
+
+f64 dispersion::n(f64 wavelength) const {
+	const f64 l = wavelength * 0.001; // To micrometers.
+	const f64 l_sq = l * l;
+	
+	switch (m_model) {
+		case k_cauchy:
+			return m_coeff[0] + m_coeff[1] / l_sq + m_coeff[2] / (l_sq * l_sq);
+		
+		case k_sellmeier: {
+			f64 n_sq = 1.0;
+			for (u32 i = 0; i < 3; ++i) {
+				n_sq += m_coeff[i] * l_sq / (l_sq - m_coeff[i + 3]);
+			}
+			
+			return sqrt(n_sq);
+		}
+		
+		default:
+			return m_coeff[0];
+	}
+}
+
+void visible_wavelengths(size_t count, f64 * out) {
+	const f64 step = (k_visible_max_wavelength - k_visible_min_wavelength) / count;
+	
+	for (size_t i = 0; i < count; ++i) {
+		out[i] = k_visible_min_wavelength + (i + 0.5) * step;
+	}
+}
+
+/**
+ * Piecewise linear fit of the spectral colors, after Dan Bruton's
+ * "Approximate RGB values for visible wavelengths".
+**/
+void wavelength_to_rgb(f64 wavelength, f64& r, f64& g, f64& b) {
+	const f64 l = wavelength;
+	r = g = b = 0.0;
+	
+	if (l < k_visible_min_wavelength || l > k_visible_max_wavelength) return;
+	
+	if (l < 440.0) {
+		r = (440.0 - l) / (440.0 - 380.0);
+		b = 1.0;
+	} else if (l < 490.0) {
+		g = (l - 440.0) / (490.0 - 440.0);
+		b = 1.0;
+	} else if (l < 510.0) {
+		g = 1.0;
+		b = (510.0 - l) / (510.0 - 490.0);
+	} else if (l < 580.0) {
+		r = (l - 510.0) / (580.0 - 510.0);
+		g = 1.0;
+	} else if (l < 645.0) {
+		r = 1.0;
+		g = (645.0 - l) / (645.0 - 580.0);
+	} else {
+		r = 1.0;
+	}
+	
+	// Fade out where the eye is less sensitive.
+	f64 intensity = 1.0;
+	if (l < 420.0) intensity = 0.3 + 0.7 * (l - 380.0) / (420.0 - 380.0);
+	else if (l > 700.0) intensity = 0.3 + 0.7 * (780.0 - l) / (780.0 - 700.0);
+	
+	r *= intensity;
+	g *= intensity;
+	b *= intensity;
+}
@@ -0,0 +1,108 @@
+/*
+ * dispersion.h
+ * Lens Refraction
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+#ifndef _DISPERSION_H
+#define _DISPERSION_H
+
+#include "mathutil.h"
+#include <cstddef>
+using namespace donner;
+
+/// Wavelength refractive indices are usually quoted at, the sodium D line.
+static const f64 k_reference_wavelength = 589.3; // Nanometers.
+
+/// Ends of the visible spectrum.
+static const f64 k_visible_min_wavelength = 380.0; // Nanometers.
+static const f64 k_visible_max_wavelength = 780.0; // Nanometers.
+
+/**
+ * How the refractive index of a material varies with wavelength.
+ * 
+ * Wavelengths are given in nanometers, the coefficients use micrometers as
+ * is usual for published values.
+**/
+class dispersion {
+public:
+	enum model {
+		k_constant = 0,	/// The same index at every wavelength.
+		k_cauchy = 1,	/// n = A + B / l^2 + C / l^4
+		k_sellmeier = 2	/// n^2 = 1 + sum of B_i l^2 / (l^2 - C_i)
+	};
+	
+	/**
+	 * A material with a constant index.  Not explicit, so an index can be
+	 * used wherever a dispersion is expected.
+	**/
+	dispersion(f64 n = 1.0)
+			: m_model(k_constant) {
+		m_coeff[0] = n;
+		for (u32 i = 1; i < 6; ++i) m_coeff[i] = 0.0;
+	}
+	
+	/**
+	 * Cauchy's equation, with B in um^2 and C in um^4.
+	**/
+	static dispersion cauchy(f64 a, f64 b, f64 c = 0.0);
+	
+	/**
+	 * Fit Cauchy's equation to an index at the reference wavelength and an
+	 * Abbe number, V = (n_d - 1) / (n_F - n_C).
+	**/
+	static dispersion abbe(f64 n_d, f64 v_d);
+	
+	/**
+	 * The three-term Sellmeier equation, with C_i in um^2.
+	**/
+	static dispersion sellmeier(f64 b_1, f64 b_2, f64 b_3, f64 c_1, f64 c_2, f64 c_3);
+	
+	model kind() const { return m_model; }
+	
+	/**
+	 * Get the refractive index at a wavelength, in nanometers.
+	**/
+	f64 n(f64 wavelength) const;
+	
+	/**
+	 * Get the index at the reference wavelength.
+	**/
+	f64 n() const { return n(k_reference_wavelength); }
+	
+private:
+	model m_model;
+	f64 m_coeff[6];
+};
+
+/**
+ * Fill an array with wavelengths spread evenly over the visible spectrum,
+ * each in the middle of an equal band.
+**/
+void visible_wavelengths(size_t count, f64 * out);
+
+/**
+ * Get the color of a wavelength as linear RGB between 0 and 1, fading out
+ * towards the ends of the visible spectrum.  When summing several
+ * wavelengths, divide by the sum of their colors to keep white light white.
+**/
+void wavelength_to_rgb(f64 wavelength, f64& r, f64& g, f64& b);
+
+#endif // _DISPERSION_H
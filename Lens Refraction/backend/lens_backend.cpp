@@ -22,6 +22,8 @@
 **/
 
 #include "lens_backend.h"
+#include "ray_tracer.h"
+#include "thread_pool.h"
 
 #ifdef WINDOWS
 #include <cairo.h>
@@ -29,31 +31,123 @@
 #include <cairo/cairo.h>
 #endif
 
-bool circle::ray_intersect(vector2dd start, vector2dd dir, vector2dd& intersection, vector2dd& normal) {
-	start -= center; // Change the coordinate to be in circle-space.
-	dir.normalize();
+/**
+ * Get the half-angle a lens side spans on its circle, and how far the arc
+ * bulges from its ends.
+**/
+static void lens_side_shape(f64 radius, f32& theta, f32& arc_w) {
+	theta = asin(k_lens_half_height / radius);
+	arc_w = radius * (1.0 - abs_(cos(theta)));
+}
+
+/**
+ * Build the circles for the surfaces of the lens, in meters.
+ * 
+ * @param	center	Center of the lens, in pixels.
+**/
+void lens_backend::build_surfaces(const vector2dd& center, circle& left_circle, circle& right_circle) const {
+	f32 theta, arc_w;
 	
-	f64 a = 1.0; // Length of dir.
-	f64 b = 2.0 * start.dot_product(dir);
-	f64 c = start.length_sq() - radius * radius;
+	// Left half of the lens.
+	left_circle.radius = abs_(m_left_radius);
+	lens_side_shape(left_circle.radius, theta, arc_w);
+	left_circle.center = center;
 	
-	if (b * b < 4.0 * a * c) return false; // sqrt is negative.
+	if (m_left_radius < 0.0f) {
+		left_circle.center.x += m_left_radius * k_meters_to_pixels;
+		left_circle.set_arc(-theta, theta);
+		left_circle.convex = false;
+	} else {
+		left_circle.center.x += (m_left_radius - arc_w) * k_meters_to_pixels;
+		left_circle.set_arc(PI64 - theta, PI64 + theta);
+		left_circle.convex = true;
+	}
+	
+	left_circle.center /= k_meters_to_pixels;
 	
-	// Apply the quadratic formula to find t.
-	f64 t_1 = (-b + sqrt(b * b - 4.0 * a * c)) / (2.0 * a);
-	f64 t_2 = (-b - sqrt(b * b - 4.0 * a * c)) / (2.0 * a);
+	// Right half of the lens.
+	right_circle.radius = abs_(m_right_radius);
+	lens_side_shape(right_circle.radius, theta, arc_w);
+	right_circle.center = center;
 	
-	if (t_2 < t_1) {
-		// Swap t_1 and t_2 ...
-		f64 tmp = t_1;
-		t_1 = t_2;
-		t_2 = tmp;
+	if (m_right_radius < 0.0f) {
+		right_circle.center.x -= m_right_radius * k_meters_to_pixels;
+		right_circle.set_arc(PI64 - theta, PI64 + theta);
+		right_circle.convex = false;
+	} else {
+		right_circle.center.x -= (m_right_radius - arc_w) * k_meters_to_pixels;
+		right_circle.set_arc(-theta, theta);
+		right_circle.convex = true;
 	}
 	
-	if (ray_intersect_validate(start, dir, t_1, intersection, normal)) return true;
-	if (ray_intersect_validate(start, dir, t_2, intersection, normal)) return true;
+	right_circle.center /= k_meters_to_pixels;
+}
+
+/**
+ * Build the lens as an optical system.
+ * 
+ * @param	center	Center of the lens, in pixels.
+**/
+void lens_backend::build_system(const vector2dd& center, optical_system& out) const {
+	circle left_circle, right_circle;
+	build_surfaces(center, left_circle, right_circle);
+	
+	out.clear(m_outside_material);
+	out.add_spherical(left_circle, m_inside_material);
+	out.add_spherical(right_circle, m_outside_material);
+}
+
+/**
+ * Get the lens as an optical system, rebuilding it if it is out of date.
+ * 
+ * @param	center	Center of the lens, in pixels.
+**/
+const optical_system& lens_backend::system(const vector2dd& center) {
+	if (m_system_dirty || center != m_system_center) {
+		build_system(center, m_system);
+		
+		m_system_center = center;
+		m_system_dirty = false;
+		m_caustics_stale = true;
+	}
 	
-	return false;
+	return m_system;
+}
+
+/**
+ * Get a tracer for the lens.
+ * 
+ * @param	center	Center of the lens, in pixels.
+**/
+ray_tracer lens_backend::tracer(const vector2dd& center) {
+	return ray_tracer(system(center));
+}
+
+lens_backend::~lens_backend() {
+	delete m_pool;
+}
+
+paraxial_lens lens_backend::paraxial() const {
+	f32 theta, left_w, right_w;
+	lens_side_shape(abs_(m_left_radius), theta, left_w);
+	lens_side_shape(abs_(m_right_radius), theta, right_w);
+	
+	// Only convex sides bulge past the center, see build_surfaces().
+	const f64 front_vertex = (m_left_radius < 0.0f) ? 0.0 : -left_w;
+	const f64 back_vertex = (m_right_radius < 0.0f) ? 0.0 : right_w;
+	
+	// A positive left radius has its center to the right, a positive right
+	// radius to the left.
+	return paraxial_single(1.0 / m_left_radius, -1.0 / m_right_radius, front_vertex, back_vertex,
+						   m_inside_material.n(), m_outside_material.n());
+}
+
+focus_result lens_backend::best_focus(u32 rays, f64 aperture) const {
+	optical_system lens;
+	build_system(vector2dd(0.0, 0.0), lens);
+	
+	const paraxial_lens guess = paraxial();
+	return find_best_focus(ray_tracer(lens), guess.front_vertex - 1.0, 0.0, aperture * k_lens_half_height, rays);
 }
 
 /**
@@ -62,171 +156,208 @@ bool circle::ray_intersect(vector2dd start, vector2dd dir, vector2dd& intersecti
 void lens_backend::render(cairo_t * context, const vector2dd& size) {
 	vector2dd center(size * 0.5);
 	
+	const optical_system& lens = system(center);
+	const circle& left_circle = lens.surface(0).arc;
+	const circle& right_circle = lens.surface(1).arc;
+	
+	if (m_show_caustics) render_caustics(context, size, center);
+	
 	cairo_set_source_rgb(context, 1.0, 1.0, 1.0);
 	cairo_move_to(context, center.x, center.y + k_lens_half_height * k_meters_to_pixels);
 	
-	// Left half of the lens.
-	circle left_circle;
+	f32 theta, arc_w;
 	
+	// Left half of the lens.
 	{
-		left_circle.radius = abs_(m_left_radius);
-		
-		f32 theta = asin(k_lens_half_height / left_circle.radius);
-		f32 arc_w = left_circle.radius * (1.0 - abs_(cos(theta)));
+		const vector2dd arc_center = left_circle.center * k_meters_to_pixels;
+		lens_side_shape(left_circle.radius, theta, arc_w);
 		
 		// Draw a concave curve with lines connecting it to the horizontal center line.
-		if (m_left_radius < 0.0f) {
-			left_circle.center = center;
-			left_circle.center.x += m_left_radius * k_meters_to_pixels;
-			
+		if (!left_circle.convex) {
 			cairo_rel_line_to(context, -arc_w * k_meters_to_pixels, 0.0f);
-			cairo_arc_negative(context, left_circle.center.x, left_circle.center.y, left_circle.radius * k_meters_to_pixels, theta, -theta);
+			cairo_arc_negative(context, arc_center.x, arc_center.y, left_circle.radius * k_meters_to_pixels, left_circle.theta_end, left_circle.theta_start);
 			cairo_line_to(context, center.x, center.y - k_lens_half_height * k_meters_to_pixels);
 			
-			left_circle.theta_start = -theta;
-			left_circle.theta_end = theta;
-			left_circle.convex = false;
-			
 		// Draw a convex curve.
 		} else {
-			left_circle.center = center;
-			left_circle.center.x += (m_left_radius - arc_w) * k_meters_to_pixels;
-			
-			cairo_arc(context, left_circle.center.x, left_circle.center.y, m_left_radius * k_meters_to_pixels, PI64 - theta, PI64 + theta);
-			left_circle.theta_start = PI64 - theta;
-			left_circle.theta_end = PI64 + theta;
-			
-			left_circle.convex = true;
+			cairo_arc(context, arc_center.x, arc_center.y, left_circle.radius * k_meters_to_pixels, left_circle.theta_start, left_circle.theta_end);
 		}
-		
-		left_circle.center /= k_meters_to_pixels;
 	}
 	
-	
 	// Right half of the lens.
-	circle right_circle;
-	
 	{
-		right_circle.radius = abs_(m_right_radius);
-		
-		f32 theta = asin(k_lens_half_height / right_circle.radius);
-		f32 arc_w = right_circle.radius * (1.0 - abs_(cos(theta)));
+		const vector2dd arc_center = right_circle.center * k_meters_to_pixels;
+		lens_side_shape(right_circle.radius, theta, arc_w);
 		
 		// Draw a concave curve with lines connecting it to the horizontal center line.
-		if (m_right_radius < 0.0f) {
-			right_circle.center = center;
-			right_circle.center.x -= m_right_radius * k_meters_to_pixels;
-			
+		if (!right_circle.convex) {
 			cairo_rel_line_to(context, arc_w * k_meters_to_pixels, 0.0f);
-			cairo_arc_negative(context, right_circle.center.x, right_circle.center.y, right_circle.radius * k_meters_to_pixels, PI64 + theta, PI64 - theta);
-			
-			right_circle.theta_start = PI64 - theta;
-			right_circle.theta_end = PI64 + theta;
-			right_circle.convex = false;
+			cairo_arc_negative(context, arc_center.x, arc_center.y, right_circle.radius * k_meters_to_pixels, right_circle.theta_end, right_circle.theta_start);
 			
 		// Draw a convex curve.
 		} else {
-			right_circle.center = center;
-			right_circle.center.x -= (m_right_radius - arc_w) * k_meters_to_pixels;
-			cairo_arc(context, right_circle.center.x, right_circle.center.y, m_right_radius * k_meters_to_pixels, -theta, theta);
-			
-			right_circle.theta_start = -theta;
-			right_circle.theta_end = theta;
-			right_circle.convex = true;
+			cairo_arc(context, arc_center.x, arc_center.y, right_circle.radius * k_meters_to_pixels, right_circle.theta_start, right_circle.theta_end);
 		}
-		
-		right_circle.center /= k_meters_to_pixels;
 	}
 	
 	cairo_close_path(context);
 	cairo_stroke(context);
 	
-	// Now do raycasts to determine the intersections.
-	cairo_set_line_width(context, 1.0);
+	if (m_show_caustics) return;
 	
+	// Trace rays across the lens, then draw their paths.
+	ray_bundle rays;
 	for (f64 y_offset = -0.5; y_offset <= 0.5; y_offset += 0.1) {
-		vector2dd ray_start(0.0, center.y / k_meters_to_pixels + y_offset);
-		vector2dd ray_dir(1.0, 0.0);
+		rays.add(vector2dd(0.0, center.y / k_meters_to_pixels + y_offset), vector2dd(1.0, 0.0));
+	}
+	
+	if (m_spectral_bands > 0) {
+		std::vector<f64> wavelengths(m_spectral_bands);
+		visible_wavelengths(m_spectral_bands, &wavelengths[0]);
 		
-		vector2dd intersection;
-		vector2dd normal;
-		bool inside = false;
-			
-		u32 i = 0;
-		const u32 k_cast_limit = 10;
+		spectral_result paths;
+		ray_tracer(lens).trace(rays, &wavelengths[0], m_spectral_bands, paths);
 		
-		// Start raycasting, up to a maximum of ten hits.
-		while (++i <= k_cast_limit) {
-			bool intersect = false;
-			
-			if (((!inside && ray_dir.x >= 0.0) // Intersect with left half if the direction is in the +x and start point is outside lens.
-					|| (inside && ray_dir.x <= 0.0)) // Intersect with left half if the direction is in the -x and start point is inside lens.
-					&& left_circle.ray_intersect(ray_start, ray_dir, intersection, normal)) {
-				intersect = true;
-			} else if (((!inside && ray_dir.x <= 0.0) // Intersect with right half if the direction is in the -x and start point is outside lens.
-						|| (inside && ray_dir.x >= 0.0)) // Intersect with right half if the direction is in the +x and start point is inside lens.
-						&& right_circle.ray_intersect(ray_start, ray_dir, intersection, normal)) {
-				intersect = true;
-			}
-			
-			if (!intersect) break;
+		render_spectral_paths(context, size, rays, paths);
+	} else {
+		trace_result paths;
+		ray_tracer(lens).trace(rays, paths);
+		
+		render_paths(context, size, rays, paths);
+	}
+}
+
+/**
+ * Draw traced rays, with the normal at each hit.
+**/
+void lens_backend::render_paths(cairo_t * context, const vector2dd& size, const ray_bundle& rays, const trace_result& paths) const {
+	cairo_set_line_width(context, 1.0);
+	
+	for (size_t ray = 0; ray < paths.size(); ++ray) {
+		vector2dd ray_start = rays.start(ray);
+		
+		const ray_hit * hits = paths.hits(ray);
+		for (u32 i = 0; i < paths.hit_count(ray); ++i) {
+			const ray_hit& hit = hits[i];
 			
 			// Set the line color to red.
 			cairo_set_source_rgb(context, 1.0, 0.0, 0.0);
 			
 			// Draw the ray.
 			cairo_move_to(context, ray_start.x * k_meters_to_pixels, ray_start.y * k_meters_to_pixels);
-			cairo_line_to(context, intersection.x * k_meters_to_pixels, intersection.y * k_meters_to_pixels);
+			cairo_line_to(context, hit.point.x * k_meters_to_pixels, hit.point.y * k_meters_to_pixels);
 			cairo_stroke(context);
 			
-			// Calculate the angle from the normal.
-			f64 theta = atan2(-ray_dir.y, -ray_dir.x) - atan2(normal.y, normal.x);
-			if (theta > PI64) theta -= 2.0 * PI64; // Normalize the angle so that it is between (-pi, pi].
-			if (theta <= -PI64) theta += 2.0 * PI64;
-			
-			// Flip the normal if the separation is more than 90 degrees.
-			if (abs_(theta) > 0.5 * PI64) {
-				normal = -normal;
-				theta = atan2(-ray_dir.y, -ray_dir.x) - atan2(normal.y, normal.x);
-			}
-			
 			// Draw the normal.
 			cairo_set_source_rgb(context, 0.5, 1.0, 0.5);
-			cairo_move_to(context, intersection.x * k_meters_to_pixels, intersection.y * k_meters_to_pixels);
-			cairo_rel_line_to(context, normal.x * k_meters_to_pixels * 0.1, normal.y * k_meters_to_pixels * 0.1);
+			cairo_move_to(context, hit.point.x * k_meters_to_pixels, hit.point.y * k_meters_to_pixels);
+			cairo_rel_line_to(context, hit.normal.x * k_meters_to_pixels * 0.1, hit.normal.y * k_meters_to_pixels * 0.1);
 			cairo_stroke(context);
 			
-			// Apply snell's law:
-			// n_1 sin(theta_1) = n_2 sin(theta_2)
-			// Which becomes: theta_2 = asin(n_1 / n_2 * sin(theta_1))
-			f64 amt = (inside ? (m_inside_n / m_outside_n) : (m_outside_n / m_inside_n)) * sin(theta);
-			if (abs_(amt) > 1.0) {
-				// Reflect along normal.
-				theta = -theta;
-			} else {
-				// Normal, refract through surface.
-				theta = asin(amt) + PI64;
-				inside = !inside;
-			}
-			
-			// Convert the angle back to absolute coordinates.
-			theta += atan2(normal.y, normal.x);
-			
-			// Set up the next raycast.
-			ray_start = intersection;
-			ray_dir.set(cos(theta), sin(theta));
+			ray_start = hit.point;
 		}
 		
-		if (i <= k_cast_limit) {
+		if (paths.escaped(ray)) {
 			// Draw final line.
+			const vector2dd& exit_start = paths.exit_start(ray);
+			const vector2dd& exit_dir = paths.exit_dir(ray);
 			f64 max_dim = max_(size.x, size.y);
 			
 			// Set the line color to blue.
 			cairo_set_source_rgb(context, 0.5, 0.5, 1.0);
 			
+			cairo_move_to(context, exit_start.x * k_meters_to_pixels, exit_start.y * k_meters_to_pixels);
+			cairo_rel_line_to(context, exit_dir.x * max_dim, exit_dir.y * max_dim);
+			cairo_stroke(context);
+		}
+	}
+}
+
+/**
+ * Draw rays traced at several wavelengths.
+**/
+void lens_backend::render_spectral_paths(cairo_t * context, const vector2dd& size, const ray_bundle& rays, const spectral_result& paths) const {
+	const size_t bands = paths.band_count();
+	const f64 max_dim = max_(size.x, size.y);
+	
+	// Scale the colors so that every band together adds up to white.
+	f64 total[3] = { 0.0, 0.0, 0.0 };
+	std::vector<f64> colors(bands * 3);
+	
+	for (size_t band = 0; band < bands; ++band) {
+		f64 * color = &colors[band * 3];
+		wavelength_to_rgb(paths.wavelength(band), color[0], color[1], color[2]);
+		
+		for (u32 c = 0; c < 3; ++c) total[c] += color[c];
+	}
+	
+	cairo_save(context);
+	cairo_set_operator(context, CAIRO_OPERATOR_ADD);
+	cairo_set_line_width(context, 1.0);
+	
+	for (size_t band = 0; band < bands; ++band) {
+		const trace_result& band_paths = paths.band(band);
+		const f64 * color = &colors[band * 3];
+		
+		cairo_set_source_rgb(context,
+							 iszero(total[0]) ? 0.0 : color[0] / total[0],
+							 iszero(total[1]) ? 0.0 : color[1] / total[1],
+							 iszero(total[2]) ? 0.0 : color[2] / total[2]);
+		
+		for (size_t ray = 0; ray < band_paths.size(); ++ray) {
+			const vector2dd ray_start = rays.start(ray);
 			cairo_move_to(context, ray_start.x * k_meters_to_pixels, ray_start.y * k_meters_to_pixels);
-			cairo_rel_line_to(context, ray_dir.x * max_dim, ray_dir.y * max_dim);
+			
+			const ray_hit * hits = band_paths.hits(ray);
+			for (u32 i = 0; i < band_paths.hit_count(ray); ++i) {
+				cairo_line_to(context, hits[i].point.x * k_meters_to_pixels, hits[i].point.y * k_meters_to_pixels);
+			}
+			
+			if (band_paths.escaped(ray)) {
+				const vector2dd& exit_dir = band_paths.exit_dir(ray);
+				cairo_rel_line_to(context, exit_dir.x * max_dim, exit_dir.y * max_dim);
+			}
+			
 			cairo_stroke(context);
 		}
 	}
+	
+	cairo_restore(context);
+}
+
+bool lens_backend::needs_redraw() const {
+	return m_show_caustics && m_caustics.ray_count() < m_caustic_limit;
+}
+
+/**
+ * Trace another pass of caustics and draw them, one cell per pixel.
+**/
+void lens_backend::render_caustics(cairo_t * context, const vector2dd& size, const vector2dd& center) {
+	const u32 width = u32(size.x);
+	const u32 height = u32(size.y);
+	
+	if (m_caustics.width() != width || m_caustics.height() != height) {
+		m_caustics.resize(vector2dd(0.0, 0.0), 1.0 / k_meters_to_pixels, width, height);
+	} else if (m_caustics_stale) {
+		m_caustics.clear();
+	}
+	
+	m_caustics_stale = false;
+	
+	if (m_caustics.ray_count() < m_caustic_limit) {
+		if (!m_pool) m_pool = new thread_pool();
+		
+		light_source source = m_caustic_source;
+		source.origin += center / k_meters_to_pixels;
+		
+		m_caustics.trace(tracer(center), source, m_caustic_rays, m_pool);
+	}
+	
+	cairo_surface_t * image = m_caustics.surface();
+	if (!image) return;
+	
+	cairo_save(context);
+	cairo_set_source_surface(context, image, 0.0, 0.0);
+	cairo_paint(context);
+	cairo_restore(context);
 }
@@ -26,76 +26,129 @@
 
 typedef struct _cairo cairo_t;
 
-#include "vector2d.h"
+#include "optical_system.h"
+#include "caustic.h"
+#include "paraxial.h"
+#include <string>
 #include <vector>
 using namespace donner;
 
+struct ray_bundle;
+class trace_result;
+class spectral_result;
+class thread_pool;
+class ray_tracer;
+
 static const f32 k_meters_to_pixels = 100.0f;
 static const f32 k_lens_half_height = 1.0f; // Meters.
 
-struct circle {
-	vector2dd center;
-	f64 radius;
-	
-	f64 theta_start;
-	f64 theta_end;
-	
-	bool convex; // Is this a convex or concave segment?
-	
-	bool ray_intersect(vector2dd start, vector2dd dir, vector2dd& intersection, vector2dd& normal);
-		
-private:
-	bool angle_in_range(f64 angle) {
-		angle -= theta_start;
-		f64 end = theta_end - theta_start;
-		if (angle < -PI64) angle += 2.0 * PI64;
-		
-		if (end < 0.0) return (angle >= end && angle <= 0.0);
-		else return (angle >= 0.0 && angle <= end);
-	}
-	
-	bool ray_intersect_validate(vector2dd start, vector2dd dir, f64 t, vector2dd& intersection, vector2dd& normal) {
-		if (t < 0.0) return false;
-		
-		intersection = start + t * dir;
-		
-		f64 angle = atan2(intersection.y, intersection.x);
-		if (!angle_in_range(angle)) return false;
-		
-		normal.set(cos(angle), sin(angle));
-		if (!convex) normal = -normal;
-		
-		intersection += center;
-		return true;
-	}
-};
-
 class lens_backend {
 public:
 	lens_backend()
 		: m_left_radius(1.5f),
 		  m_right_radius(1.5f),
 		  m_inside_n(1.5f),
-		  m_outside_n(1.0f) {
+		  m_outside_n(1.0f),
+		  m_inside_material(1.5),
+		  m_outside_material(1.0),
+		  m_spectral_bands(0),
+		  m_show_caustics(false),
+		  m_caustic_rays(1 << 16),
+		  m_caustic_limit(1 << 24),
+		  m_caustics_stale(true),
+		  m_pool(0),
+		  m_system_dirty(true) {
+		
+		// A beam from the left, a little taller than the lens.
+		m_caustic_source.origin.set(-3.5, 0.0);
+		m_caustic_source.direction.set(1.0, 0.0);
+		m_caustic_source.width = 2.4 * k_lens_half_height;
 		
-		// Build the presets array.
-		m_presets.push_back(index("Vacuum", 1.0f));
-		m_presets.push_back(index("Air @ STP", 1.0002926f));
-		m_presets.push_back(index("Helium (0°C, 1 atm)", 1.000036f));
-		m_presets.push_back(index("Hydrogen (0°C, 1 atm)", 1.000132f));
-		m_presets.push_back(index("Benzene (20°C)", 1.501f));
-		m_presets.push_back(index("Water (20°C)", 1.333f));
-		m_presets.push_back(index("Ethyl Alcohol (20°C)", 1.361f));
-		m_presets.push_back(index("Diamond", 2.419f));
-		m_presets.push_back(index("Water Ice", 1.31f));
-		m_presets.push_back(index("Silicon", 4.01f));
+		/* Build the presets array.  Gases, ice and silicon keep a constant
+		 * index, the liquids are fit to their Abbe numbers, and water and
+		 * diamond use published Sellmeier coefficients.
+		**/
+		m_presets.push_back(index("Vacuum", 1.0));
+		m_presets.push_back(index("Air @ STP", dispersion::cauchy(1.0002871, 1.628e-6)));
+		m_presets.push_back(index("Helium (0°C, 1 atm)", 1.000036));
+		m_presets.push_back(index("Hydrogen (0°C, 1 atm)", 1.000132));
+		m_presets.push_back(index("Benzene (20°C)", dispersion::abbe(1.501, 30.1)));
+		m_presets.push_back(index("Water (20°C)", dispersion::sellmeier(0.75831, 0.08495, 0.0, 0.01007, 8.91377, 0.0)));
+		m_presets.push_back(index("Ethyl Alcohol (20°C)", dispersion::abbe(1.361, 55.0)));
+		m_presets.push_back(index("Diamond", dispersion::sellmeier(4.3356, 0.3306, 0.0, 0.1060 * 0.1060, 0.1750 * 0.1750, 0.0)));
+		m_presets.push_back(index("Water Ice", 1.31));
+		m_presets.push_back(index("Silicon", 4.01));
 	}
 	
+	~lens_backend();
+	
 	/**
 	 * Called to render to the view.
 	**/
 	void render(cairo_t * context, const vector2dd& size);
 	
+	/**
+	 * Should the view be rendered again?  True while caustics are still
+	 * being refined.
+	**/
+	bool needs_redraw() const;
+	
+	/**
+	 * Build the circles for the surfaces of the lens, in meters.
+	 * 
+	 * @param	center	Center of the lens, in pixels.
+	**/
+	void build_surfaces(const vector2dd& center, circle& left_circle, circle& right_circle) const;
+	
+	/**
+	 * Build the lens as an optical system, in meters.
+	 * 
+	 * @param	center	Center of the lens, in pixels.
+	**/
+	void build_system(const vector2dd& center, optical_system& out) const;
+	
+	/**
+	 * Get the lens as an optical system, in meters.  It is only rebuilt when
+	 * a parameter or the center changes.
+	 * 
+	 * @param	center	Center of the lens, in pixels.
+	**/
+	const optical_system& system(const vector2dd& center);
+	
+	/**
+	 * Get a tracer for the lens, for tracing rays without rendering.  It
+	 * refers to the system, so it is only valid until a parameter changes.
+	 * 
+	 * @param	center	Center of the lens, in pixels.
+	**/
+	ray_tracer tracer(const vector2dd& center);
+	
+	/**
+	 * Get the paraxial properties of the lens, in O(1).  Positions are in
+	 * meters from the center of the lens.
+	**/
+	paraxial_lens paraxial() const;
+	
+	/**
+	 * Trace a beam parallel to the axis to find where it focuses best.
+	 * Positions are in meters from the center of the lens.
+	 * 
+	 * @param	rays		Number of rays in the beam.
+	 * @param	aperture	Height of the beam, as a fraction of the lens.
+	**/
+	focus_result best_focus(u32 rays = 16, f64 aperture = 0.5) const;
+	
+	/**
+	 * Draw traced rays, with the normal at each hit.
+	**/
+	void render_paths(cairo_t * context, const vector2dd& size, const ray_bundle& rays, const trace_result& paths) const;
+	
+	/**
+	 * Draw rays traced at several wavelengths, adding the color of each
+	 * band so that rays which stay together sum to white.
+	**/
+	void render_spectral_paths(cairo_t * context, const vector2dd& size, const ray_bundle& rays, const spectral_result& paths) const;
+	
 	/**
 	 * Called when the mouse is pressed.
 	**/
@@ -113,28 +166,62 @@ public:
 	
 	/*************************************************************************/
 	
+	/// Gets/sets whether render() shows caustics behind the lens instead of
+	/// the traced rays.  Every render traces caustic_rays() more, until
+	/// caustic_limit() have been traced.
+	bool show_caustics() const { return m_show_caustics; }
+	void show_caustics(bool show) { m_show_caustics = show; }
+	
+	u32 caustic_rays() const { return m_caustic_rays; }
+	void caustic_rays(u32 rays) { m_caustic_rays = rays; }
+	
+	size_t caustic_limit() const { return m_caustic_limit; }
+	void caustic_limit(size_t rays) { m_caustic_limit = rays; }
+	
+	/// Gets/sets where caustic rays start, relative to the center of the lens.
+	const light_source& caustic_source() const { return m_caustic_source; }
+	void caustic_source(const light_source& source) { m_caustic_source = source; m_caustics_stale = true; }
+	
+	/// Gets the caustics traced so far.
+	const caustic_map& caustics() const { return m_caustics; }
+	
 	/// Gets/sets the radius of the left of the lens.
 	f32 left_radius() const { return m_left_radius; }
-	void left_radius(f32 r) { m_left_radius = r; }
+	void left_radius(f32 r) { m_left_radius = r; m_system_dirty = true; }
 	
 	/// Gets/sets the radius of the right of the lens.
 	f32 right_radius() const { return m_right_radius; }
-	void right_radius(f32 r) { m_right_radius = r; }
+	void right_radius(f32 r) { m_right_radius = r; m_system_dirty = true; }
 	
 	/// Gets/sets the refractive index of the inside of the lens.
 	f32 inside_n() const { return m_inside_n; }
-	void inside_n(f32 n) { m_inside_n = n; }
+	void inside_n(f32 n) { m_inside_n = n; m_inside_material = dispersion(n); m_system_dirty = true; }
 	
 	/// Gets/sets the refractive index of the outside of the lens.
 	f32 outside_n() const { return m_outside_n; }
-	void outside_n(f32 n) { m_outside_n = n; }
+	void outside_n(f32 n) { m_outside_n = n; m_outside_material = dispersion(n); m_system_dirty = true; }
+	
+	/// Gets/sets the material inside the lens, which also sets inside_n() to
+	/// its index at the reference wavelength.
+	const dispersion& inside_material() const { return m_inside_material; }
+	void inside_material(const dispersion& material) { m_inside_material = material; m_inside_n = material.n(); m_system_dirty = true; }
+	
+	/// Gets/sets the material outside the lens, see inside_material().
+	const dispersion& outside_material() const { return m_outside_material; }
+	void outside_material(const dispersion& material) { m_outside_material = material; m_outside_n = material.n(); m_system_dirty = true; }
+	
+	/// Gets/sets how many wavelengths render() traces, or 0 to trace only
+	/// the reference wavelength.
+	u32 spectral_bands() const { return m_spectral_bands; }
+	void spectral_bands(u32 bands) { m_spectral_bands = bands; }
 	
 	/// Gets the list of presets for indices of refraction.
 	struct index {
-		index(std::string _name, f32 _n) : name(_name), n(_n) { }
+		index(std::string _name, const dispersion& _material) : name(_name), material(_material), n(_material.n()) { }
 		
 		std::string name;
-		f32 n;
+		dispersion material;
+		f32 n; /// At the reference wavelength.
 	};
 	
 	typedef std::vector<index> index_array;
@@ -148,6 +235,30 @@ private:
 	
 	f32 m_inside_n;
 	f32 m_outside_n;
+	
+	dispersion m_inside_material;
+	dispersion m_outside_material;
+	
+	u32 m_spectral_bands;
+	
+	bool m_show_caustics;
+	u32 m_caustic_rays;
+	size_t m_caustic_limit;
+	light_source m_caustic_source;
+	caustic_map m_caustics;
+	bool m_caustics_stale;
+	
+	thread_pool * m_pool;
+	
+	optical_system m_system;
+	vector2dd m_system_center;
+	bool m_system_dirty;
+	
+	void render_caustics(cairo_t * context, const vector2dd& size, const vector2dd& center);
+	
+	// Not copyable.
+	lens_backend(const lens_backend&);
+	lens_backend& operator=(const lens_backend&);
 };
 
 #endif // _LENS_BACKEND_H
@@ -0,0 +1,192 @@
+/*
+ * lens_sweep.cpp
+ * Lens Refraction
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+#include "lens_sweep.h"
+#include "lens_backend.h"
+#include "thread_pool.h"
+#include <cstring>
+#include <vector>
+
+/*****************************************************************************/
+// Grid.
+
+/**
+ * Keep a radius at least the half height of the lens, as the front end
+ * does, since a smaller circle cannot span the lens.
+**/
+static f64 clamp_radius(f64 radius) {
+	if (radius < 0.0 && radius > -k_lens_half_height) return -k_lens_half_height;
+	if (radius >= 0.0 && radius < k_lens_half_height) return k_lens_half_height;
+	return radius;
+}
+
+void sweep_grid::config(size_t i, sweep_result& out) const {
+	out.outside_n = outside_n.value(u32(i % outside_n.steps));
+	i /= outside_n.steps;
+	out.inside_n = inside_n.value(u32(i % inside_n.steps));
+	i /= inside_n.steps;
+	out.right_radius = clamp_radius(right_radius.value(u32(i % right_radius.steps)));
+	i /= right_radius.steps;
+	out.left_radius = clamp_radius(left_radius.value(u32(i)));
+}
+
+/*****************************************************************************/
+// Writers.
+
+static const u32 k_column_count = 10;
+static const char * const k_column_names[k_column_count] = {
+	"left_radius", "right_radius", "inside_n", "outside_n",
+	"focal_length", "back_focal_point", "best_focus", "spot_rms",
+	"rays", "reflections"
+};
+
+static f64 column_value(const sweep_result& result, u32 column) {
+	switch (column) {
+		case 0:		return result.left_radius;
+		case 1:		return result.right_radius;
+		case 2:		return result.inside_n;
+		case 3:		return result.outside_n;
+		case 4:		return result.focal_length;
+		case 5:		return result.back_focal_point;
+		case 6:		return result.best_focus;
+		case 7:		return result.spot_rms;
+		case 8:		return result.rays;
+		default:	return result.reflections;
+	}
+}
+
+void csv_sweep_writer::begin(size_t) {
+	for (u32 i = 0; i < k_column_count; ++i) {
+		fprintf(m_file, (i == 0) ? "%s" : ",%s", k_column_names[i]);
+	}
+	
+	fputc('\n', m_file);
+}
+
+void csv_sweep_writer::write(const sweep_result * results, size_t count) {
+	for (size_t i = 0; i < count; ++i) {
+		const sweep_result& r = results[i];
+		fprintf(m_file, "%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%u,%u\n",
+				r.left_radius, r.right_radius, r.inside_n, r.outside_n,
+				r.focal_length, r.back_focal_point, r.best_focus, r.spot_rms,
+				r.rays, r.reflections);
+	}
+}
+
+void csv_sweep_writer::end() {
+	fflush(m_file);
+}
+
+void columnar_sweep_writer::begin(size_t count) {
+	const u32 header[2] = { k_version, k_column_count };
+	const u64 rows = count;
+	fwrite("LSWP", 1, 4, m_file);
+	fwrite(header, sizeof(u32), 2, m_file);
+	fwrite(&rows, sizeof(u64), 1, m_file);
+	
+	for (u32 i = 0; i < k_column_count; ++i) {
+		fwrite(k_column_names[i], 1, strlen(k_column_names[i]) + 1, m_file);
+	}
+}
+
+void columnar_sweep_writer::write(const sweep_result * results, size_t count) {
+	const u64 rows = count;
+	fwrite(&rows, sizeof(u64), 1, m_file);
+	
+	std::vector<f64> column(count);
+	for (u32 c = 0; c < k_column_count; ++c) {
+		for (size_t i = 0; i < count; ++i) column[i] = column_value(results[i], c);
+		fwrite(&column[0], sizeof(f64), count, m_file);
+	}
+}
+
+void columnar_sweep_writer::end() {
+	fflush(m_file);
+}
+
+/*****************************************************************************/
+// Sweep.
+
+struct lens_sweep::block_task {
+	const lens_sweep * sweep;
+	sweep_result * results;
+};
+
+void lens_sweep::evaluate(lens_backend& lens, sweep_result& result) const {
+	lens.left_radius(f32(result.left_radius));
+	lens.right_radius(f32(result.right_radius));
+	lens.inside_n(f32(result.inside_n));
+	lens.outside_n(f32(result.outside_n));
+	
+	const paraxial_lens paraxial = lens.paraxial();
+	result.focal_length = paraxial.focal_length;
+	result.back_focal_point = paraxial.back_focal_point;
+	
+	const focus_result focus = lens.best_focus(m_rays, m_aperture);
+	result.best_focus = focus.position;
+	result.spot_rms = focus.rms_radius;
+	result.rays = focus.rays;
+	result.reflections = focus.reflections;
+}
+
+/**
+ * Evaluate the designs in [begin, end) of a block.  Chunks are claimed from
+ * the pool one at a time, so threads that get quick designs take more.
+**/
+void lens_sweep::evaluate_chunk(void * context, size_t begin, size_t end) {
+	const block_task& task = *static_cast<block_task *>(context);
+	
+	lens_backend lens;
+	for (size_t i = begin; i < end; ++i) {
+		task.sweep->evaluate(lens, task.results[i]);
+	}
+}
+
+void lens_sweep::run(const sweep_grid& grid, sweep_writer& writer, thread_pool * pool) const {
+	const size_t count = grid.size();
+	writer.begin(count);
+	
+	std::vector<sweep_result> results(min_(count, m_block_size));
+	
+	// Small chunks balance well, but each one builds a scratch lens.
+	const size_t grain = 16;
+	
+	for (size_t start = 0; start < count; start += m_block_size) {
+		const size_t block = min_(count - start, m_block_size);
+		for (size_t i = 0; i < block; ++i) grid.config(start + i, results[i]);
+		
+		block_task task;
+		task.sweep = this;
+		task.results = &results[0];
+		
+		if (pool) {
+			pool->parallel_for(block, grain, &lens_sweep::evaluate_chunk, &task);
+		} else {
+			evaluate_chunk(&task, 0, block);
+		}
+		
+		writer.write(&results[0], block);
+	}
+	
+	writer.end();
+}
@@ -0,0 +1,222 @@
+/*
+ * lens_sweep.h
+ * Lens Refraction
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+#ifndef _LENS_SWEEP_H
+#define _LENS_SWEEP_H
+
+#include <cstdio>
+#include "mathutil.h"
+using namespace donner;
+
+class thread_pool;
+class lens_backend;
+
+/**
+ * Evenly spaced values of one lens parameter, from first to last inclusive.
+**/
+struct sweep_range {
+	f64 first;
+	f64 last;
+	u32 steps;	/// Number of values, a single value is first.
+	
+	sweep_range() : first(0.0), last(0.0), steps(1) { }
+	sweep_range(f64 value) : first(value), last(value), steps(1) { }
+	sweep_range(f64 _first, f64 _last, u32 _steps) : first(_first), last(_last), steps(_steps) { }
+	
+	/**
+	 * Get the value at step i.
+	**/
+	f64 value(u32 i) const {
+		if (steps <= 1) return first;
+		return first + (last - first) * i / (steps - 1);
+	}
+};
+
+/**
+ * The performance of one lens design.
+**/
+struct sweep_result {
+	f64 left_radius;
+	f64 right_radius;
+	f64 inside_n;
+	f64 outside_n;
+	
+	f64 focal_length;		/// Paraxial effective focal length.
+	f64 back_focal_point;	/// Paraxial focus, from the center of the lens.
+	f64 best_focus;			/// Traced focus, from the center of the lens.
+	f64 spot_rms;			/// RMS radius of the spot at best_focus.
+	u32 rays;				/// Rays that made it through the lens.
+	u32 reflections;		/// Total internal reflections along the rays.
+};
+
+/**
+ * Every combination of the four lens parameters.  Configurations are
+ * numbered with left_radius changing slowest and outside_n fastest.
+**/
+struct sweep_grid {
+	sweep_range left_radius;
+	sweep_range right_radius;
+	sweep_range inside_n;
+	sweep_range outside_n;
+	
+	sweep_grid()
+		: left_radius(1.5),
+		  right_radius(1.5),
+		  inside_n(1.5),
+		  outside_n(1.0) {
+	}
+	
+	/**
+	 * Get the number of configurations.
+	**/
+	size_t size() const {
+		return size_t(left_radius.steps) * right_radius.steps * inside_n.steps * outside_n.steps;
+	}
+	
+	/**
+	 * Fill in the parameters of configuration i.  Radii between -1 and 1
+	 * are clamped to 1 in size, as in the front end.
+	**/
+	void config(size_t i, sweep_result& out) const;
+};
+
+/*****************************************************************************/
+
+/**
+ * Receives results from a sweep as they are evaluated.
+**/
+class sweep_writer {
+public:
+	virtual ~sweep_writer() { }
+	
+	/**
+	 * Called once before any results, with the number to expect.
+	**/
+	virtual void begin(size_t count) = 0;
+	
+	/**
+	 * Called with each block of results, in configuration order.
+	**/
+	virtual void write(const sweep_result * results, size_t count) = 0;
+	
+	/**
+	 * Called once after the last result.
+	**/
+	virtual void end() { }
+};
+
+/**
+ * Writes results as CSV with a header row.
+**/
+class csv_sweep_writer : public sweep_writer {
+public:
+	explicit csv_sweep_writer(FILE * file) : m_file(file) { }
+	
+	virtual void begin(size_t count);
+	virtual void write(const sweep_result * results, size_t count);
+	virtual void end();
+	
+private:
+	FILE * m_file;
+};
+
+/**
+ * Writes results as a binary columnar file.  Columns are written in row
+ * groups, one per block, so the file can be streamed without seeking:
+ * 
+ * header:		"LSWP", u32 version, u32 columns, u64 rows,
+ * 				then the column names, each terminated by a '\0'.
+ * row group:	u64 rows, then each column as rows f64 values.
+ * 
+ * All values are stored in the byte order of the machine writing them.
+**/
+class columnar_sweep_writer : public sweep_writer {
+public:
+	static const u32 k_version = 2; // Version 1 stored the row counts as u32.
+	
+	explicit columnar_sweep_writer(FILE * file) : m_file(file) { }
+	
+	virtual void begin(size_t count);
+	virtual void write(const sweep_result * results, size_t count);
+	virtual void end();
+	
+private:
+	FILE * m_file;
+};
+
+/*****************************************************************************/
+
+/**
+ * Evaluates every configuration in a sweep_grid, without any front end.
+ * 
+ * The grid is evaluated one block at a time, spread over a thread_pool, and
+ * each block is handed to the writer before the next starts, so memory use
+ * does not grow with the size of the grid.
+**/
+class lens_sweep {
+public:
+	static const size_t k_default_block_size = 4096;
+	
+	lens_sweep()
+		: m_rays(16),
+		  m_aperture(0.5),
+		  m_block_size(k_default_block_size) {
+	}
+	
+	/// Gets/sets the number of rays traced through each design.
+	u32 rays() const { return m_rays; }
+	void rays(u32 rays) { m_rays = rays; }
+	
+	/// Gets/sets the height of the traced beam, as a fraction of the lens.
+	f64 aperture() const { return m_aperture; }
+	void aperture(f64 aperture) { m_aperture = aperture; }
+	
+	/// Gets/sets the number of designs evaluated before each write.
+	size_t block_size() const { return m_block_size; }
+	void block_size(size_t size) { m_block_size = max_(size, size_t(1)); }
+	
+	/**
+	 * Evaluate every configuration in the grid.
+	 * 
+	 * @param	pool	Threads to evaluate on, or null to use the calling
+	 * 					thread only.
+	**/
+	void run(const sweep_grid& grid, sweep_writer& writer, thread_pool * pool = 0) const;
+	
+	/**
+	 * Evaluate one design, whose parameters are already set in result.
+	 * 
+	 * @param	lens	Scratch lens to evaluate with.
+	**/
+	void evaluate(lens_backend& lens, sweep_result& result) const;
+	
+private:
+	u32 m_rays;
+	f64 m_aperture;
+	size_t m_block_size;
+	
+	struct block_task;
+	static void evaluate_chunk(void * context, size_t begin, size_t end);
+};
+
+#endif // _LENS_SWEEP_H
@@ -0,0 +1,298 @@
+/*
+ * optical_system.cpp
+ * Lens Refraction
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+#include "optical_system.h"
+#include <algorithm>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+bool circle::ray_intersect(vector2dd start, vector2dd dir, vector2dd& intersection, vector2dd& normal, bool on_arc) const {
+	start -= center; // Change the coordinate to be in circle-space.
+	dir.normalize();
+	
+	f64 a = 1.0; // Length of dir.
+	f64 b = 2.0 * start.dot_product(dir);
+	
+	// From a point on the circle the roots are 0 and -b.
+	if (on_arc) return -b > k_min_cast * radius && ray_intersect_validate(start, dir, -b, intersection, normal);
+	
+	f64 c = start.length_sq() - radius * radius;
+	
+	if (b * b < 4.0 * a * c) return false; // sqrt is negative.
+	
+	// Apply the quadratic formula to find t.
+	f64 t_1 = (-b + sqrt(b * b - 4.0 * a * c)) / (2.0 * a);
+	f64 t_2 = (-b - sqrt(b * b - 4.0 * a * c)) / (2.0 * a);
+	
+	if (t_2 < t_1) {
+		// Swap t_1 and t_2 ...
+		f64 tmp = t_1;
+		t_1 = t_2;
+		t_2 = tmp;
+	}
+	
+	if (ray_intersect_validate(start, dir, t_1, intersection, normal)) return true;
+	if (ray_intersect_validate(start, dir, t_2, intersection, normal)) return true;
+	
+	return false;
+}
+
+void circle::ray_intersect_packet(const f64 * start_x, const f64 * start_y, const f64 * dir_x, const f64 * dir_y, size_t count,
+								  f64 * out_t, f64 * out_x, f64 * out_y, f64 * out_normal_x, f64 * out_normal_y) const {
+	/* Each lane follows ray_intersect_vector() without branches.  Both roots
+	 * are computed, masks pick the nearer one that is ahead of the ray and
+	 * on the arc, and misses get t = -1.  The arc test is oriented so that a
+	 * point on the arc is on the non-negative side of both radii.
+	**/
+	const f64 orient = (theta_end < theta_start) ? -1.0 : 1.0;
+	const vector2dd start_edge = orient * arc_start;
+	const vector2dd end_edge = orient * arc_end;
+	const f64 radius_sq = radius * radius;
+	const f64 normal_sign = convex ? 1.0 : -1.0;
+	
+	size_t i = 0;
+	
+#if defined(__AVX__)
+	const __m256d cx = _mm256_set1_pd(center.x), cy = _mm256_set1_pd(center.y);
+	const __m256d r_sq = _mm256_set1_pd(radius_sq);
+	const __m256d sex = _mm256_set1_pd(start_edge.x), sey = _mm256_set1_pd(start_edge.y);
+	const __m256d eex = _mm256_set1_pd(end_edge.x), eey = _mm256_set1_pd(end_edge.y);
+	const __m256d r = _mm256_set1_pd(radius), n_sign = _mm256_set1_pd(normal_sign);
+	const __m256d zero = _mm256_setzero_pd();
+	const __m256d miss = _mm256_set1_pd(-1.0);
+	
+	for (; i + 4 <= count; i += 4) {
+		const __m256d dx = _mm256_loadu_pd(dir_x + i);
+		const __m256d dy = _mm256_loadu_pd(dir_y + i);
+		const __m256d rx = _mm256_sub_pd(_mm256_loadu_pd(start_x + i), cx);
+		const __m256d ry = _mm256_sub_pd(_mm256_loadu_pd(start_y + i), cy);
+		
+		const __m256d half_b = _mm256_add_pd(_mm256_mul_pd(rx, dx), _mm256_mul_pd(ry, dy));
+		const __m256d c = _mm256_sub_pd(_mm256_add_pd(_mm256_mul_pd(rx, rx), _mm256_mul_pd(ry, ry)), r_sq);
+		const __m256d disc = _mm256_sub_pd(_mm256_mul_pd(half_b, half_b), c);
+		const __m256d valid = _mm256_cmp_pd(disc, zero, _CMP_GE_OQ);
+		const __m256d root = _mm256_sqrt_pd(_mm256_max_pd(disc, zero));
+		
+		const __m256d t_1 = _mm256_sub_pd(_mm256_sub_pd(zero, half_b), root);
+		const __m256d t_2 = _mm256_add_pd(_mm256_sub_pd(zero, half_b), root);
+		
+		const __m256d p1x = _mm256_add_pd(rx, _mm256_mul_pd(t_1, dx));
+		const __m256d p1y = _mm256_add_pd(ry, _mm256_mul_pd(t_1, dy));
+		const __m256d p2x = _mm256_add_pd(rx, _mm256_mul_pd(t_2, dx));
+		const __m256d p2y = _mm256_add_pd(ry, _mm256_mul_pd(t_2, dy));
+		
+		__m256d ok_1 = _mm256_and_pd(valid, _mm256_cmp_pd(t_1, zero, _CMP_GE_OQ));
+		ok_1 = _mm256_and_pd(ok_1, _mm256_cmp_pd(_mm256_sub_pd(_mm256_mul_pd(sex, p1y), _mm256_mul_pd(sey, p1x)), zero, _CMP_GE_OQ));
+		ok_1 = _mm256_and_pd(ok_1, _mm256_cmp_pd(_mm256_sub_pd(_mm256_mul_pd(p1x, eey), _mm256_mul_pd(p1y, eex)), zero, _CMP_GE_OQ));
+		
+		__m256d ok_2 = _mm256_and_pd(valid, _mm256_cmp_pd(t_2, zero, _CMP_GE_OQ));
+		ok_2 = _mm256_and_pd(ok_2, _mm256_cmp_pd(_mm256_sub_pd(_mm256_mul_pd(sex, p2y), _mm256_mul_pd(sey, p2x)), zero, _CMP_GE_OQ));
+		ok_2 = _mm256_and_pd(ok_2, _mm256_cmp_pd(_mm256_sub_pd(_mm256_mul_pd(p2x, eey), _mm256_mul_pd(p2y, eex)), zero, _CMP_GE_OQ));
+		
+		// Prefer the nearer root, mark lanes with neither as missed.
+		const __m256d t = _mm256_blendv_pd(_mm256_blendv_pd(miss, t_2, ok_2), t_1, ok_1);
+		const __m256d px = _mm256_blendv_pd(p2x, p1x, ok_1);
+		const __m256d py = _mm256_blendv_pd(p2y, p1y, ok_1);
+		
+		_mm256_storeu_pd(out_t + i, t);
+		_mm256_storeu_pd(out_x + i, _mm256_add_pd(px, cx));
+		_mm256_storeu_pd(out_y + i, _mm256_add_pd(py, cy));
+		_mm256_storeu_pd(out_normal_x + i, _mm256_mul_pd(_mm256_div_pd(px, r), n_sign));
+		_mm256_storeu_pd(out_normal_y + i, _mm256_mul_pd(_mm256_div_pd(py, r), n_sign));
+	}
+#elif defined(__SSE2__)
+	const __m128d cx = _mm_set1_pd(center.x), cy = _mm_set1_pd(center.y);
+	const __m128d r_sq = _mm_set1_pd(radius_sq);
+	const __m128d sex = _mm_set1_pd(start_edge.x), sey = _mm_set1_pd(start_edge.y);
+	const __m128d eex = _mm_set1_pd(end_edge.x), eey = _mm_set1_pd(end_edge.y);
+	const __m128d r = _mm_set1_pd(radius), n_sign = _mm_set1_pd(normal_sign);
+	const __m128d zero = _mm_setzero_pd();
+	const __m128d miss = _mm_set1_pd(-1.0);
+	
+	for (; i + 2 <= count; i += 2) {
+		const __m128d dx = _mm_loadu_pd(dir_x + i);
+		const __m128d dy = _mm_loadu_pd(dir_y + i);
+		const __m128d rx = _mm_sub_pd(_mm_loadu_pd(start_x + i), cx);
+		const __m128d ry = _mm_sub_pd(_mm_loadu_pd(start_y + i), cy);
+		
+		const __m128d half_b = _mm_add_pd(_mm_mul_pd(rx, dx), _mm_mul_pd(ry, dy));
+		const __m128d c = _mm_sub_pd(_mm_add_pd(_mm_mul_pd(rx, rx), _mm_mul_pd(ry, ry)), r_sq);
+		const __m128d disc = _mm_sub_pd(_mm_mul_pd(half_b, half_b), c);
+		const __m128d valid = _mm_cmpge_pd(disc, zero);
+		const __m128d root = _mm_sqrt_pd(_mm_max_pd(disc, zero));
+		
+		const __m128d t_1 = _mm_sub_pd(_mm_sub_pd(zero, half_b), root);
+		const __m128d t_2 = _mm_add_pd(_mm_sub_pd(zero, half_b), root);
+		
+		const __m128d p1x = _mm_add_pd(rx, _mm_mul_pd(t_1, dx));
+		const __m128d p1y = _mm_add_pd(ry, _mm_mul_pd(t_1, dy));
+		const __m128d p2x = _mm_add_pd(rx, _mm_mul_pd(t_2, dx));
+		const __m128d p2y = _mm_add_pd(ry, _mm_mul_pd(t_2, dy));
+		
+		__m128d ok_1 = _mm_and_pd(valid, _mm_cmpge_pd(t_1, zero));
+		ok_1 = _mm_and_pd(ok_1, _mm_cmpge_pd(_mm_sub_pd(_mm_mul_pd(sex, p1y), _mm_mul_pd(sey, p1x)), zero));
+		ok_1 = _mm_and_pd(ok_1, _mm_cmpge_pd(_mm_sub_pd(_mm_mul_pd(p1x, eey), _mm_mul_pd(p1y, eex)), zero));
+		
+		__m128d ok_2 = _mm_and_pd(valid, _mm_cmpge_pd(t_2, zero));
+		ok_2 = _mm_and_pd(ok_2, _mm_cmpge_pd(_mm_sub_pd(_mm_mul_pd(sex, p2y), _mm_mul_pd(sey, p2x)), zero));
+		ok_2 = _mm_and_pd(ok_2, _mm_cmpge_pd(_mm_sub_pd(_mm_mul_pd(p2x, eey), _mm_mul_pd(p2y, eex)), zero));
+		
+		// Prefer the nearer root, mark lanes with neither as missed.  SSE2 has
+		// no blend, so select with and/andnot/or.
+		__m128d t = _mm_or_pd(_mm_and_pd(ok_2, t_2), _mm_andnot_pd(ok_2, miss));
+		t = _mm_or_pd(_mm_and_pd(ok_1, t_1), _mm_andnot_pd(ok_1, t));
+		const __m128d px = _mm_or_pd(_mm_and_pd(ok_1, p1x), _mm_andnot_pd(ok_1, p2x));
+		const __m128d py = _mm_or_pd(_mm_and_pd(ok_1, p1y), _mm_andnot_pd(ok_1, p2y));
+		
+		_mm_storeu_pd(out_t + i, t);
+		_mm_storeu_pd(out_x + i, _mm_add_pd(px, cx));
+		_mm_storeu_pd(out_y + i, _mm_add_pd(py, cy));
+		_mm_storeu_pd(out_normal_x + i, _mm_mul_pd(_mm_div_pd(px, r), n_sign));
+		_mm_storeu_pd(out_normal_y + i, _mm_mul_pd(_mm_div_pd(py, r), n_sign));
+	}
+#endif
+	
+	// Scalar path, also handles the leftover rays.
+	for (; i < count; ++i) {
+		const f64 rx = start_x[i] - center.x;
+		const f64 ry = start_y[i] - center.y;
+		
+		const f64 half_b = rx * dir_x[i] + ry * dir_y[i];
+		const f64 disc = half_b * half_b - (rx * rx + ry * ry - radius_sq);
+		
+		f64 t = -1.0;
+		f64 px = 0.0, py = 0.0;
+		
+		if (disc >= 0.0) {
+			const f64 root = sqrt(disc);
+			const f64 roots[2] = { -half_b - root, -half_b + root };
+			
+			for (u32 k = 0; k < 2; ++k) {
+				const f64 qx = rx + roots[k] * dir_x[i];
+				const f64 qy = ry + roots[k] * dir_y[i];
+				
+				if (roots[k] >= 0.0
+						&& start_edge.x * qy - start_edge.y * qx >= 0.0
+						&& qx * end_edge.y - qy * end_edge.x >= 0.0) {
+					t = roots[k];
+					px = qx;
+					py = qy;
+					break;
+				}
+			}
+		}
+		
+		out_t[i] = t;
+		out_x[i] = px + center.x;
+		out_y[i] = py + center.y;
+		out_normal_x[i] = px / radius * normal_sign;
+		out_normal_y[i] = py / radius * normal_sign;
+	}
+}
+
+bool optical_surface::ray_intersect(const vector2dd& start, const vector2dd& dir, vector2dd& intersection, vector2dd& out_normal, bool on_surface) const {
+	if (kind == k_spherical) return arc.ray_intersect_vector(start, dir, intersection, out_normal, on_surface);
+	if (on_surface) return false;
+	
+	// Planes and apertures: (start + t dir - origin) . normal = 0.
+	const f64 denom = dir.dot_product(normal);
+	if (iszero(denom)) return false;
+	
+	const f64 t = (origin - start).dot_product(normal) / denom;
+	if (t < 0.0) return false;
+	
+	intersection = start + t * dir;
+	
+	if (kind == k_plane) {
+		const vector2dd rel = intersection - origin;
+		if (abs_(rel.x * normal.y - rel.y * normal.x) > half_height) return false;
+	}
+	
+	out_normal = normal;
+	return true;
+}
+
+void optical_system::push(const optical_surface& surface, const dispersion& after) {
+	m_surfaces.push_back(surface);
+	m_media.push_back(after);
+	m_indices.push_back(after.n());
+}
+
+void optical_system::add_spherical(const circle& arc, const dispersion& after) {
+	optical_surface surface = optical_surface();
+	surface.kind = optical_surface::k_spherical;
+	surface.arc = arc;
+	surface.origin = arc.center;
+	surface.normal.set(-1.0, 0.0);
+	surface.half_height = 0.0;
+	
+	// The vertex is the middle of the arc.
+	const f64 mid = 0.5 * (arc.theta_start + arc.theta_end);
+	surface.vertex_x = arc.center.x + arc.radius * cos(mid);
+	
+	push(surface, after);
+}
+
+void optical_system::add_plane(const vector2dd& origin, const vector2dd& normal, f64 half_height, const dispersion& after) {
+	optical_surface surface = optical_surface();
+	surface.kind = optical_surface::k_plane;
+	surface.origin = origin;
+	surface.normal = normal;
+	surface.normal.normalize();
+	if (surface.normal.x > 0.0) surface.normal = -surface.normal;
+	surface.half_height = half_height;
+	surface.vertex_x = origin.x;
+	
+	push(surface, after);
+}
+
+void optical_system::add_aperture(const vector2dd& origin, f64 opening) {
+	optical_surface surface = optical_surface();
+	surface.kind = optical_surface::k_aperture;
+	surface.origin = origin;
+	surface.normal.set(-1.0, 0.0);
+	surface.half_height = opening;
+	surface.vertex_x = origin.x;
+	
+	const dispersion medium = m_media.back(); // Copied, push() may reallocate.
+	push(surface, medium);
+}
+
+/// Orders surfaces by where they cross the axis.
+static bool vertex_less(f64 x, const optical_surface& surface) {
+	return x < surface.vertex_x;
+}
+
+void optical_system::indices(f64 wavelength, f64 * out) const {
+	for (size_t i = 0; i < m_media.size(); ++i) {
+		out[i] = m_media[i].n(wavelength);
+	}
+}
+
+u32 optical_system::gap_at(const vector2dd& point) const {
+	return (u32) (std::upper_bound(m_surfaces.begin(), m_surfaces.end(), point.x, &vertex_less) - m_surfaces.begin());
+}
@@ -0,0 +1,312 @@
+/*
+ * optical_system.h
+ * Lens Refraction
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+#ifndef _OPTICAL_SYSTEM_H
+#define _OPTICAL_SYSTEM_H
+
+#include "vector2d.h"
+#include "dispersion.h"
+#include <vector>
+using namespace donner;
+
+/// Shortest cast, relative to the radius of a surface, that leaves the point
+/// a ray starts from.  A shorter root is rounding error at the start point.
+static const f64 k_min_cast = 1.0e-9;
+
+struct circle {
+	vector2dd center;
+	f64 radius;
+	
+	f64 theta_start;
+	f64 theta_end;
+	
+	// Unit vectors from the center towards theta_start and theta_end.
+	vector2dd arc_start;
+	vector2dd arc_end;
+	
+	bool convex; // Is this a convex or concave segment?
+	
+	/**
+	 * Set the angles the arc spans, which may run in either direction but
+	 * must span no more than pi.
+	**/
+	void set_arc(f64 start, f64 end) {
+		theta_start = start;
+		theta_end = end;
+		arc_start.set(cos(start), sin(start));
+		arc_end.set(cos(end), sin(end));
+	}
+	
+	/**
+	 * Find where a ray first meets the arc, using angles for the range test
+	 * and normal.
+	 * 
+	 * @param	on_arc	The ray starts on this arc, as after a reflection or
+	 * 					refraction here, so only the far root can be a hit.
+	**/
+	bool ray_intersect(vector2dd start, vector2dd dir, vector2dd& intersection, vector2dd& normal, bool on_arc = false) const;
+	
+	/**
+	 * Find where a ray first meets the arc, without trigonometry.  dir must
+	 * be normalized.
+	 * 
+	 * The point is on the arc if it is on the inner side of the radii through
+	 * both ends, found with cross products against arc_start and arc_end.
+	 * The normal is the point relative to the center divided by the radius.
+	 * 
+	 * @param	on_arc	See ray_intersect().
+	**/
+	bool ray_intersect_vector(const vector2dd& start, const vector2dd& dir, vector2dd& intersection, vector2dd& normal, bool on_arc = false) const {
+		const vector2dd rel = start - center; // Change the coordinate to be in circle-space.
+		
+		// |rel + t dir|^2 = r^2 with |dir| = 1.
+		const f64 half_b = rel.dot_product(dir);
+		
+		// From a point on the circle the roots are 0 and -2 half_b.
+		if (on_arc) {
+			const f64 t = -2.0 * half_b;
+			return t > k_min_cast * radius && ray_intersect_validate_vector(rel, dir, t, intersection, normal);
+		}
+		
+		const f64 c = rel.length_sq() - radius * radius;
+		const f64 disc = half_b * half_b - c;
+		if (disc < 0.0) return false;
+		
+		const f64 root = sqrt(disc);
+		if (ray_intersect_validate_vector(rel, dir, -half_b - root, intersection, normal)) return true;
+		if (ray_intersect_validate_vector(rel, dir, -half_b + root, intersection, normal)) return true;
+		
+		return false;
+	}
+	
+	/**
+	 * Find where each of a packet of rays first meets the arc, the same as
+	 * ray_intersect_vector() but for several rays at once with SSE2 or AVX.
+	 * Rays are given and returned as separate arrays of components, and the
+	 * directions must be normalized.
+	 * 
+	 * @param	count			Number of rays.
+	 * @param	out_t			Receives the distance along each ray to the hit,
+	 * 							or -1 if the ray misses.
+	 * @param	out_x, out_y	Receive the hit points.
+	 * @param	out_normal_x, out_normal_y
+	 * 							Receive the normals at the hit points.
+	 * 
+	 * The points and normals are only meaningful where out_t is not negative.
+	 * Rays must not start on the arc: the root at the start is not excluded
+	 * as it is with on_arc, so cast those with ray_intersect_vector().
+	**/
+	void ray_intersect_packet(const f64 * start_x, const f64 * start_y, const f64 * dir_x, const f64 * dir_y, size_t count,
+							  f64 * out_t, f64 * out_x, f64 * out_y, f64 * out_normal_x, f64 * out_normal_y) const;
+	
+private:
+	bool point_in_arc(const vector2dd& pt) const {
+		const f64 after_start = arc_start.x * pt.y - arc_start.y * pt.x;
+		const f64 before_end = pt.x * arc_end.y - pt.y * arc_end.x;
+		
+		if (theta_end < theta_start) return (after_start <= 0.0 && before_end <= 0.0);
+		else return (after_start >= 0.0 && before_end >= 0.0);
+	}
+	
+	bool ray_intersect_validate_vector(const vector2dd& start, const vector2dd& dir, f64 t, vector2dd& intersection, vector2dd& normal) const {
+		if (t < 0.0) return false;
+		
+		intersection = start + t * dir;
+		if (!point_in_arc(intersection)) return false;
+		
+		normal = intersection / radius;
+		if (!convex) normal = -normal;
+		
+		intersection += center;
+		return true;
+	}
+	
+	bool angle_in_range(f64 angle) const {
+		angle -= theta_start;
+		f64 end = theta_end - theta_start;
+		if (angle < -PI64) angle += 2.0 * PI64;
+		
+		if (end < 0.0) return (angle >= end && angle <= 0.0);
+		else return (angle >= 0.0 && angle <= end);
+	}
+	
+	bool ray_intersect_validate(vector2dd start, vector2dd dir, f64 t, vector2dd& intersection, vector2dd& normal) const {
+		if (t < 0.0) return false;
+		
+		intersection = start + t * dir;
+		
+		f64 angle = atan2(intersection.y, intersection.x);
+		if (!angle_in_range(angle)) return false;
+		
+		normal.set(cos(angle), sin(angle));
+		if (!convex) normal = -normal;
+		
+		intersection += center;
+		return true;
+	}
+};
+
+/**
+ * One surface of an optical_system.  Surfaces lie across the optical axis,
+ * which runs in +x, and light crosses them from one medium to the next.
+**/
+struct optical_surface {
+	enum surface_kind {
+		k_spherical = 0,	/// Refracting arc, see circle.
+		k_plane = 1,		/// Flat refracting segment.
+		k_aperture = 2		/// Opaque stop with an opening, light passes unchanged.
+	};
+	
+	surface_kind kind;
+	
+	circle arc;				/// Arc of a spherical surface.
+	
+	vector2dd origin;		/// Center of a plane or aperture.
+	vector2dd normal;		/// Unit normal of a plane or aperture, facing -x.
+	f64 half_height;		/// Half the length of a plane, or the radius of an aperture opening.
+	
+	f64 vertex_x;			/// Where the surface crosses the axis, used to order surfaces.
+	
+	/**
+	 * Find where a ray meets the surface.  dir must be normalized.
+	 * 
+	 * An aperture is hit anywhere on its line, see blocks().
+	 * 
+	 * @param	on_surface	The ray starts on this surface, so the root at its
+	 * 						start is not a hit.  A flat surface cannot be hit
+	 * 						again.
+	**/
+	bool ray_intersect(const vector2dd& start, const vector2dd& dir, vector2dd& intersection, vector2dd& normal, bool on_surface = false) const;
+	
+	/**
+	 * Does an aperture stop a ray that meets it at a point?
+	**/
+	bool blocks(const vector2dd& point) const {
+		if (kind != k_aperture) return false;
+		
+		const vector2dd rel = point - origin;
+		return abs_(rel.x * normal.y - rel.y * normal.x) > half_height;
+	}
+};
+
+/**
+ * An ordered list of surfaces with a medium between each pair, for
+ * sequential tracing.  Each medium has a dispersion, and its index at the
+ * reference wavelength is kept for tracing a single wavelength.
+ * 
+ * Surfaces are stored in order along the axis.  Gap i is the medium in
+ * front of surface i, so gap 0 is left of every surface and gap size() is
+ * right of them all.  A ray in gap i heading in +x can only meet surface i
+ * next, and heading in -x only surface i - 1.
+ * 
+ * Each surface is set up when it is added, so a system is built once when
+ * its parameters change and can then be traced any number of times.
+**/
+class optical_system {
+public:
+	/**
+	 * @param	medium	Medium left of the first surface.
+	**/
+	explicit optical_system(const dispersion& medium = dispersion(1.0)) {
+		clear(medium);
+	}
+	
+	/**
+	 * Remove every surface.
+	 * 
+	 * @param	medium	Medium left of the first surface.
+	**/
+	void clear(const dispersion& medium) {
+		m_surfaces.clear();
+		m_media.clear();
+		m_indices.clear();
+		
+		m_media.push_back(medium);
+		m_indices.push_back(medium.n());
+	}
+	
+	/* Surfaces must be added from left to right, by where they cross the
+	 * axis.  Each takes the medium to its right.
+	**/
+	
+	/**
+	 * Add a spherical surface.  The arc must be set with circle::set_arc().
+	**/
+	void add_spherical(const circle& arc, const dispersion& after);
+	
+	/**
+	 * Add a flat surface.
+	 * 
+	 * @param	origin		Center of the surface.
+	 * @param	normal		Normal of the surface, need not be normalized.
+	 * @param	half_height	Half the length of the surface.
+	**/
+	void add_plane(const vector2dd& origin, const vector2dd& normal, f64 half_height, const dispersion& after);
+	
+	/**
+	 * Add an aperture stop across the axis.  The medium does not change.
+	 * 
+	 * @param	origin		Center of the opening.
+	 * @param	opening		Radius of the opening.
+	**/
+	void add_aperture(const vector2dd& origin, f64 opening);
+	
+	size_t size() const { return m_surfaces.size(); }
+	bool empty() const { return m_surfaces.empty(); }
+	
+	const optical_surface& surface(size_t idx) const { return m_surfaces[idx]; }
+	
+	/**
+	 * Get the medium in a gap.
+	**/
+	const dispersion& medium(size_t gap) const { return m_media[gap]; }
+	
+	/**
+	 * Get the refractive index of each gap at the reference wavelength,
+	 * size() + 1 of them.
+	**/
+	const f64 * indices() const { return &m_indices[0]; }
+	
+	/**
+	 * Get the refractive index of each gap at a wavelength.
+	 * 
+	 * @param	wavelength	Wavelength, in nanometers.
+	 * @param	out			Receives size() + 1 indices.
+	**/
+	void indices(f64 wavelength, f64 * out) const;
+	
+	/**
+	 * Find the gap a point is in, by comparing it to where each surface
+	 * crosses the axis.
+	**/
+	u32 gap_at(const vector2dd& point) const;
+	
+private:
+	std::vector<optical_surface> m_surfaces;
+	std::vector<dispersion> m_media; // size() + 1 of them.
+	std::vector<f64> m_indices;
+	
+	void push(const optical_surface& surface, const dispersion& after);
+};
+
+#endif // _OPTICAL_SYSTEM_H
@@ -0,0 +1,169 @@
+/*
+ * paraxial.cpp
+ * Lens Refraction
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+#include "paraxial.h"
+#include "optical_system.h"
+#include "ray_tracer.h"
+#include <limits>
+
+paraxial_lens paraxial_lens::from_matrix(const ray_transfer& matrix, f64 front_vertex, f64 back_vertex, f64 n_front, f64 n_back) {
+	paraxial_lens lens;
+	lens.matrix = matrix;
+	lens.power = -matrix.c;
+	lens.front_vertex = front_vertex;
+	lens.back_vertex = back_vertex;
+	
+	if (iszero(lens.power, 1e-12)) {
+		const f64 inf = std::numeric_limits<f64>::infinity();
+		
+		lens.focal_length = inf;
+		lens.front_focal_distance = lens.back_focal_distance = inf;
+		lens.front_focal_point = lens.back_focal_point = inf;
+		lens.front_principal_plane = lens.back_principal_plane = inf;
+		return lens;
+	}
+	
+	/* A ray entering parallel to the axis at height y leaves with
+	 * n u' = c y from height a y, so it crosses the axis n_back a / P past
+	 * the last vertex.  Running the matrix backwards gives the front focal
+	 * point the same way, using d.  The principal planes are a focal
+	 * length, n / P, from the focal points.
+	**/
+	lens.focal_length = 1.0 / lens.power;
+	
+	lens.back_focal_distance = n_back * matrix.a / lens.power;
+	lens.front_focal_distance = n_front * matrix.d / lens.power;
+	
+	lens.back_focal_point = back_vertex + lens.back_focal_distance;
+	lens.front_focal_point = front_vertex - lens.front_focal_distance;
+	
+	lens.back_principal_plane = lens.back_focal_point - n_back / lens.power;
+	lens.front_principal_plane = lens.front_focal_point + n_front / lens.power;
+	
+	return lens;
+}
+
+paraxial_lens paraxial_single(f64 curvature_1, f64 curvature_2, f64 front_vertex, f64 back_vertex, f64 inside_n, f64 outside_n) {
+	const ray_transfer matrix = ray_transfer::refraction(curvature_2, inside_n, outside_n)
+		* ray_transfer::translation(back_vertex - front_vertex, inside_n)
+		* ray_transfer::refraction(curvature_1, outside_n, inside_n);
+	
+	return paraxial_lens::from_matrix(matrix, front_vertex, back_vertex, outside_n, outside_n);
+}
+
+paraxial_lens paraxial_system(const optical_system& system) {
+	const f64 * indices = system.indices();
+	ray_transfer matrix;
+	
+	if (system.empty()) return paraxial_lens::from_matrix(matrix, 0.0, 0.0, indices[0], indices[0]);
+	
+	for (size_t i = 0; i < system.size(); ++i) {
+		const optical_surface& surface = system.surface(i);
+		
+		if (i > 0) {
+			matrix = ray_transfer::translation(surface.vertex_x - system.surface(i - 1).vertex_x, indices[i]) * matrix;
+		}
+		
+		if (surface.kind == optical_surface::k_spherical) {
+			const f64 curvature = 1.0 / (surface.arc.center.x - surface.vertex_x);
+			matrix = ray_transfer::refraction(curvature, indices[i], indices[i + 1]) * matrix;
+		} else if (surface.kind == optical_surface::k_plane) {
+			matrix = ray_transfer::refraction(0.0, indices[i], indices[i + 1]) * matrix;
+		}
+	}
+	
+	return paraxial_lens::from_matrix(matrix, system.surface(0).vertex_x, system.surface(system.size() - 1).vertex_x,
+									  indices[0], indices[system.size()]);
+}
+
+focus_result find_best_focus(const ray_tracer& tracer, f64 start_x, f64 axis_y, f64 half_aperture, u32 rays) {
+	ray_bundle beam;
+	beam.reserve(rays);
+	
+	for (u32 i = 0; i < rays; ++i) {
+		const f64 y = axis_y + ((i + 0.5) / rays * 2.0 - 1.0) * half_aperture;
+		beam.add(vector2dd(start_x, y), vector2dd(1.0, 0.0));
+	}
+	
+	trace_result paths;
+	tracer.trace(beam, paths);
+	
+	// Write each ray leaving to the right as y = u + x s, relative to the axis.
+	f64 sum_u = 0.0, sum_s = 0.0;
+	f64 sum_uu = 0.0, sum_us = 0.0, sum_ss = 0.0;
+	u32 count = 0;
+	u32 reflections = 0;
+	
+	for (u32 i = 0; i < rays; ++i) {
+		const ray_hit * hits = paths.hits(i);
+		for (u32 j = 0; j < paths.hit_count(i); ++j) {
+			if (hits[j].reflected) ++reflections;
+		}
+		
+		if (!paths.escaped(i)) continue;
+		
+		const vector2dd& start = paths.exit_start(i);
+		const vector2dd& dir = paths.exit_dir(i);
+		if (dir.x <= 0.0) continue;
+		
+		const f64 s = dir.y / dir.x;
+		const f64 u = (start.y - axis_y) - start.x * s;
+		
+		sum_u += u;
+		sum_s += s;
+		sum_uu += u * u;
+		sum_us += u * s;
+		sum_ss += s * s;
+		++count;
+	}
+	
+	focus_result result;
+	result.rays = count;
+	result.reflections = reflections;
+	
+	if (count == 0) {
+		result.position = std::numeric_limits<f64>::quiet_NaN();
+		result.rms_radius = std::numeric_limits<f64>::quiet_NaN();
+		return result;
+	}
+	
+	/* The variance of y at x is var(u) + 2 x cov(u, s) + x^2 var(s), which is
+	 * smallest at x = -cov(u, s) / var(s).
+	**/
+	const f64 mean_u = sum_u / count;
+	const f64 mean_s = sum_s / count;
+	const f64 var_u = max_(sum_uu / count - mean_u * mean_u, 0.0);
+	const f64 var_s = max_(sum_ss / count - mean_s * mean_s, 0.0);
+	const f64 cov = sum_us / count - mean_u * mean_s;
+	
+	if (iszero(var_s, 1e-18)) {
+		// The rays leave parallel, so there is no focus.
+		result.position = std::numeric_limits<f64>::infinity();
+		result.rms_radius = sqrt(var_u);
+		return result;
+	}
+	
+	result.position = -cov / var_s;
+	result.rms_radius = sqrt(max_(var_u - cov * cov / var_s, 0.0));
+	return result;
+}
@@ -0,0 +1,152 @@
+/*
+ * paraxial.h
+ * Lens Refraction
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+#ifndef _PARAXIAL_H
+#define _PARAXIAL_H
+
+#include "vector2d.h"
+using namespace donner;
+
+class optical_system;
+class ray_tracer;
+
+/**
+ * A ray transfer (ABCD) matrix, acting on a ray's height y and reduced
+ * angle n u, where u is its slope and n the index it travels in:
+ * 
+ * [   y' ]   [a b] [  y  ]
+ * [n' u' ] = [c d] [ n u ]
+ * 
+ * The determinant is always 1.
+**/
+struct ray_transfer {
+	f64 a, b, c, d;
+	
+	ray_transfer() : a(1.0), b(0.0), c(0.0), d(1.0) { }
+	ray_transfer(f64 _a, f64 _b, f64 _c, f64 _d) : a(_a), b(_b), c(_c), d(_d) { }
+	
+	/**
+	 * Refraction at a spherical surface.
+	 * 
+	 * @param	curvature	1 / R, positive when the center of curvature is to
+	 * 						the right of the vertex.  0 for a plane.
+	 * @param	n_1, n_2	Index before and after the surface.
+	**/
+	static ray_transfer refraction(f64 curvature, f64 n_1, f64 n_2) {
+		return ray_transfer(1.0, 0.0, -(n_2 - n_1) * curvature, 1.0);
+	}
+	
+	/**
+	 * Travel a distance through a medium.
+	**/
+	static ray_transfer translation(f64 distance, f64 n) {
+		return ray_transfer(1.0, distance / n, 0.0, 1.0);
+	}
+	
+	/**
+	 * Apply rhs first, then this.
+	**/
+	ray_transfer operator*(const ray_transfer& rhs) const {
+		return ray_transfer(a * rhs.a + b * rhs.c, a * rhs.b + b * rhs.d,
+							c * rhs.a + d * rhs.c, c * rhs.b + d * rhs.d);
+	}
+};
+
+/**
+ * First-order properties of a lens, from its matrix between the first and
+ * last vertices.  Positions are x-coordinates in meters along the axis, in
+ * the same frame as the lens.
+ * 
+ * For a lens with no power the focal lengths are infinite and the focal
+ * points and principal planes are meaningless.
+**/
+struct paraxial_lens {
+	ray_transfer matrix;	/// From the first vertex to the last.
+	
+	f64 power;				/// In diopters, -c.
+	f64 focal_length;		/// Effective focal length, 1 / power.
+	
+	f64 front_vertex;		/// Where the first surface crosses the axis.
+	f64 back_vertex;		/// Where the last surface crosses the axis.
+	
+	f64 front_focal_distance;	/// From the front focal point to the first vertex.
+	f64 back_focal_distance;	/// From the last vertex to the back focal point.
+	
+	f64 front_focal_point;
+	f64 back_focal_point;
+	
+	f64 front_principal_plane;
+	f64 back_principal_plane;
+	
+	/**
+	 * Find the cardinal points from a lens matrix.
+	 * 
+	 * @param	n_front, n_back		Index in front of and behind the lens.
+	**/
+	static paraxial_lens from_matrix(const ray_transfer& matrix, f64 front_vertex, f64 back_vertex, f64 n_front, f64 n_back);
+};
+
+/**
+ * Find the paraxial properties of a single lens in O(1).
+ * 
+ * @param	curvature_1, curvature_2	Curvatures of the two surfaces, see
+ * 										ray_transfer::refraction().
+ * @param	front_vertex, back_vertex	Where the surfaces cross the axis.
+ * @param	inside_n, outside_n			Indices of the lens and around it.
+**/
+paraxial_lens paraxial_single(f64 curvature_1, f64 curvature_2, f64 front_vertex, f64 back_vertex, f64 inside_n, f64 outside_n);
+
+/**
+ * Find the paraxial properties of an optical system, at the reference
+ * wavelength.  Spherical surfaces are taken to be centered on the axis and
+ * planes to be perpendicular to it, apertures are ignored.
+**/
+paraxial_lens paraxial_system(const optical_system& system);
+
+/**
+ * Best focus found by tracing, see find_best_focus().
+**/
+struct focus_result {
+	f64 position;		/// Where along the axis the spot is smallest.
+	f64 rms_radius;		/// RMS distance of the rays from their centroid there.
+	u32 rays;			/// Number of rays that made it through.
+	u32 reflections;	/// Total internal reflections along all of the rays.
+};
+
+/**
+ * Find where a beam parallel to the axis comes to its tightest focus, by
+ * tracing a small batch of rays exactly.
+ * 
+ * Past the last surface each ray is a line y = u + x s, so the spread of
+ * the rays at x is quadratic in x and its minimum has a closed form.  The
+ * result includes spherical aberration, which the paraxial focus does not.
+ * 
+ * @param	tracer			System to trace through.
+ * @param	start_x			Where the beam starts, in front of the system.
+ * @param	axis_y			Height of the axis.
+ * @param	half_aperture	Half the height of the beam.
+ * @param	rays			Number of rays in the beam, spread evenly.
+**/
+focus_result find_best_focus(const ray_tracer& tracer, f64 start_x, f64 axis_y, f64 half_aperture, u32 rays);
+
+#endif // _PARAXIAL_H
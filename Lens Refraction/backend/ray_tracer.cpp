@@ -0,0 +1,377 @@
+/*
+ * ray_tracer.cpp
+ * Lens Refraction
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+
+#include "ray_tracer.h"
+#include "thread_pool.h"
+#include <algorithm>
+
+/// Rays per chunk when tracing on a thread pool.
+static const size_t k_trace_grain = 1024;
+
+/**
+ * Arguments for tracing a bundle on a thread pool, into either out or
+ * spectral.
+**/
+struct trace_task {
+	const ray_tracer * tracer;
+	const ray_bundle * rays;
+	trace_result * out;
+	spectral_result * spectral;
+};
+
+static void trace_chunk(void * context, size_t begin, size_t end) {
+	const trace_task& task = *static_cast<const trace_task *>(context);
+	
+	if (task.spectral) task.tracer->trace_range(*task.rays, begin, end, *task.spectral);
+	else task.tracer->trace_range(*task.rays, begin, end, *task.out);
+}
+
+void ray_tracer::trace(const ray_bundle& rays, trace_result& out, thread_pool * pool) const {
+	out.resize(rays.size(), m_cast_limit);
+	
+	if (!pool) {
+		trace_range(rays, 0, rays.size(), out);
+		return;
+	}
+	
+	trace_task task;
+	task.tracer = this;
+	task.rays = &rays;
+	task.out = &out;
+	task.spectral = 0;
+	
+	pool->parallel_for(rays.size(), k_trace_grain, &trace_chunk, &task);
+}
+
+void ray_tracer::trace(const ray_bundle& rays, const f64 * wavelengths, size_t count, spectral_result& out, thread_pool * pool) const {
+	const size_t gaps = m_system->size() + 1;
+	
+	out.m_wavelengths.assign(wavelengths, wavelengths + count);
+	out.m_indices.resize(count * gaps);
+	out.m_bands.resize(count);
+	
+	for (size_t i = 0; i < count; ++i) {
+		m_system->indices(wavelengths[i], &out.m_indices[i * gaps]);
+		out.m_bands[i].resize(rays.size(), m_cast_limit);
+	}
+	
+	if (!pool) {
+		trace_range(rays, 0, rays.size(), out);
+		return;
+	}
+	
+	trace_task task;
+	task.tracer = this;
+	task.rays = &rays;
+	task.out = 0;
+	task.spectral = &out;
+	
+	pool->parallel_for(rays.size(), k_trace_grain, &trace_chunk, &task);
+}
+
+/**
+ * Refract or reflect a ray through angles.
+ * 
+ * @param	dir			Direction of the ray, replaced by the new direction.
+ * @param	normal		Surface normal, flipped to face back along the ray.
+ * @param	eta			Ratio of refractive indices, n_1 / n_2.
+ * @return	true if refracted, false if totally internally reflected.
+**/
+static bool refract_angles(vector2dd& dir, vector2dd& normal, f64 eta) {
+	// Calculate the angle from the normal.
+	f64 theta = atan2(-dir.y, -dir.x) - atan2(normal.y, normal.x);
+	if (theta > PI64) theta -= 2.0 * PI64; // Normalize the angle so that it is between (-pi, pi].
+	if (theta <= -PI64) theta += 2.0 * PI64;
+	
+	// Flip the normal if the separation is more than 90 degrees.
+	if (abs_(theta) > 0.5 * PI64) {
+		normal = -normal;
+		theta = atan2(-dir.y, -dir.x) - atan2(normal.y, normal.x);
+	}
+	
+	// Apply snell's law:
+	// n_1 sin(theta_1) = n_2 sin(theta_2)
+	// Which becomes: theta_2 = asin(n_1 / n_2 * sin(theta_1))
+	bool refracted;
+	f64 amt = eta * sin(theta);
+	if (abs_(amt) > 1.0) {
+		// Reflect along normal.
+		theta = -theta;
+		refracted = false;
+	} else {
+		// Normal, refract through surface.
+		theta = asin(amt) + PI64;
+		refracted = true;
+	}
+	
+	// Convert the angle back to absolute coordinates.
+	theta += atan2(normal.y, normal.x);
+	dir.set(cos(theta), sin(theta));
+	
+	return refracted;
+}
+
+/**
+ * Flip a surface normal to face back along a ray.
+ * 
+ * @return	Cosine of the angle between the normal and the reversed ray.
+**/
+static f64 face_back(vector2dd& normal, const vector2dd& dir) {
+	f64 cos_i = -normal.dot_product(dir);
+	
+	if (cos_i < 0.0) {
+		normal = -normal;
+		cos_i = -cos_i;
+	}
+	
+	return cos_i;
+}
+
+/**
+ * Refract or reflect a ray with vectors, see refract_angles().  dir must be
+ * normalized.
+ * 
+ * With cos_i = -normal . dir, Snell's law gives
+ * sin^2(theta_t) = eta^2 (1 - cos_i^2), and the refracted direction is
+ * eta dir + (eta cos_i - cos_t) normal.  If sin^2(theta_t) > 1 the ray is
+ * reflected to dir + 2 cos_i normal instead.
+**/
+static bool refract_vector(vector2dd& dir, vector2dd& normal, f64 eta) {
+	const f64 cos_i = face_back(normal, dir);
+	const f64 sin_t_sq = eta * eta * (1.0 - cos_i * cos_i);
+	if (sin_t_sq > 1.0) {
+		dir += (2.0 * cos_i) * normal;
+		return false;
+	}
+	
+	const f64 cos_t = sqrt(1.0 - sin_t_sq);
+	dir = eta * dir + (eta * cos_i - cos_t) * normal;
+	return true;
+}
+
+void ray_tracer::trace_range(const ray_bundle& rays, size_t begin, size_t end, trace_result& out) const {
+	band single;
+	single.indices = m_system->indices();
+	single.out = &out;
+	
+	trace_bands(rays, begin, end, &single, 1);
+}
+
+void ray_tracer::trace_range(const ray_bundle& rays, size_t begin, size_t end, spectral_result& out) const {
+	const size_t gaps = m_system->size() + 1;
+	
+	std::vector<band> bands(out.m_bands.size());
+	for (size_t i = 0; i < bands.size(); ++i) {
+		bands[i].indices = &out.m_indices[i * gaps];
+		bands[i].out = &out.m_bands[i];
+	}
+	
+	if (!bands.empty()) trace_bands(rays, begin, end, &bands[0], bands.size());
+}
+
+/**
+ * Trace rays into each band.  The first cast of every ray is found once and
+ * shared by the bands, see split_ray().
+**/
+void ray_tracer::trace_bands(const ray_bundle& rays, size_t begin, size_t end, const band * bands, size_t band_count) const {
+	ray_hit first;
+	for (size_t ray = begin; ray < end; ++ray) {
+		const vector2dd start = rays.start(ray);
+		vector2dd dir = rays.dir(ray);
+		if (m_method == k_refract_vector) dir.normalize();
+		
+		const u32 gap = m_system->gap_at(start);
+		const bool found = (m_cast_limit > 0) && intersect(start, dir, gap, first);
+		
+		split_ray(ray, start, dir, gap, found ? &first : 0, bands, band_count);
+	}
+}
+
+/**
+ * Apply a ray's first hit to each band, and trace the rest of its path in
+ * each.
+ * 
+ * @param	start, dir	Start of the ray.
+ * @param	gap			Gap of the optical system the ray starts in.
+ * @param	first		First hit of the ray, or null if it misses the system.
+**/
+void ray_tracer::split_ray(size_t ray, const vector2dd& start, const vector2dd& dir, u32 gap, const ray_hit * first,
+						   const band * bands, size_t band_count) const {
+	if (!first) {
+		// Missed the system, or no casts are allowed.
+		for (size_t b = 0; b < band_count; ++b) {
+			trace_result& out = *bands[b].out;
+			out.m_hit_counts[ray] = 0;
+			out.m_escaped[ray] = (m_cast_limit > 0);
+			out.m_exit_start[ray] = start;
+			out.m_exit_dir[ray] = dir;
+		}
+		
+		return;
+	}
+	
+	ray_state state;
+	state.start = start;
+	state.dir = dir;
+	state.gap = gap;
+	state.from = k_no_surface;
+	
+	if (m_system->surface(first->surface).kind == optical_surface::k_aperture) {
+		// Nothing to share, trace each band from the start.
+		for (size_t b = 0; b < band_count; ++b) {
+			finish_ray(ray, state, 0, bands[b].indices, *bands[b].out);
+		}
+		
+		return;
+	}
+	
+	state.start = first->point;
+	state.from = first->surface;
+	
+	for (size_t b = 0; b < band_count; ++b) {
+		trace_result& out = *bands[b].out;
+		ray_hit& hit = out.m_hits[ray * m_cast_limit];
+		hit = *first;
+		hit.blocked = false;
+		
+		ray_state band_state = state;
+		refract(band_state, hit, bands[b].indices[gap] / bands[b].indices[state.gap_across()]);
+		finish_ray(ray, band_state, 1, bands[b].indices, out);
+	}
+}
+
+/**
+ * Trace the rest of a ray's path and store its results.
+ * 
+ * @param	state		Ray at the start of the next cast.
+ * @param	count		Number of hits already stored for the ray.
+ * @param	indices		Refractive index of each gap.
+**/
+void ray_tracer::finish_ray(size_t ray, ray_state state, u32 count, const f64 * indices, trace_result& out) const {
+	ray_hit * hits = &out.m_hits[ray * m_cast_limit];
+	bool escaped = false;
+	
+	while (count < m_cast_limit) {
+		ray_hit& hit = hits[count];
+		const step_result result = step(state, hit);
+		
+		if (result == k_step_escaped) {
+			escaped = true;
+			break;
+		}
+		
+		++count;
+		if (result == k_step_blocked) break;
+		
+		refract(state, hit, indices[state.gap] / indices[state.gap_across()]);
+	}
+	
+	out.m_hit_counts[ray] = count;
+	out.m_escaped[ray] = escaped;
+	out.m_exit_start[ray] = state.start;
+	out.m_exit_dir[ray] = state.dir;
+}
+
+ray_tracer::step_result ray_tracer::step(ray_state& ray, ray_hit& hit) const {
+	for (;;) {
+		if (!intersect(ray.start, ray.dir, ray.gap, hit, ray.from)) return k_step_escaped;
+		
+		ray.start = hit.point;
+		ray.from = hit.surface;
+		hit.reflected = false;
+		hit.blocked = false;
+		
+		// Apertures either stop the ray or let it through unchanged.
+		const optical_surface& surface = m_system->surface(hit.surface);
+		if (surface.kind != optical_surface::k_aperture) return k_step_surface;
+		
+		if (surface.blocks(hit.point)) {
+			hit.blocked = true;
+			return k_step_blocked;
+		}
+		
+		ray.gap = ray.gap_across();
+	}
+}
+
+bool ray_tracer::refract(ray_state& ray, ray_hit& hit, f64 eta) const {
+	const bool refracted = (m_method == k_refract_angles)
+		? refract_angles(ray.dir, hit.normal, eta)
+		: refract_vector(ray.dir, hit.normal, eta);
+	
+	hit.reflected = !refracted;
+	if (refracted) ray.gap = ray.gap_across();
+	
+	return refracted;
+}
+
+void ray_tracer::reflect(ray_state& ray, ray_hit& hit) const {
+	const f64 cos_i = face_back(hit.normal, ray.dir);
+	ray.dir += (2.0 * cos_i) * hit.normal;
+	hit.reflected = true;
+}
+
+/**
+ * Find where a ray meets one surface, see intersect().
+**/
+static bool intersect_surface(const optical_surface& surface, const vector2dd& start, const vector2dd& dir, bool use_angles, bool on_surface, ray_hit& hit) {
+	if (use_angles && surface.kind == optical_surface::k_spherical) {
+		return surface.arc.ray_intersect(start, dir, hit.point, hit.normal, on_surface);
+	}
+	
+	return surface.ray_intersect(start, dir, hit.point, hit.normal, on_surface);
+}
+
+/**
+ * Find the surface a ray hits next.  Surfaces are in order along the axis,
+ * so only the two bounding the ray's gap need testing.
+ * 
+ * @param	gap		Gap of the optical system the ray is in.
+ * @param	hit		Receives the point, normal and surface hit.
+ * @param	from	Surface the ray starts on, or k_no_surface.
+ * @return	false if the ray hits neither surface.
+**/
+bool ray_tracer::intersect(const vector2dd& start, const vector2dd& dir, u32 gap, ray_hit& hit, u32 from) const {
+	const bool use_angles = (m_method == k_refract_angles);
+	
+	/* Heading in +x the ray meets the surface to the right of its gap first,
+	 * and in -x the one to the left.  A ray reflected inside a curved
+	 * surface can still head back into the same surface, so the other one
+	 * is tried if the first is missed.
+	**/
+	u32 order[2] = { gap, gap - 1 };
+	if (dir.x < 0.0) std::swap(order[0], order[1]);
+	
+	for (u32 i = 0; i < 2; ++i) {
+		const u32 idx = order[i];
+		if (idx >= m_system->size()) continue; // Past either end, including gap - 1 wrapping for gap 0.
+		
+		if (intersect_surface(m_system->surface(idx), start, dir, use_angles, from == idx, hit)) {
+			hit.surface = idx;
+			return true;
+		}
+	}
+	
+	return false;
+}
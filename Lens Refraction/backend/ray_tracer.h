@@ -0,0 +1,330 @@
+/*
+ * ray_tracer.h
+ * Lens Refraction
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+
+#ifndef _RAY_TRACER_H
+#define _RAY_TRACER_H
+
+#include <vector>
+#include "lens_backend.h"
+
+class thread_pool;
+
+/**
+ * A set of rays, stored as separate arrays of start points and directions.
+**/
+struct ray_bundle {
+	std::vector<f64> start_x;
+	std::vector<f64> start_y;
+	std::vector<f64> dir_x;
+	std::vector<f64> dir_y;
+	
+	size_t size() const { return start_x.size(); }
+	bool empty() const { return start_x.empty(); }
+	
+	void clear() {
+		start_x.clear();
+		start_y.clear();
+		dir_x.clear();
+		dir_y.clear();
+	}
+	
+	void reserve(size_t count) {
+		start_x.reserve(count);
+		start_y.reserve(count);
+		dir_x.reserve(count);
+		dir_y.reserve(count);
+	}
+	
+	/**
+	 * Add a ray.  The direction need not be normalized.
+	**/
+	void add(const vector2dd& start, const vector2dd& dir) {
+		start_x.push_back(start.x);
+		start_y.push_back(start.y);
+		dir_x.push_back(dir.x);
+		dir_y.push_back(dir.y);
+	}
+	
+	vector2dd start(size_t idx) const { return vector2dd(start_x[idx], start_y[idx]); }
+	vector2dd dir(size_t idx) const { return vector2dd(dir_x[idx], dir_y[idx]); }
+};
+
+/**
+ * Where a ray met a surface of an optical_system.
+**/
+struct ray_hit {
+	vector2dd point;	/// Point on the surface, in meters.
+	vector2dd normal;	/// Surface normal, facing back along the incoming ray.
+	u32 surface;		/// Index of the surface in the optical_system.
+	bool reflected;		/// Totally internally reflected rather than refracted.
+	bool blocked;		/// Stopped by an aperture, which ends the path.
+};
+
+/**
+ * A ray partway along its path through an optical_system, for tracing paths
+ * step by step with ray_tracer::step().
+**/
+struct ray_state {
+	vector2dd start;	/// Start of the next cast.
+	vector2dd dir;		/// Direction of the next cast.
+	u32 gap;			/// Gap of the optical system the ray is in.
+	u32 from;			/// Surface the ray starts on, or ray_tracer::k_no_surface.
+	
+	/// Gets the gap on the other side of the surface the ray starts on.
+	u32 gap_across() const { return (from == gap) ? gap + 1 : gap - 1; }
+};
+
+/**
+ * Traced paths for a ray_bundle.
+ * 
+ * Each ray gets cast_limit() hit slots at a fixed offset, so rays can be
+ * traced in parallel without sharing any output.
+**/
+class trace_result {
+public:
+	trace_result() : m_cast_limit(0) { }
+	
+	/**
+	 * Size the buffers for a number of rays, keeping the allocation if it is
+	 * large enough.
+	**/
+	void resize(size_t rays, u32 cast_limit) {
+		m_cast_limit = cast_limit;
+		m_hits.resize(rays * cast_limit);
+		m_hit_counts.resize(rays);
+		m_escaped.resize(rays);
+		m_exit_start.resize(rays);
+		m_exit_dir.resize(rays);
+	}
+	
+	size_t size() const { return m_hit_counts.size(); }
+	u32 cast_limit() const { return m_cast_limit; }
+	
+	/**
+	 * Get the number of surfaces a ray hit.
+	**/
+	u32 hit_count(size_t ray) const { return m_hit_counts[ray]; }
+	
+	/**
+	 * Get the hits for a ray, in order, hit_count(ray) of them.
+	**/
+	const ray_hit * hits(size_t ray) const { return &m_hits[ray * m_cast_limit]; }
+	
+	/**
+	 * Did the ray leave the system before reaching the cast limit or being
+	 * blocked?
+	**/
+	bool escaped(size_t ray) const { return m_escaped[ray] != 0; }
+	
+	/**
+	 * Get the last segment of the ray, from its last hit (or its start) in the
+	 * direction it leaves in.
+	**/
+	const vector2dd& exit_start(size_t ray) const { return m_exit_start[ray]; }
+	const vector2dd& exit_dir(size_t ray) const { return m_exit_dir[ray]; }
+	
+private:
+	friend class ray_tracer;
+	
+	u32 m_cast_limit;
+	
+	std::vector<ray_hit> m_hits;
+	std::vector<u32> m_hit_counts;
+	std::vector<u8> m_escaped;
+	std::vector<vector2dd> m_exit_start;
+	std::vector<vector2dd> m_exit_dir;
+};
+
+/**
+ * Traced paths for a ray_bundle at several wavelengths, one trace_result per
+ * wavelength band.  Every band has the same rays in the same order, so the
+ * bands can be weighted by wavelength_to_rgb() and summed.
+**/
+class spectral_result {
+public:
+	size_t band_count() const { return m_bands.size(); }
+	
+	/**
+	 * Get the wavelength of a band, in nanometers.
+	**/
+	f64 wavelength(size_t band) const { return m_wavelengths[band]; }
+	
+	/**
+	 * Get the paths traced at a band's wavelength.
+	**/
+	const trace_result& band(size_t band) const { return m_bands[band]; }
+	
+private:
+	friend class ray_tracer;
+	
+	std::vector<f64> m_wavelengths;
+	std::vector<f64> m_indices; // Index of each gap of the system, for each band.
+	std::vector<trace_result> m_bands;
+};
+
+/**
+ * Traces rays through an optical_system, one surface at a time in order.
+ * 
+ * The tracer keeps a reference to the system, which must outlive it and
+ * not change while tracing.  Tracing only reads the tracer and the bundle
+ * and writes each ray's own slots in the result, so a thread_pool can split
+ * a bundle across cores.
+**/
+class ray_tracer {
+public:
+	/**
+	 * How to intersect surfaces and apply Snell's law.
+	**/
+	enum refraction_method {
+		k_refract_vector = 0,	/// Dot products and a square root.
+		k_refract_angles = 1	/// Through angles with atan2, asin, sin and cos, as first written.
+	};
+	
+	/**
+	 * What a ray met on a step().
+	**/
+	enum step_result {
+		k_step_escaped = 0,	/// Left the system.
+		k_step_blocked = 1,	/// Stopped by an aperture.
+		k_step_surface = 2	/// Met a surface, to be refracted or reflected.
+	};
+	
+	static const u32 k_default_cast_limit = 10;
+	
+	/// Surface index for a ray that does not start on a surface.
+	static const u32 k_no_surface = 0xffffffff;
+	
+	/**
+	 * @param	system	Surfaces to trace through, in meters.
+	**/
+	explicit ray_tracer(const optical_system& system)
+			: m_system(&system)
+			, m_cast_limit(k_default_cast_limit)
+			, m_method(k_refract_vector) {
+	}
+	
+	/// Gets/sets the most surfaces a ray may hit.
+	u32 cast_limit() const { return m_cast_limit; }
+	void cast_limit(u32 limit) { m_cast_limit = limit; }
+	
+	/// Gets/sets how surfaces are intersected and rays refracted.  Both give
+	/// the same paths to within rounding, the angle form is kept to check
+	/// the vector form against.
+	refraction_method method() const { return m_method; }
+	void method(refraction_method method) { m_method = method; }
+	
+	/**
+	 * Trace every ray in a bundle.  Each ray starts in the gap that
+	 * optical_system::gap_at() gives for its start point.
+	 * 
+	 * @param	rays	Rays to trace.
+	 * @param	out		Receives the paths, resized to fit.
+	 * @param	pool	Threads to trace on, or null to trace on the calling
+	 * 					thread.
+	**/
+	void trace(const ray_bundle& rays, trace_result& out, thread_pool * pool = 0) const;
+	
+	/**
+	 * Trace every ray in a bundle at several wavelengths, using the
+	 * dispersion of each medium.
+	 * 
+	 * A ray's first cast is shared by all of the wavelengths, they only
+	 * split when the ray is first refracted.
+	 * 
+	 * @param	wavelengths	Wavelengths to trace, in nanometers.
+	 * @param	count		Number of wavelengths.
+	 * @param	out			Receives a band of paths for each wavelength.
+	**/
+	void trace(const ray_bundle& rays, const f64 * wavelengths, size_t count, spectral_result& out, thread_pool * pool = 0) const;
+	
+	/**
+	 * Trace the rays [begin, end) of a bundle into a result already sized for
+	 * it.
+	**/
+	void trace_range(const ray_bundle& rays, size_t begin, size_t end, trace_result& out) const;
+	void trace_range(const ray_bundle& rays, size_t begin, size_t end, spectral_result& out) const;
+	
+	/**
+	 * Find the surface a ray in a gap of the system hits next, for tracing
+	 * paths step by step.  Only the point, normal and surface of the hit are
+	 * set.
+	 * 
+	 * @param	from	Surface the ray starts on, after reflecting or
+	 * 					refracting there, or k_no_surface.  The ray's own
+	 * 					start point is never hit again.
+	 * @return	false if the ray leaves the system.
+	**/
+	bool intersect(const vector2dd& start, const vector2dd& dir, u32 gap, ray_hit& hit, u32 from = k_no_surface) const;
+	
+	/**
+	 * Cast a ray to the next surface it meets, passing through open
+	 * apertures.  The ray is moved to the hit, and if it met a surface it
+	 * must be refracted or reflected before the next step.  The hit is not
+	 * marked as reflected.
+	 * 
+	 * @param	ray	Ray to cast, with a normalized direction for
+	 * 				k_refract_vector.
+	 * @param	hit	Receives where the ray was blocked or met a surface.
+	**/
+	step_result step(ray_state& ray, ray_hit& hit) const;
+	
+	/**
+	 * Refract a ray through the surface it was stepped to, with the
+	 * tracer's method, or reflect it if it is past the critical angle.  The
+	 * normal of the hit is flipped to face back along the ray.
+	 * 
+	 * @param	eta	Ratio of the refractive indices of ray.gap and
+	 * 				ray.gap_across().
+	 * @return	true if refracted, false if totally internally reflected.
+	**/
+	bool refract(ray_state& ray, ray_hit& hit, f64 eta) const;
+	
+	/**
+	 * Reflect a ray off the surface it was stepped to, see refract().
+	**/
+	void reflect(ray_state& ray, ray_hit& hit) const;
+	
+	/// Gets the system being traced.
+	const optical_system& system() const { return *m_system; }
+	
+private:
+	const optical_system * m_system;
+	
+	u32 m_cast_limit;
+	refraction_method m_method;
+	
+	/**
+	 * Refractive indices to trace with and the result they fill.
+	**/
+	struct band {
+		const f64 * indices;
+		trace_result * out;
+	};
+	
+	void trace_bands(const ray_bundle& rays, size_t begin, size_t end, const band * bands, size_t band_count) const;
+	void split_ray(size_t ray, const vector2dd& start, const vector2dd& dir, u32 gap, const ray_hit * first, const band * bands, size_t band_count) const;
+	void finish_ray(size_t ray, ray_state state, u32 count, const f64 * indices, trace_result& out) const;
+};
+
+#endif // _RAY_TRACER_H
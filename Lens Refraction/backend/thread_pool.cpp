@@ -0,0 +1,143 @@
+/*
+ * thread_pool.cpp
+ * Lens Refraction
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+
+#include "thread_pool.h"
+#include "mathutil.h"
+#include <unistd.h>
+
+thread_pool::thread_pool(u32 threads)
+		: m_fn(0)
+		, m_context(0)
+		, m_count(0)
+		, m_grain(1)
+		, m_next(0)
+		, m_generation(0)
+		, m_finished(0)
+		, m_quit(false) {
+	pthread_mutex_init(&m_mutex, 0);
+	pthread_cond_init(&m_work_cond, 0);
+	pthread_cond_init(&m_done_cond, 0);
+	
+	if (threads == 0) threads = processor_count();
+	
+	// The calling thread is one of the threads.
+	for (u32 i = 1; i < threads; ++i) {
+		pthread_t thread;
+		if (pthread_create(&thread, 0, &thread_pool::worker_main, this) != 0) break;
+		
+		m_threads.push_back(thread);
+	}
+}
+
+thread_pool::~thread_pool() {
+	pthread_mutex_lock(&m_mutex);
+	m_quit = true;
+	pthread_cond_broadcast(&m_work_cond);
+	pthread_mutex_unlock(&m_mutex);
+	
+	for (size_t i = 0; i < m_threads.size(); ++i) {
+		pthread_join(m_threads[i], 0);
+	}
+	
+	pthread_cond_destroy(&m_done_cond);
+	pthread_cond_destroy(&m_work_cond);
+	pthread_mutex_destroy(&m_mutex);
+}
+
+void thread_pool::parallel_for(size_t count, size_t grain, task_fn fn, void * context) {
+	if (grain == 0) grain = 1;
+	
+	// Not worth waking the workers.
+	if (m_threads.empty() || count <= grain) {
+		if (count) fn(context, 0, count);
+		return;
+	}
+	
+	pthread_mutex_lock(&m_mutex);
+	m_fn = fn;
+	m_context = context;
+	m_count = count;
+	m_grain = grain;
+	m_next = 0;
+	m_finished = 0;
+	++m_generation;
+	pthread_cond_broadcast(&m_work_cond);
+	pthread_mutex_unlock(&m_mutex);
+	
+	run_chunks();
+	
+	// Every worker takes part in every loop, wait for all of them so that
+	// none are still looking at this one when the next starts.
+	pthread_mutex_lock(&m_mutex);
+	while (m_finished < m_threads.size()) {
+		pthread_cond_wait(&m_done_cond, &m_mutex);
+	}
+	pthread_mutex_unlock(&m_mutex);
+}
+
+u32 thread_pool::processor_count() {
+	const long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count < 1 ? 1 : u32(count);
+}
+
+/**
+ * Claim and run chunks until there are none left.
+**/
+void thread_pool::run_chunks() {
+	for (;;) {
+		const size_t begin = __sync_fetch_and_add(&m_next, m_grain);
+		if (begin >= m_count) break;
+		
+		m_fn(m_context, begin, min_(begin + m_grain, m_count));
+	}
+}
+
+/**
+ * Worker thread body.
+**/
+void thread_pool::worker_loop() {
+	u32 seen = 0;
+	
+	pthread_mutex_lock(&m_mutex);
+	for (;;) {
+		while (!m_quit && m_generation == seen) {
+			pthread_cond_wait(&m_work_cond, &m_mutex);
+		}
+		
+		if (m_quit) break;
+		seen = m_generation;
+		
+		pthread_mutex_unlock(&m_mutex);
+		run_chunks();
+		pthread_mutex_lock(&m_mutex);
+		
+		if (++m_finished == m_threads.size()) pthread_cond_signal(&m_done_cond);
+	}
+	pthread_mutex_unlock(&m_mutex);
+}
+
+void * thread_pool::worker_main(void * pool) {
+	static_cast<thread_pool *>(pool)->worker_loop();
+	return 0;
+}
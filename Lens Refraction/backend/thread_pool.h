@@ -0,0 +1,107 @@
+/*
+ * thread_pool.h
+ * Lens Refraction
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+
+#ifndef _THREAD_POOL_H
+#define _THREAD_POOL_H
+
+#include <pthread.h>
+#include <vector>
+#include "types.h"
+using namespace donner;
+
+/**
+ * A fixed set of worker threads for running loops in parallel.
+ * 
+ * parallel_for() splits [0, count) into chunks that the workers and the
+ * calling thread claim one at a time until none are left, so uneven chunks
+ * balance out.  Only one loop runs at a time.
+**/
+class thread_pool {
+public:
+	/**
+	 * Function run on each chunk, for indices [begin, end).
+	**/
+	typedef void (*task_fn)(void * context, size_t begin, size_t end);
+	
+	/**
+	 * Start the worker threads.
+	 * 
+	 * @param	threads		Total number of threads to run loops on, including
+	 * 						the calling thread.  0 uses one per processor.
+	**/
+	explicit thread_pool(u32 threads = 0);
+	~thread_pool();
+	
+	/**
+	 * Get the number of threads loops run on, including the calling thread.
+	**/
+	u32 size() const { return u32(m_threads.size()) + 1; }
+	
+	/**
+	 * Run fn over [0, count) in chunks of at most grain indices, returning
+	 * when all chunks are done.
+	**/
+	void parallel_for(size_t count, size_t grain, task_fn fn, void * context);
+	
+	/**
+	 * Get the number of processors online.
+	**/
+	static u32 processor_count();
+	
+private:
+	std::vector<pthread_t> m_threads;
+	
+	pthread_mutex_t m_mutex;
+	pthread_cond_t m_work_cond; // Signaled when a loop starts or on shutdown.
+	pthread_cond_t m_done_cond; // Signaled when the last worker finishes a loop.
+	
+	// The current loop.  These are only written while no workers are running
+	// it, under m_mutex.
+	task_fn m_fn;
+	void * m_context;
+	size_t m_count;
+	size_t m_grain;
+	
+	volatile size_t m_next;		// Start of the next chunk to claim.
+	u32 m_generation;			// Incremented for every loop.
+	u32 m_finished;				// Workers done with the current loop.
+	bool m_quit;
+	
+	/**
+	 * Claim and run chunks until there are none left.
+	**/
+	void run_chunks();
+	
+	/**
+	 * Worker thread body.
+	**/
+	void worker_loop();
+	static void * worker_main(void * pool);
+	
+	// Not copyable.
+	thread_pool(const thread_pool&);
+	thread_pool& operator=(const thread_pool&);
+};
+
+#endif // _THREAD_POOL_H
@@ -78,6 +78,22 @@ typedef signed int		s32;
 
 
 
+/// 64 bit unsigned variable.
+#ifdef _MSC_VER
+typedef unsigned __int64	u64;
+#else
+typedef unsigned long long	u64;
+#endif
+
+/// 64 bit signed variable.
+#ifdef _MSC_VER
+typedef __int64			s64;
+#else
+typedef signed long long	s64;
+#endif
+
+
+
 /// 32 bit floating point variable.
 typedef float				f32;
 
@@ -88,6 +104,23 @@ typedef double				f64;
 /// Insert a string literal and its length into a parameter list.
 #define CONST_STR_LEN(str) str, ((sizeof(str) / sizeof(*str)) - 1)
 
+/// constexpr and noexcept where the language has them.  constexpr functions
+/// need C++14, which allows more than a single return statement; older
+/// compilers get plain inline functions.
+#if __cplusplus >= 201402L
+	#define CONSTEXPR constexpr
+#else
+	#define CONSTEXPR inline
+#endif
+
+#if __cplusplus >= 201103L
+	#define CONSTEXPR_VAR constexpr
+	#define NOEXCEPT noexcept
+#else
+	#define CONSTEXPR_VAR const
+	#define NOEXCEPT
+#endif
+
 /*****************************************************************************/
 } // End of namespace donner.
 
@@ -27,6 +27,10 @@
 #include "mathutil.h"
 #include <iostream>
 
+#if __cplusplus >= 201103L
+#include <type_traits>
+#endif
+
 namespace donner {
 /*****************************************************************************/
 
@@ -38,47 +42,48 @@ struct vector2d {
 	/*************************************************************************/
 	// Constructors.
 	
-	vector2d() : x(0), y(0) { }
-	vector2d(const vector2d<T>& other) : x(other.x), y(other.y) { }
-	vector2d(T _x, T _y) : x(_x), y(_y) { }
+	// Copying is left to the compiler, which keeps the type trivially
+	// copyable.
+	CONSTEXPR vector2d() NOEXCEPT : x(0), y(0) { }
+	CONSTEXPR vector2d(T _x, T _y) NOEXCEPT : x(_x), y(_y) { }
 	
 	
 	/*************************************************************************/
 	// Manipulators.
 	
-	void set(const vector2d<T>& rhs) {
+	CONSTEXPR void set(const vector2d<T>& rhs) NOEXCEPT {
 		x = rhs.x;
 		y = rhs.y;
 	}
 	
-	void set(T _x, T _y) {
+	CONSTEXPR void set(T _x, T _y) NOEXCEPT {
 		x = _x;
 		y = _y;
 	}
 	
-	bool equals(const vector2d<T>& rhs) const {
+	CONSTEXPR bool equals(const vector2d<T>& rhs) const NOEXCEPT {
 		return donner::equals(x, rhs.x) && donner::equals(y, rhs.y);
 	}
 	
-	T length() const { return (T) sqrt(f64(x * x + y * y)); }
-	T length_sq() const { return x * x + y * y; }
+	T length() const NOEXCEPT { return (T) sqrt(f64(x * x + y * y)); }
+	CONSTEXPR T length_sq() const NOEXCEPT { return x * x + y * y; }
 	
-	T dot_product(const vector2d<T>& rhs) const { return x * rhs.x + y * rhs.y; }
+	CONSTEXPR T dot_product(const vector2d<T>& rhs) const NOEXCEPT { return x * rhs.x + y * rhs.y; }
 	
-	void rotate(f64 degrees) {
+	void rotate(f64 degrees) NOEXCEPT {
 		degrees *= DEGTORAD64;
 		rotate(vector2d<T>((T) cos(degrees), (T) sin(degrees)));
 	}
 	
-	void rotate_rad(f64 rad) {
+	void rotate_rad(f64 rad) NOEXCEPT {
 		rotate(vector2d<T>((T) cos(rad), (T) sin(rad)));
 	}
 	
-	void rotate(const vector2d<T>& cos_sin) {
+	CONSTEXPR void rotate(const vector2d<T>& cos_sin) NOEXCEPT {
 		set(x * cos_sin.x - y * cos_sin.y, x * cos_sin.y + y * cos_sin.x);
 	}
 	
-	const vector2d<T>& normalize() {
+	const vector2d<T>& normalize() NOEXCEPT {
 		T inv_len = T(1.0) / length();
 		x *= inv_len;
 		y *= inv_len;
@@ -89,46 +94,45 @@ struct vector2d {
 	/*************************************************************************/
 	// Operators.
 	
-	vector2d<T> operator-() const { return vector2d<T>(-x, -y); }
-	vector2d<T>& operator=(const vector2d<T>& rhs) { set(rhs); return *this; }
+	CONSTEXPR vector2d<T> operator-() const NOEXCEPT { return vector2d<T>(-x, -y); }
 	
 	// Addition.
-	vector2d<T> operator+(const vector2d<T>& rhs) const { return vector2d<T>(x + rhs.x, y + rhs.y); }
-	vector2d<T>& operator+=(const vector2d<T>& rhs) { x += rhs.x; y += rhs.y; return *this; }
-	vector2d<T> operator+(const T a) const { return vector2d<T>(x + a, y + a); }
-	vector2d<T>& operator+=(const T a) { x += a; y += a; return *this; }
-	friend vector2d<T> operator+(const T a, const vector2d<T>& other) { return vector2d<T>(a + other.x, a + other.y); }
+	CONSTEXPR vector2d<T> operator+(const vector2d<T>& rhs) const NOEXCEPT { return vector2d<T>(x + rhs.x, y + rhs.y); }
+	CONSTEXPR vector2d<T>& operator+=(const vector2d<T>& rhs) NOEXCEPT { x += rhs.x; y += rhs.y; return *this; }
+	CONSTEXPR vector2d<T> operator+(const T a) const NOEXCEPT { return vector2d<T>(x + a, y + a); }
+	CONSTEXPR vector2d<T>& operator+=(const T a) NOEXCEPT { x += a; y += a; return *this; }
+	friend CONSTEXPR vector2d<T> operator+(const T a, const vector2d<T>& other) NOEXCEPT { return vector2d<T>(a + other.x, a + other.y); }
 	
 	// Subtraction.
-	vector2d<T> operator-(const vector2d<T>& rhs) const { return vector2d<T>(x - rhs.x, y - rhs.y); }
-	vector2d<T>& operator-=(const vector2d<T>& rhs) { x -= rhs.x; y -= rhs.y; return *this; }
-	vector2d<T> operator-(const T a) const { return vector2d<T>(x - a, y - a); }
-	vector2d<T>& operator-=(const T a) { x -= a; y -= a; return *this; }
-	friend vector2d<T> operator-(const T a, const vector2d<T>& other) { return vector2d<T>(a - other.x, a - other.y); }
+	CONSTEXPR vector2d<T> operator-(const vector2d<T>& rhs) const NOEXCEPT { return vector2d<T>(x - rhs.x, y - rhs.y); }
+	CONSTEXPR vector2d<T>& operator-=(const vector2d<T>& rhs) NOEXCEPT { x -= rhs.x; y -= rhs.y; return *this; }
+	CONSTEXPR vector2d<T> operator-(const T a) const NOEXCEPT { return vector2d<T>(x - a, y - a); }
+	CONSTEXPR vector2d<T>& operator-=(const T a) NOEXCEPT { x -= a; y -= a; return *this; }
+	friend CONSTEXPR vector2d<T> operator-(const T a, const vector2d<T>& other) NOEXCEPT { return vector2d<T>(a - other.x, a - other.y); }
 	
 	// Multiplication.
-	vector2d<T> operator*(const vector2d<T>& rhs) const { return vector2d<T>(x * rhs.x, y * rhs.y); }
-	vector2d<T>& operator*=(const vector2d<T>& rhs) { x *= rhs.x; y *= rhs.y; return *this; }
-	vector2d<T> operator*(const T a) const { return vector2d<T>(x * a, y * a); }
-	vector2d<T>& operator*=(const T a) { x *= a; y *= a; return *this; }
-	friend vector2d<T> operator*(const T a, const vector2d<T>& other) { return vector2d<T>(a * other.x, a * other.y); }
+	CONSTEXPR vector2d<T> operator*(const vector2d<T>& rhs) const NOEXCEPT { return vector2d<T>(x * rhs.x, y * rhs.y); }
+	CONSTEXPR vector2d<T>& operator*=(const vector2d<T>& rhs) NOEXCEPT { x *= rhs.x; y *= rhs.y; return *this; }
+	CONSTEXPR vector2d<T> operator*(const T a) const NOEXCEPT { return vector2d<T>(x * a, y * a); }
+	CONSTEXPR vector2d<T>& operator*=(const T a) NOEXCEPT { x *= a; y *= a; return *this; }
+	friend CONSTEXPR vector2d<T> operator*(const T a, const vector2d<T>& other) NOEXCEPT { return vector2d<T>(a * other.x, a * other.y); }
 	
 	// Division.
-	vector2d<T> operator/(const vector2d<T>& rhs) const { return vector2d<T>(x / rhs.x, y / rhs.y); }
-	vector2d<T>& operator/=(const vector2d<T>& rhs) { x /= rhs.x; y /= rhs.y; return *this; }
-	vector2d<T> operator/(const T a) const { return vector2d<T>(x / a, y / a); }
-	vector2d<T>& operator/=(const T a) { x /= a; y /= a; return *this; }
-	friend vector2d<T> operator/(const T a, const vector2d<T>& other) { return vector2d<T>(a / other.x, a / other.y); }
+	CONSTEXPR vector2d<T> operator/(const vector2d<T>& rhs) const NOEXCEPT { return vector2d<T>(x / rhs.x, y / rhs.y); }
+	CONSTEXPR vector2d<T>& operator/=(const vector2d<T>& rhs) NOEXCEPT { x /= rhs.x; y /= rhs.y; return *this; }
+	CONSTEXPR vector2d<T> operator/(const T a) const NOEXCEPT { return vector2d<T>(x / a, y / a); }
+	CONSTEXPR vector2d<T>& operator/=(const T a) NOEXCEPT { x /= a; y /= a; return *this; }
+	friend CONSTEXPR vector2d<T> operator/(const T a, const vector2d<T>& other) NOEXCEPT { return vector2d<T>(a / other.x, a / other.y); }
 	
 	// Comparison.
-	bool operator<=(const vector2d<T>& rhs) const { return x <= rhs.x && y <= rhs.y; }
-	bool operator>=(const vector2d<T>& rhs) const { return x >= rhs.x && y >= rhs.y; }
+	CONSTEXPR bool operator<=(const vector2d<T>& rhs) const NOEXCEPT { return x <= rhs.x && y <= rhs.y; }
+	CONSTEXPR bool operator>=(const vector2d<T>& rhs) const NOEXCEPT { return x >= rhs.x && y >= rhs.y; }
 	
-	bool operator<(const vector2d<T>& rhs) const { return x < rhs.x && y < rhs.y; }
-	bool operator>(const vector2d<T>& rhs) const { return x > rhs.x && y > rhs.y; }
+	CONSTEXPR bool operator<(const vector2d<T>& rhs) const NOEXCEPT { return x < rhs.x && y < rhs.y; }
+	CONSTEXPR bool operator>(const vector2d<T>& rhs) const NOEXCEPT { return x > rhs.x && y > rhs.y; }
 	
-	bool operator==(const vector2d<T>& rhs) const { return equals(rhs); }
-	bool operator!=(const vector2d<T>& rhs) const { return !equals(rhs); }
+	CONSTEXPR bool operator==(const vector2d<T>& rhs) const NOEXCEPT { return equals(rhs); }
+	CONSTEXPR bool operator!=(const vector2d<T>& rhs) const NOEXCEPT { return !equals(rhs); }
 	
 	// Ostream.
 	friend std::ostream& operator<<(std::ostream& os, const vector2d<T>& vec) {
@@ -147,6 +151,20 @@ typedef vector2d<f64> vector2dd;
 typedef vector2d<s32> vector2di;
 typedef vector2d<u32> vector2du;
 
+/* Rays and surfaces are copied in bulk and viewed as flat f64 arrays, and
+ * tables of them are built at compile time.
+**/
+#if __cplusplus >= 201103L
+static_assert(std::is_trivially_copyable<vector2dd>::value, "vector2dd must be trivially copyable");
+static_assert(std::is_trivially_copyable<vector2df>::value, "vector2df must be trivially copyable");
+static_assert(sizeof(vector2dd) == 2 * sizeof(f64), "vector2dd must be two packed f64s");
+#endif
+
+#if __cplusplus >= 201402L
+static_assert((vector2dd(1.0, 2.0) + vector2dd(3.0, 4.0)).dot_product(vector2dd(1.0, 1.0)) == 10.0,
+			  "vector2d arithmetic must be usable in constant expressions");
+#endif
+
 /*****************************************************************************/
 } // End of namespace donner.
 
@@ -0,0 +1,143 @@
+/*
+ * lens_sweep.cpp
+ * Lens Refraction
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+/**
+ * Headless lens parameter sweep.  Build without the Cocoa front end with:
+ * 
+ * c++ -O2 -Ibackend tools/lens_sweep.cpp backend/lens_sweep.cpp \
+ *     backend/lens_backend.cpp backend/optical_system.cpp \
+ *     backend/ray_tracer.cpp backend/thread_pool.cpp backend/dispersion.cpp \
+ *     backend/caustic.cpp backend/paraxial.cpp -lcairo -lpthread -o lens_sweep
+ * 
+ * Each parameter takes a single value or first:last:steps, for example:
+ * 
+ * lens_sweep --left 1.1:4:30 --right 1.1:4:30 --inside 1.3:1.9:7 > sweep.csv
+**/
+
+#include "lens_sweep.h"
+#include "thread_pool.h"
+#include <cstdlib>
+#include <cstring>
+
+static void usage(const char * name) {
+	fprintf(stderr,
+			"usage: %s [options]\n"
+			"  --left RANGE       Radius of the left of the lens, in meters.\n"
+			"  --right RANGE      Radius of the right of the lens, in meters.\n"
+			"  --inside RANGE     Refractive index inside the lens.\n"
+			"  --outside RANGE    Refractive index outside the lens.\n"
+			"  --rays N           Rays traced through each design.\n"
+			"  --aperture F       Height of the beam, as a fraction of the lens.\n"
+			"  --threads N        Threads to run on, 0 for one per processor.\n"
+			"  --format FORMAT    csv or columnar.\n"
+			"  --output FILE      Write to FILE instead of stdout.\n"
+			"\n"
+			"RANGE is a value or first:last:steps.  Radii are at least 1 in size,\n"
+			"smaller ones are clamped.\n", name);
+}
+
+/**
+ * Parse a value or first:last:steps.
+**/
+static bool parse_range(const char * str, sweep_range& out) {
+	char * end;
+	out.first = out.last = strtod(str, &end);
+	out.steps = 1;
+	if (end == str) return false;
+	if (*end == '\0') return true;
+	
+	if (*end != ':') return false;
+	str = end + 1;
+	out.last = strtod(str, &end);
+	if (end == str || *end != ':') return false;
+	
+	str = end + 1;
+	const long steps = strtol(str, &end, 10);
+	if (end == str || *end != '\0' || steps < 1) return false;
+	
+	out.steps = u32(steps);
+	return true;
+}
+
+int main(int argc, char * argv[]) {
+	sweep_grid grid;
+	lens_sweep sweep;
+	u32 threads = 0;
+	bool columnar = false;
+	const char * output = 0;
+	
+	for (int i = 1; i < argc; ++i) {
+		const char * arg = argv[i];
+		const char * value = (i + 1 < argc) ? argv[i + 1] : 0;
+		
+		if (!strcmp(arg, "--help") || !strcmp(arg, "-h")) {
+			usage(argv[0]);
+			return 0;
+		}
+		
+		if (!value) {
+			usage(argv[0]);
+			return 1;
+		}
+		
+		bool ok = true;
+		if (!strcmp(arg, "--left")) ok = parse_range(value, grid.left_radius);
+		else if (!strcmp(arg, "--right")) ok = parse_range(value, grid.right_radius);
+		else if (!strcmp(arg, "--inside")) ok = parse_range(value, grid.inside_n);
+		else if (!strcmp(arg, "--outside")) ok = parse_range(value, grid.outside_n);
+		else if (!strcmp(arg, "--rays")) sweep.rays(u32(max_(atol(value), 1L)));
+		else if (!strcmp(arg, "--aperture")) sweep.aperture(atof(value));
+		else if (!strcmp(arg, "--threads")) threads = u32(max_(atol(value), 0L));
+		else if (!strcmp(arg, "--format")) {
+			if (!strcmp(value, "columnar")) columnar = true;
+			else ok = !strcmp(value, "csv");
+		} else if (!strcmp(arg, "--output")) output = value;
+		else ok = false;
+		
+		if (!ok) {
+			fprintf(stderr, "%s: bad argument %s %s\n", argv[0], arg, value);
+			usage(argv[0]);
+			return 1;
+		}
+		
+		++i;
+	}
+	
+	FILE * file = stdout;
+	if (output) {
+		file = fopen(output, columnar ? "wb" : "w");
+		if (!file) {
+			perror(output);
+			return 1;
+		}
+	}
+	
+	thread_pool pool(threads);
+	csv_sweep_writer csv(file);
+	columnar_sweep_writer binary(file);
+	
+	sweep.run(grid, columnar ? static_cast<sweep_writer&>(binary) : csv, &pool);
+	
+	if (output) fclose(file);
+	return 0;
+}
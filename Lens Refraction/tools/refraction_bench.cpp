@@ -0,0 +1,293 @@
+/*
+ * refraction_bench.cpp
+ * Lens Refraction
+ * 
+ * Created by Jeff McGlynn on 10/18/26.
+ * 
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * 
+ * Copyright (c) 2026 Jeff McGlynn.
+ * 
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**/
+
+/**
+ * Benchmark for the two refraction methods of ray_tracer.  Build without
+ * the Cocoa front end with:
+ * 
+ * c++ -O2 -Ibackend tools/refraction_bench.cpp backend/lens_backend.cpp \
+ *     backend/optical_system.cpp backend/ray_tracer.cpp \
+ *     backend/thread_pool.cpp backend/dispersion.cpp backend/caustic.cpp \
+ *     backend/paraxial.cpp -lcairo -lpthread -o refraction_bench
+ * 
+ * Traces the same bundle through several lens designs on one thread with
+ * k_refract_angles and k_refract_vector, and reports bounces per second for
+ * each.  The paths are then compared, see compare_paths(), and checked for
+ * rays that hit the same point twice, see count_repeated_hits().
+ * 
+ * The packet kernel circle::ray_intersect_packet() is then timed against
+ * circle::ray_intersect_vector() on the first surface of each design, and
+ * the two are checked to agree, see time_packets().
+**/
+
+#include "lens_backend.h"
+#include "ray_tracer.h"
+#include <sys/time.h>
+#include <cstdio>
+#include <cstdlib>
+
+/// Rays in the bundle.
+static const size_t k_rays = 400000;
+
+/// Timings taken of each method, the fastest is reported.
+static const u32 k_runs = 3;
+
+/// Rays per packet for circle::ray_intersect_packet().
+static const size_t k_packet_size = 64;
+
+/// Distance between hit points, in meters, beyond which paths have diverged.
+/// Hits of one ray closer than this are at the same point.
+static const f64 k_diverged = 1.0e-6;
+
+/**
+ * A lens design to trace through.
+**/
+struct lens_design {
+	const char * name;
+	f32 left_radius;
+	f32 right_radius;
+	f32 inside_n;
+	f32 outside_n;
+};
+
+static const lens_design k_designs[] = {
+	{ "biconvex",		1.5f,	1.5f,	1.5f,	1.0f },
+	{ "thick",			1.05f,	1.05f,	1.5f,	1.0f },
+	{ "thin",			4.0f,	4.0f,	1.5f,	1.0f },
+	{ "biconcave",		-3.0f,	-3.0f,	1.5f,	1.0f },
+	{ "meniscus",		1.5f,	-3.0f,	1.5f,	1.0f },
+	{ "high index",		1.2f,	1.2f,	2.4f,	1.0f }
+};
+
+/**
+ * Get the current time, in seconds.
+**/
+static f64 current_time() {
+	timeval tv;
+	gettimeofday(&tv, 0);
+	return f64(tv.tv_sec) + f64(tv.tv_usec) * 1.0e-6;
+}
+
+/**
+ * Count the surfaces hit by every ray.
+**/
+static size_t count_bounces(const trace_result& result) {
+	size_t bounces = 0;
+	for (size_t i = 0; i < result.size(); ++i) bounces += result.hit_count(i);
+	return bounces;
+}
+
+/**
+ * Trace the bundle with a method.
+ * 
+ * @return	Millions of bounces per second, from the fastest run.
+**/
+static f64 time_method(ray_tracer& tracer, ray_tracer::refraction_method method, const ray_bundle& rays, trace_result& out) {
+	tracer.method(method);
+	f64 best = 0.0;
+	
+	for (u32 run = 0; run < k_runs; ++run) {
+		const f64 start = current_time();
+		tracer.trace(rays, out);
+		const f64 elapsed = current_time() - start;
+		
+		best = max_(best, f64(count_bounces(out)) / elapsed * 1.0e-6);
+	}
+	
+	return best;
+}
+
+/**
+ * Count the rays that hit a surface twice in a row at the same point, which
+ * a ray that finds the surface it just left again would record.  Should be
+ * 0.  Hits on different surfaces may share a point where the surfaces meet,
+ * as at the center of a biconcave lens with no center thickness.
+**/
+static size_t count_repeated_hits(const trace_result& result) {
+	size_t repeated = 0;
+	
+	for (size_t i = 0; i < result.size(); ++i) {
+		const u32 count = result.hit_count(i);
+		const ray_hit * hits = result.hits(i);
+		
+		for (u32 j = 1; j < count; ++j) {
+			if (hits[j].surface == hits[j - 1].surface && (hits[j].point - hits[j - 1].point).length() <= k_diverged) {
+				++repeated;
+				break;
+			}
+		}
+	}
+	
+	return repeated;
+}
+
+/**
+ * Compare the paths traced with each method.  A path differs if it hits
+ * other surfaces, or if a hit point moves by more than k_diverged.
+ * 
+ * @param	max_distance	Receives the largest distance between hit points of
+ * 							paths that agree.
+ * @return	Number of paths that differ.
+**/
+static size_t compare_paths(const trace_result& a, const trace_result& b, f64& max_distance) {
+	size_t differing = 0;
+	max_distance = 0.0;
+	
+	for (size_t i = 0; i < a.size(); ++i) {
+		const u32 count = a.hit_count(i);
+		const ray_hit * hits_a = a.hits(i);
+		const ray_hit * hits_b = b.hits(i);
+		
+		bool same = (count == b.hit_count(i));
+		f64 distance = 0.0;
+		
+		for (u32 j = 0; same && j < count; ++j) {
+			distance = max_(distance, (hits_a[j].point - hits_b[j].point).length());
+			same = (hits_a[j].surface == hits_b[j].surface && distance <= k_diverged);
+		}
+		
+		if (same) max_distance = max_(max_distance, distance);
+		else ++differing;
+	}
+	
+	return differing;
+}
+
+/**
+ * Intersect every ray of the bundle with an arc, one ray at a time with
+ * ray_intersect_vector() and in packets of k_packet_size with
+ * ray_intersect_packet().  The directions of the bundle must be normalized.
+ * 
+ * @param	vector_rate, packet_rate
+ * 						Receive millions of intersections per second, from the
+ * 						fastest run.
+ * @return	Number of rays the two disagree on, by hit or miss or by the
+ * 			exact hit point and normal.
+**/
+static size_t time_packets(const circle& arc, const ray_bundle& rays, f64& vector_rate, f64& packet_rate) {
+	const size_t count = rays.size();
+	std::vector<f64> t(count), x(count), y(count), normal_x(count), normal_y(count);
+	std::vector<u8> found(count);
+	
+	vector_rate = packet_rate = 0.0;
+	
+	for (u32 run = 0; run < k_runs; ++run) {
+		f64 start = current_time();
+		
+		for (size_t i = 0; i < count; ++i) {
+			vector2dd point, normal;
+			found[i] = arc.ray_intersect_vector(rays.start(i), rays.dir(i), point, normal);
+			x[i] = point.x;
+			y[i] = point.y;
+			normal_x[i] = normal.x;
+			normal_y[i] = normal.y;
+		}
+		
+		vector_rate = max_(vector_rate, f64(count) / (current_time() - start) * 1.0e-6);
+		start = current_time();
+		
+		for (size_t first = 0; first < count; first += k_packet_size) {
+			arc.ray_intersect_packet(&rays.start_x[first], &rays.start_y[first], &rays.dir_x[first], &rays.dir_y[first],
+									 min_(count - first, k_packet_size), &t[first], &x[first], &y[first],
+									 &normal_x[first], &normal_y[first]);
+		}
+		
+		packet_rate = max_(packet_rate, f64(count) / (current_time() - start) * 1.0e-6);
+	}
+	
+	size_t mismatched = 0;
+	for (size_t i = 0; i < count; ++i) {
+		vector2dd point, normal;
+		const bool hit = arc.ray_intersect_vector(rays.start(i), rays.dir(i), point, normal);
+		
+		if (hit != (t[i] >= 0.0)
+				|| (hit && (point.x != x[i] || point.y != y[i] || normal.x != normal_x[i] || normal.y != normal_y[i]))) {
+			++mismatched;
+		}
+	}
+	
+	return mismatched;
+}
+
+int main() {
+	// A beam from the left, a little taller than the lens, fanned out a bit.
+	srand(1);
+	ray_bundle rays;
+	rays.reserve(k_rays);
+	
+	for (size_t i = 0; i < k_rays; ++i) {
+		const f64 y = (f64(rand()) / f64(RAND_MAX) * 2.0 - 1.0) * 1.2 * k_lens_half_height;
+		const f64 angle = (f64(rand()) / f64(RAND_MAX) * 2.0 - 1.0) * 0.2;
+		rays.add(vector2dd(-3.0, y), vector2dd(cos(angle), sin(angle)));
+	}
+	
+	printf("%u rays on one thread, millions of bounces per second\n\n", u32(k_rays));
+	printf("design       bounces/ray    angles   vectors   differing   max distance   repeated\n");
+	
+	for (size_t d = 0; d < sizeof(k_designs) / sizeof(k_designs[0]); ++d) {
+		const lens_design& design = k_designs[d];
+		
+		lens_backend lens;
+		lens.left_radius(design.left_radius);
+		lens.right_radius(design.right_radius);
+		lens.inside_n(design.inside_n);
+		lens.outside_n(design.outside_n);
+		
+		optical_system system;
+		lens.build_system(vector2dd(0.0, 0.0), system);
+		ray_tracer tracer(system);
+		
+		trace_result angles, vectors;
+		const f64 angles_rate = time_method(tracer, ray_tracer::k_refract_angles, rays, angles);
+		const f64 vectors_rate = time_method(tracer, ray_tracer::k_refract_vector, rays, vectors);
+		
+		f64 max_distance;
+		const size_t differing = compare_paths(angles, vectors, max_distance);
+		
+		const size_t repeated = count_repeated_hits(angles) + count_repeated_hits(vectors);
+		
+		printf("%-12s %11.2f %9.2f %9.2f %11u %14.2g %10u\n", design.name, f64(count_bounces(vectors)) / f64(k_rays),
+			   angles_rate, vectors_rate, u32(differing), max_distance, u32(repeated));
+	}
+	
+	printf("\nfirst surface only, millions of intersections per second\n\n");
+	printf("design          vector    packet   mismatched\n");
+	
+	for (size_t d = 0; d < sizeof(k_designs) / sizeof(k_designs[0]); ++d) {
+		const lens_design& design = k_designs[d];
+		
+		lens_backend lens;
+		lens.left_radius(design.left_radius);
+		lens.right_radius(design.right_radius);
+		
+		optical_system system;
+		lens.build_system(vector2dd(0.0, 0.0), system);
+		
+		f64 vector_rate, packet_rate;
+		const size_t mismatched = time_packets(system.surface(0).arc, rays, vector_rate, packet_rate);
+		
+		printf("%-12s %9.2f %9.2f %12u\n", design.name, vector_rate, packet_rate, u32(mismatched));
+	}
+	
+	return 0;
+}
@@ -37,22 +37,13 @@
 #include "cairoint.h"
 
 static cairo_status_t
-_cairo_spline_grow (cairo_spline_t *spline);
+_cairo_spline_reserve (cairo_spline_t *spline, int size);
 
 static cairo_status_t
 _cairo_spline_add_point (cairo_spline_t *spline, const cairo_point_t *point);
 
-static void
-_lerp_half (const cairo_point_t *a, const cairo_point_t *b, cairo_point_t *result);
-
-static void
-_de_casteljau (cairo_spline_knots_t *s1, cairo_spline_knots_t *s2);
-
-static double
-_cairo_spline_error_squared (const cairo_spline_knots_t *spline);
-
-static cairo_status_t
-_cairo_spline_decompose_into (cairo_spline_knots_t *spline, double tolerance_squared, cairo_spline_t *result);
+static int
+_cairo_spline_segment_count (const cairo_spline_knots_t *knots, double tolerance);
 
 cairo_int_status_t
 _cairo_spline_init (cairo_spline_t *spline,
@@ -98,16 +89,21 @@ _cairo_spline_fini (cairo_spline_t *spline)
     spline->num_points = 0;
 }
 
-/* make room for at least one more point */
+/* make room for at least size points */
 static cairo_status_t
-_cairo_spline_grow (cairo_spline_t *spline)
+_cairo_spline_reserve (cairo_spline_t *spline, int size)
 {
     cairo_point_t *new_points;
     int old_size = spline->points_size;
-    int new_size = 2 * MAX (old_size, 16);
+    int new_size;
 
     assert (spline->num_points <= spline->points_size);
 
+    if (size <= old_size)
+	return CAIRO_STATUS_SUCCESS;
+
+    new_size = MAX (2 * old_size, size);
+
     if (spline->points == spline->points_embedded) {
 	new_points = _cairo_malloc_ab (new_size, sizeof (cairo_point_t));
 	if (new_points)
@@ -138,11 +134,9 @@ _cairo_spline_add_point (cairo_spline_t *spline, const cairo_point_t *point)
 	    return CAIRO_STATUS_SUCCESS;
     }
 
-    if (spline->num_points >= spline->points_size) {
-	status = _cairo_spline_grow (spline);
-	if (status)
-	    return status;
-    }
+    status = _cairo_spline_reserve (spline, spline->num_points + 1);
+    if (status)
+	return status;
 
     spline->points[spline->num_points] = *point;
     spline->num_points++;
@@ -150,135 +144,110 @@ _cairo_spline_add_point (cairo_spline_t *spline, const cairo_point_t *point)
     return CAIRO_STATUS_SUCCESS;
 }
 
-static void
-_lerp_half (const cairo_point_t *a, const cairo_point_t *b, cairo_point_t *result)
-{
-    result->x = a->x + ((b->x - a->x) >> 1);
-    result->y = a->y + ((b->y - a->y) >> 1);
-}
-
-static void
-_de_casteljau (cairo_spline_knots_t *s1, cairo_spline_knots_t *s2)
-{
-    cairo_point_t ab, bc, cd;
-    cairo_point_t abbc, bccd;
-    cairo_point_t final;
-
-    _lerp_half (&s1->a, &s1->b, &ab);
-    _lerp_half (&s1->b, &s1->c, &bc);
-    _lerp_half (&s1->c, &s1->d, &cd);
-    _lerp_half (&ab, &bc, &abbc);
-    _lerp_half (&bc, &cd, &bccd);
-    _lerp_half (&abbc, &bccd, &final);
-
-    s2->a = final;
-    s2->b = bccd;
-    s2->c = cd;
-    s2->d = s1->d;
-
-    s1->b = ab;
-    s1->c = abbc;
-    s1->d = final;
-}
-
-/* Return an upper bound on the error (squared) that could result from
- * approximating a spline as a line segment connecting the two endpoints. */
-static double
-_cairo_spline_error_squared (const cairo_spline_knots_t *knots)
-{
-    double bdx, bdy, berr;
-    double cdx, cdy, cerr;
-
-    /* Intersection point (px):
-     *	    px = p1 + u(p2 - p1)
-     *	    (p - px) ∙ (p2 - p1) = 0
-     * Thus:
-     *	    u = ((p - p1) ∙ (p2 - p1)) / ∥p2 - p1∥²;
-     */
-    bdx = _cairo_fixed_to_double (knots->b.x - knots->a.x);
-    bdy = _cairo_fixed_to_double (knots->b.y - knots->a.y);
-
-    cdx = _cairo_fixed_to_double (knots->c.x - knots->a.x);
-    cdy = _cairo_fixed_to_double (knots->c.y - knots->a.y);
-
-    if (knots->a.x != knots->d.x || knots->a.y != knots->d.y) {
-	double dx, dy, u, v;
-
-	dx = _cairo_fixed_to_double (knots->d.x - knots->a.x);
-	dy = _cairo_fixed_to_double (knots->d.y - knots->a.y);
-	 v = dx * dx + dy * dy;
-
-	u = bdx * dx + bdy * dy;
-	if (u <= 0) {
-	    /* bdx -= 0;
-	     * bdy -= 0;
-	     */
-	} else if (u >= v) {
-	    bdx -= dx;
-	    bdy -= dy;
-	} else {
-	    bdx -= u/v * dx;
-	    bdy -= u/v * dy;
-	}
-
-	u = cdx * dx + cdy * dy;
-	if (u <= 0) {
-	    /* cdx -= 0;
-	     * cdy -= 0;
-	     */
-	} else if (u >= v) {
-	    cdx -= dx;
-	    cdy -= dy;
-	} else {
-	    cdx -= u/v * dx;
-	    cdy -= u/v * dy;
-	}
-    }
-
-    berr = bdx * bdx + bdy * bdy;
-    cerr = cdx * cdx + cdy * cdy;
-    if (berr > cerr)
-	return berr;
-    else
-	return cerr;
-}
+/* Return the number of line segments needed to keep the polyline through
+ * evenly spaced points of a spline within tolerance of the spline, from
+ * Wang's formula:
+ *
+ *	n = ceil (sqrt (3 * 2 / 8 * M / tolerance))
+ *
+ * where M is the larger of the second differences |a - 2b + c| and
+ * |b - 2c + d|.  Knowing the count up front lets the points be generated
+ * by forward differencing into a buffer sized once, instead of subdividing
+ * and testing the error at every level.
+ *
+ * The count is capped at CAIRO_SPLINE_MAX_SEGMENTS so that a tiny tolerance
+ * or a huge curve cannot overflow the int or ask for an unbounded buffer.
+ *
+ * This replaces upstream cairo's recursive decomposition and is a local
+ * change to the vendored copy. */
+#define CAIRO_SPLINE_MAX_SEGMENTS (1 << 16)
 
-static cairo_status_t
-_cairo_spline_decompose_into (cairo_spline_knots_t *s1, double tolerance_squared, cairo_spline_t *result)
+static int
+_cairo_spline_segment_count (const cairo_spline_knots_t *knots, double tolerance)
 {
-    cairo_spline_knots_t s2;
-    cairo_status_t status;
+    double ddx1, ddy1, ddx2, ddy2;
+    double m, n;
 
-    if (_cairo_spline_error_squared (s1) < tolerance_squared)
-	return _cairo_spline_add_point (result, &s1->a);
+    ddx1 = _cairo_fixed_to_double (knots->a.x) - 2 * _cairo_fixed_to_double (knots->b.x) + _cairo_fixed_to_double (knots->c.x);
+    ddy1 = _cairo_fixed_to_double (knots->a.y) - 2 * _cairo_fixed_to_double (knots->b.y) + _cairo_fixed_to_double (knots->c.y);
+    ddx2 = _cairo_fixed_to_double (knots->b.x) - 2 * _cairo_fixed_to_double (knots->c.x) + _cairo_fixed_to_double (knots->d.x);
+    ddy2 = _cairo_fixed_to_double (knots->b.y) - 2 * _cairo_fixed_to_double (knots->c.y) + _cairo_fixed_to_double (knots->d.y);
 
-    _de_casteljau (s1, &s2);
+    m = MAX (ddx1 * ddx1 + ddy1 * ddy1, ddx2 * ddx2 + ddy2 * ddy2);
+    if (m == 0 || tolerance <= 0)
+	return 1;
 
-    status = _cairo_spline_decompose_into (s1, tolerance_squared, result);
-    if (status)
-	return status;
-
-    status = _cairo_spline_decompose_into (&s2, tolerance_squared, result);
-    if (status)
-	return status;
+    n = ceil (sqrt (0.75 * sqrt (m) / tolerance));
+    if (! (n >= 1))
+	return 1;
+    if (n > CAIRO_SPLINE_MAX_SEGMENTS)
+	return CAIRO_SPLINE_MAX_SEGMENTS;
 
-    return CAIRO_STATUS_SUCCESS;
+    return (int) n;
 }
 
 cairo_status_t
 _cairo_spline_decompose (cairo_spline_t *spline, double tolerance)
 {
     cairo_status_t status;
-    cairo_spline_knots_t s1;
+    cairo_point_t point;
+    double ax, ay, bx, by, cx, cy, dx, dy;
+    double x, y, d1x, d1y, d2x, d2y, d3x, d3y;
+    double h;
+    int n, i;
 
     /* reset the spline, but keep the buffer */
     spline->num_points = 0;
 
-    s1 = spline->knots;
-    status = _cairo_spline_decompose_into (&s1, tolerance * tolerance, spline);
+    n = _cairo_spline_segment_count (&spline->knots, tolerance);
+    status = _cairo_spline_reserve (spline, n + 1);
     if (status)
 	return status;
 
+    ax = _cairo_fixed_to_double (spline->knots.a.x);
+    ay = _cairo_fixed_to_double (spline->knots.a.y);
+    bx = _cairo_fixed_to_double (spline->knots.b.x);
+    by = _cairo_fixed_to_double (spline->knots.b.y);
+    cx = _cairo_fixed_to_double (spline->knots.c.x);
+    cy = _cairo_fixed_to_double (spline->knots.c.y);
+    dx = _cairo_fixed_to_double (spline->knots.d.x);
+    dy = _cairo_fixed_to_double (spline->knots.d.y);
+
+    /* Forward differences of the power basis
+     *	(-a + 3b - 3c + d) t³ + (3a - 6b + 3c) t² + 3(b - a) t + a
+     * with a step of h. */
+    h = 1.0 / n;
+
+    d3x = 6 * (-ax + 3 * bx - 3 * cx + dx) * h * h * h;
+    d3y = 6 * (-ay + 3 * by - 3 * cy + dy) * h * h * h;
+    d2x = d3x + 2 * (3 * ax - 6 * bx + 3 * cx) * h * h;
+    d2y = d3y + 2 * (3 * ay - 6 * by + 3 * cy) * h * h;
+    d1x = d3x / 6 + (3 * ax - 6 * bx + 3 * cx) * h * h + 3 * (bx - ax) * h;
+    d1y = d3y / 6 + (3 * ay - 6 * by + 3 * cy) * h * h + 3 * (by - ay) * h;
+
+    x = ax;
+    y = ay;
+
+    status = _cairo_spline_add_point (spline, &spline->knots.a);
+    if (status)
+	return status;
+
+    for (i = 1; i < n; i++) {
+	x += d1x;
+	y += d1y;
+	d1x += d2x;
+	d1y += d2y;
+	d2x += d3x;
+	d2y += d3y;
+
+	point.x = _cairo_fixed_from_double (x);
+	point.y = _cairo_fixed_from_double (y);
+
+	status = _cairo_spline_add_point (spline, &point);
+	if (status)
+	    return status;
+    }
+
     status = _cairo_spline_add_point (spline, &spline->knots.d);
     if (status)
 	return status;